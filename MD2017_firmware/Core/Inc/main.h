@@ -77,6 +77,8 @@ extern uint32_t NumInterruptPriorityBits;
 extern ADC_HandleTypeDef hadc1;
 extern I2S_HandleTypeDef hi2s3;
 extern SPI_HandleTypeDef hspi1;
+extern DMA_HandleTypeDef hdma_spi1_rx;
+extern DMA_HandleTypeDef hdma_spi1_tx;
 extern SPI_HandleTypeDef hspi2;
 extern DAC_HandleTypeDef hdac;
 extern RTC_HandleTypeDef hrtc;
@@ -547,11 +547,37 @@ static int8_t CDC_TransmitCplt_FS(uint8_t *Buf, uint32_t *Len, uint8_t epnum)
   UNUSED(Buf);
   UNUSED(Len);
   UNUSED(epnum);
+
+  if (settingsUsbMode == USB_MODE_HOTSPOT)
+  {
+	  hotspotUSBTransmitComplete();
+  }
   /* USER CODE END 13 */
   return result;
 }
 
 /* USER CODE BEGIN PRIVATE_FUNCTIONS_IMPLEMENTATION */
+/**
+  * @brief  CDC_TransmitDirect_FS
+  *         Same as CDC_Transmit_FS(), but without copying the data first.
+  *         @note
+  *         The buffer has to stay untouched until CDC_TransmitCplt_FS() is called.
+  *
+  * @param  Buf: Buffer of data to be sent
+  * @param  Len: Number of data to be sent (in bytes)
+  * @retval USBD_OK if all operations are OK else USBD_FAIL or USBD_BUSY
+  */
+uint8_t CDC_TransmitDirect_FS(uint8_t* Buf, uint16_t Len)
+{
+  USBD_CDC_HandleTypeDef *hcdc = (USBD_CDC_HandleTypeDef*)hUsbDeviceFS.pClassData;
+
+  if (hcdc->TxState != 0){
+	  return USBD_BUSY;
+  }
+
+  USBD_CDC_SetTxBuffer(&hUsbDeviceFS, Buf, Len);
+  return USBD_CDC_TransmitPacket(&hUsbDeviceFS);
+}
 
 /* USER CODE END PRIVATE_FUNCTIONS_IMPLEMENTATION */
 
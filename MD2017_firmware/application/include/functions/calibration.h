@@ -73,6 +73,17 @@ typedef struct calibrationPowerValues
 
 } calibrationPowerValues_t;
 
+// Everything a retune needs for one Tx frequency, interpolated once and then cached
+typedef struct calibrationSnapshot
+{
+	uint32_t frequency;
+	uint8_t analogIGain;
+	uint8_t analogQGain;
+	uint8_t digitalIGain;
+	uint8_t digitalQGain;
+	calibrationPowerValues_t powerSettings;
+} calibrationSnapshot_t;
+
 typedef struct calibrationRSSIMeter
 {
 	uint8_t minVal;
@@ -88,6 +99,9 @@ void calibrationReadFactory(void);
 void calibrationSaveLocal(void);
 void calibrationReadLocal(void);
 void calibrationGetPowerForFrequency(int freq, calibrationPowerValues_t *powerSettings);
+const calibrationSnapshot_t *calibrationGetSnapshotForFrequency(int freq);
+void calibrationPrefillSnapshotForFrequency(int freq);
+void calibrationInvalidateSnapshots(void);
 uint16_t calibrationGetRxTuneForFrequency(int freq);
 uint8_t calibrationGetAnalogIGainForFrequency(int freq);
 uint8_t calibrationGetAnalogQGainForFrequency(int freq);
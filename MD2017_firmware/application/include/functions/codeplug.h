@@ -229,6 +229,17 @@ typedef struct
 	int	NOT_IN_CODEPLUG_CALCULATED_DISTANCE_X10;// -1 = no distance available
 } struct_codeplugChannel_t;
 
+// RAM resident summary of a channel, kept for all channels so that scan and channel stepping
+// can check them without reading the codeplug
+typedef struct
+{
+	uint32_t rxFreq:31;
+	uint32_t isDigital:1;
+	uint16_t rxTone;
+	uint8_t  flag4; // bits... same as struct_codeplugChannel_t flag4
+	uint8_t  nameHash;
+} codeplugChannelSummary_t;
+
 typedef enum
 {
 	TA_TX_OFF = 0,
@@ -387,6 +398,8 @@ uint8_t codeplugChannelGetFlag(struct_codeplugChannel_t *channelBuf, ChannelFlag
 uint8_t codeplugChannelSetFlag(struct_codeplugChannel_t *channelBuf, ChannelFlag_t flag, uint8_t value);
 void codeplugChannelGetDataWithOffsetAndLengthForIndex(int index, struct_codeplugChannel_t *channelBuf, uint8_t offset, int length);
 void codeplugChannelGetDataForIndex(int index, struct_codeplugChannel_t *channelBuf);
+const codeplugChannelSummary_t *codeplugChannelGetSummaryForIndex(int index);
+uint8_t codeplugChannelNameHash(const char *name);
 void codeplugUtilConvertBufToString(char *codeplugBuf, char *outBuf, int len);
 void codeplugUtilConvertStringToBuf(char *inBuf, char *outBuf, int len);
 uint32_t byteSwap32(uint32_t n);
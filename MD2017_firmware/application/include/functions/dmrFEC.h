@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2019-2024 Roger Clark, VK3KYY / G4KYF
+ *                         Daniel Caujolle-Bert, F1RMB
+ *
+ * Low level DMR stream implementation informed by code written by
+ *                         DSD Author (anonymous)
+ *                         MBELib Author (anonymous)
+ *                         Ian Wraith G7GHH
+ *                         Jonathan Naylor G4KLX
+ *
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef _OPENGD77_DMRFEC_H_
+#define _OPENGD77_DMRFEC_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Full LC BPTC(196,96) and embedded LC codecs, as used by the hotspot.
+// No hardware dependency, so they can also be built on a host (see tests/).
+
+// 12 bytes of LC (9 data + 3 CRC) from/to a 33 bytes burst, the slot type and sync bits being left untouched by the encoder
+void dmrFECBPTCDecode(const uint8_t *inputData, uint8_t *outputData);
+void dmrFECBPTCEncode(const uint8_t *inputData, uint8_t *outputData);
+
+// 72 LC bits from/to the 128 bits of the 4 embedded LC fragments. The decoder returns false if
+// the data couldn't be corrected, or the CRC doesn't match, lcBits being left partially written then
+void dmrFECEmbeddedDataEncode(const bool *lcBits, bool *rawBits);
+bool dmrFECEmbeddedDataDecode(const bool *rawBits, bool *lcBits);
+
+static inline void byteToBooleanBitsArray(uint8_t byteIn, bool *bitsOut)
+{
+	for (int i = 0, shift = 7; i < 8; i++, shift--)
+	{
+		bitsOut[i] = (byteIn >> shift) & 0x01;
+	}
+}
+
+static inline uint8_t BooleanBitsArrayToByte(const bool *bitsIn)
+{
+	uint8_t out = 0;
+	for (int i = 0, shift = 7; i < 8; i++, shift--)
+	{
+		out  |= bitsIn[i] << shift;
+	}
+	return out;
+}
+
+#endif /* _OPENGD77_DMRFEC_H_ */
@@ -153,12 +153,14 @@ void mmdvmSendDebug5(const char *text, int16_t n1, int16_t n2, int16_t n3, int16
 #endif
 
 void hotspotRxFrameHandler(uint8_t *frameBuf);
+bool hotspotGetTxFrame(uint8_t *frameBuf, bool remove);
 
 void cwProcess(void);
 void cwReset(void);
 
 void handleHotspotRequest(void);
 void processUSBDataQueue(void);
+void hotspotUSBTransmitComplete(void);
 void enqueueUSBData(uint8_t *data, uint8_t length);
 void hotspotStateMachine(void);
 void hotspotInit(void);
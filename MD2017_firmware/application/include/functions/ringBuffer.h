@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2019-2024 Roger Clark, VK3KYY / G4KYF
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef _OPENGD77_RINGBUFFER_H_
+#define _OPENGD77_RINGBUFFER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "main.h"
+
+// Single producer / single consumer ring buffer indexes, the storage being owned by the user.
+// head is only written by the producer, tail only by the consumer. Both are free running, so
+// the size has to be a power of two, and nothing needs to be shared by the two sides but these.
+typedef struct
+{
+	volatile uint32_t head;
+	volatile uint32_t tail;
+	uint32_t          mask;      // size - 1
+	volatile uint32_t overflows; // producer side count of the rejected writes
+} ringBuffer_t;
+
+#define RING_BUFFER_INITIALISER(size) { .head = 0, .tail = 0, .mask = ((size) - 1), .overflows = 0 }
+
+// Neither the producer nor the consumer can be running
+static inline void ringBufferReset(ringBuffer_t *ring)
+{
+	ring->head = 0;
+	ring->tail = 0;
+}
+
+static inline uint32_t ringBufferCount(const ringBuffer_t *ring)
+{
+	return (ring->head - ring->tail);
+}
+
+static inline uint32_t ringBufferFree(const ringBuffer_t *ring)
+{
+	return ((ring->mask + 1) - (ring->head - ring->tail));
+}
+
+//
+// Producer side
+//
+static inline bool ringBufferReserve(ringBuffer_t *ring, uint32_t count)
+{
+	if (ringBufferFree(ring) < count)
+	{
+		ring->overflows++;
+		return false;
+	}
+
+	return true;
+}
+
+static inline uint32_t ringBufferWriteSlot(const ringBuffer_t *ring)
+{
+	return (ring->head & ring->mask);
+}
+
+static inline void ringBufferCommitWrite(ringBuffer_t *ring, uint32_t count)
+{
+	__DMB(); // the data has to be written before the consumer can see it
+	ring->head += count;
+}
+
+//
+// Consumer side, ringBufferCount() has to be checked first
+//
+static inline uint32_t ringBufferReadSlot(const ringBuffer_t *ring)
+{
+	__DMB(); // don't read the data before the head it has been checked against
+	return (ring->tail & ring->mask);
+}
+
+static inline void ringBufferCommitRead(ringBuffer_t *ring, uint32_t count)
+{
+	__DMB(); // the data has to be read before the producer can overwrite it
+	ring->tail += count;
+}
+
+// Drops everything written so far
+static inline void ringBufferFlush(ringBuffer_t *ring)
+{
+	ring->tail = ring->head;
+}
+
+#endif /* _OPENGD77_RINGBUFFER_H_ */
@@ -33,6 +33,7 @@
 #include <task.h>
 #include "main.h"
 #include "interfaces/wdog.h"
+#include "functions/ringBuffer.h"
 
 extern Task_t beepTask;
 
@@ -68,23 +69,21 @@ extern int soundBeepVolumeDivider;
 extern volatile float dmrRxAGCrxPeakAverage;
 
 #define WAV_BUFFER_SIZE                          160
-#define WAV_BUFFER_COUNT                          30 // 5 DMR frames, was 24
+#define WAV_BUFFER_COUNT                          32 // 5 DMR frames, was 24 then 30. Needs to be a power of two
 #define WAV_BUFFER_AMBE_PREBUFFERING_COUNT        12 // 2 DMR frames, 6 buffers each
 #define HOTSPOT_BUFFER_SIZE                      50U
-#define HOTSPOT_BUFFER_COUNT                     48U
+#define HOTSPOT_BUFFER_COUNT                     64U // Needs to be a power of two
 
 #define DMR_RX_AGC_DEFAULT_PEAK_SAMPLES			2000.0f
 
 extern union sharedDataBuffer
 {
-	volatile uint8_t wavbuffer[WAV_BUFFER_COUNT][WAV_BUFFER_SIZE]; // 3840
-	volatile uint8_t hotspotBuffer[HOTSPOT_BUFFER_COUNT][HOTSPOT_BUFFER_SIZE]; // 2400
-	volatile uint8_t rawBuffer[HOTSPOT_BUFFER_COUNT * HOTSPOT_BUFFER_SIZE]; // 2400
+	volatile uint8_t wavbuffer[WAV_BUFFER_COUNT][WAV_BUFFER_SIZE]; // 5120
+	volatile uint8_t hotspotBuffer[HOTSPOT_BUFFER_COUNT][HOTSPOT_BUFFER_SIZE]; // 3200
+	volatile uint8_t rawBuffer[HOTSPOT_BUFFER_COUNT * HOTSPOT_BUFFER_SIZE]; // 3200
 } audioAndHotspotDataBuffer;
 
-extern volatile int16_t wavbuffer_read_idx;
-extern volatile int16_t wavbuffer_write_idx;
-extern volatile int16_t wavbuffer_count;
+extern ringBuffer_t wavbufferRing;
 extern volatile uint8_t *currentWaveBuffer;
 
 
@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2019-2024 Roger Clark, VK3KYY / G4KYF
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef _OPENGD77_SOUNDSAMPLES_H_
+#define _OPENGD77_SOUNDSAMPLES_H_
+
+#include <stdint.h>
+#include "main.h"
+#include "utils.h"
+
+// The gain is applied in fixed point, Q6.9 so the max gain (32) still fits in a 16 bit halfword
+#define DMR_RX_AGC_GAIN_FRACTIONAL_BITS   9
+#define DMR_RX_AGC_GAIN_MAX               32
+
+// Returns the peak amplitude from the per halfword maxima and minima
+static inline uint32_t soundGetPeakFromMinMax(int32_t maximum, int32_t minimum)
+{
+	return (uint32_t)((maximum > -minimum) ? maximum : -minimum);
+}
+
+// Applies the AGC gain (Q6.9) to sampleCount samples of decoded audio, only filling the Left Channel of the I2S buffer (the Right Channel is not used by the HRC6000).
+// Returns the peak amplitude of the samples, before the gain.
+static inline uint32_t soundApplyDmrRxAgcGain(const int16_t *samples, uint32_t *i2sBuffer, uint32_t sampleCount, int32_t gain)
+{
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+	// Samples are handled in pairs, with the Cortex-M4 SIMD instructions, so sampleCount has to be even
+	const uint32_t *samplePairs = (const uint32_t *)samples;
+	uint32_t gainLow = (uint32_t)gain;
+	uint32_t gainHigh = ((uint32_t)gain << 16);
+	uint32_t maxima = 0x80008000;
+	uint32_t minima = 0x7FFF7FFF;
+
+	for (uint32_t i = 0; i < (sampleCount / 2); i++)
+	{
+		uint32_t pair = samplePairs[i];
+
+		// SSUB16 sets the GE flags used by SEL, for each halfword
+		__SSUB16(pair, maxima);
+		maxima = __SEL(pair, maxima);
+		__SSUB16(pair, minima);
+		minima = __SEL(minima, pair);
+
+		i2sBuffer[2 * i] = (uint16_t)__SSAT(((int32_t)__SMUAD(pair, gainLow) >> DMR_RX_AGC_GAIN_FRACTIONAL_BITS), 16);
+		i2sBuffer[(2 * i) + 1] = (uint16_t)__SSAT(((int32_t)__SMUAD(pair, gainHigh) >> DMR_RX_AGC_GAIN_FRACTIONAL_BITS), 16);
+	}
+
+	return soundGetPeakFromMinMax(SAFE_MAX((int16_t)maxima, (int16_t)(maxima >> 16)), SAFE_MIN((int16_t)minima, (int16_t)(minima >> 16)));
+#else
+	int32_t maximum = INT16_MIN;
+	int32_t minimum = INT16_MAX;
+
+	for (uint32_t i = 0; i < sampleCount; i++)
+	{
+		int32_t sample = samples[i];
+		int32_t amplified = ((sample * gain) >> DMR_RX_AGC_GAIN_FRACTIONAL_BITS);
+
+		maximum = SAFE_MAX(maximum, sample);
+		minimum = SAFE_MIN(minimum, sample);
+
+		i2sBuffer[i] = (uint16_t)SAFE_MIN(SAFE_MAX(amplified, INT16_MIN), INT16_MAX);
+	}
+
+	return soundGetPeakFromMinMax(maximum, minimum);
+#endif /* _OPENGD77_SOUNDSAMPLES_H_ */
+}
+
+// Copies the Left Channel of sampleCount mic audio frames into a wav buffer (the Right Channel contains a duplicate).
+// Returns the peak amplitude of the samples.
+static inline uint32_t soundCopyMicSamples(const uint32_t *i2sBuffer, int16_t *samples, uint32_t sampleCount)
+{
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+	uint32_t *samplePairs = (uint32_t *)samples;
+	uint32_t maxima = 0x80008000;
+	uint32_t minima = 0x7FFF7FFF;
+
+	for (uint32_t i = 0; i < (sampleCount / 2); i++)
+	{
+		uint32_t pair = __PKHBT(i2sBuffer[2 * i], i2sBuffer[(2 * i) + 1], 16);
+
+		__SSUB16(pair, maxima);
+		maxima = __SEL(pair, maxima);
+		__SSUB16(pair, minima);
+		minima = __SEL(minima, pair);
+
+		samplePairs[i] = pair;
+	}
+
+	return soundGetPeakFromMinMax(SAFE_MAX((int16_t)maxima, (int16_t)(maxima >> 16)), SAFE_MIN((int16_t)minima, (int16_t)(minima >> 16)));
+#else
+	int32_t maximum = INT16_MIN;
+	int32_t minimum = INT16_MAX;
+
+	for (uint32_t i = 0; i < sampleCount; i++)
+	{
+		int16_t sample = (int16_t)i2sBuffer[i];
+
+		maximum = SAFE_MAX(maximum, sample);
+		minimum = SAFE_MIN(minimum, sample);
+
+		samples[i] = sample;
+	}
+
+	return soundGetPeakFromMinMax(maximum, minimum);
+#endif /* _OPENGD77_SOUNDSAMPLES_H_ */
+}
+
+#endif /* _OPENGD77_SOUNDSAMPLES_H_ */
@@ -118,6 +118,7 @@ extern volatile bool trxIsTransmittingDMR;
 extern volatile uint32_t trxDMRstartTime;
 
 bool trxCarrierDetected(RadioDevice_t deviceId);
+bool trxCarrierDetectedOnChannel(RadioDevice_t deviceId, struct_codeplugChannel_t *channel);
 bool trxCheckDigitalSquelch(RadioDevice_t deviceId);
 bool trxCheckAnalogSquelch(void);
 void trxResetSquelchesState(RadioDevice_t deviceId);
@@ -47,6 +47,8 @@ bool radioReadReg2byte(uint8_t reg, uint8_t *val1, uint8_t *val2);
 bool radioSetClearReg2byteWithMask(uint8_t reg, uint8_t mask1, uint8_t mask2, uint8_t val1, uint8_t val2);
 void I2C_AT1846S_send_Settings(const uint8_t settings[][AT1846_BYTES_PER_COMMAND], int numSettings);
 void I2C_AT1846_set_register_with_mask(uint8_t reg, uint16_t mask, uint16_t value, uint8_t shift);
+void AT1846sBeginBatch(void);
+void AT1846sEndBatch(void);
 
 void AT1846sInit(void);
 void AT1846sPostInit(void);
@@ -34,6 +34,10 @@
 #include <task.h>
 #include "interfaces/i2c.h"
 
+#define EMULATED_EEPROM_SIZE  0x10000 // 64k at the start of the Flash
+
+bool EEPROM_Init(void);
+bool EEPROM_Sync(void);
 bool EEPROM_Read(int address,uint8_t *buf, int size);
 bool EEPROM_Write(int address,uint8_t *buf, int size);
 
@@ -201,6 +201,8 @@ void displayClearRows(int16_t startRow, int16_t endRow, bool isInverted);
 void displayRenderWithoutNotification(void);
 void displayRender(void);
 void displayRenderRows(int16_t startRow, int16_t endRow);
+bool displayIsTransferring(void);
+void displayWaitForTransfer(void);
 void displayPrintCentered(uint16_t y, const char *text, ucFont_t fontSize);
 void displayPrintAt(uint16_t x, uint16_t y, const  char *text, ucFont_t fontSize);
 int displayPrintCore(int16_t x, int16_t y, const char *szMsg, ucFont_t fontSize, ucTextAlign_t alignment, bool isInverted);
@@ -249,6 +251,18 @@ void displayOverrideScreenBuffer(uint16_t *buffer);
 
 void displayConvertGD77ImageData(uint8_t *dataBuf);
 
+#if defined(DISPLAY_BENCHMARK)
+typedef struct
+{
+	uint32_t fills;
+	uint32_t pixels;
+	uint32_t cycles; // DWT cycles spent filling
+} displayFillStatistics_t;
+
+void displayGetFillStatistics(displayFillStatistics_t *statistics);
+void displayResetFillStatistics(void);
+#endif
+
 #if defined(HAS_COLOURS)
 uint16_t displayConvertRGB888ToNative(uint32_t RGB888);
 #endif
@@ -58,14 +58,60 @@
 #define SR_DRV1         0x00400000 // Output Driver Strength 1       // S22
 #define SR_HOLD_RST     0x00800000 // /HOLD or /RESET Function       // S23
 
+// Completion callback of the asynchronous requests. It's called from the SPI Flash engine task,
+// hence must be short and must not wait for another Flash request.
+typedef void (*spiFlashRequestCallback_t)(bool success, void *userData);
+
+typedef enum
+{
+	SPI_FLASH_READ_MODE_NORMAL = 0, // READ_DATA, at the initial SPI clock
+	SPI_FLASH_READ_MODE_FAST        // FAST_READ, at the highest SPI clock
+} spiFlashReadMode_t;
+
+#define SPI_FLASH_READ_AHEAD_BLOCK_SIZE  256
+
+typedef enum
+{
+	SPI_FLASH_READ_AHEAD_BLOCK_EMPTY = 0,
+	SPI_FLASH_READ_AHEAD_BLOCK_PENDING,
+	SPI_FLASH_READ_AHEAD_BLOCK_READY,
+	SPI_FLASH_READ_AHEAD_BLOCK_FAILED
+} spiFlashReadAheadBlockState_t;
+
+// Double buffered sequential reader. Must not be in CCM RAM, as it's filled by DMA.
+typedef struct
+{
+	uint32_t                                blockAddress[2];
+	volatile spiFlashReadAheadBlockState_t  blockState[2];
+	uint8_t                                 block[2][SPI_FLASH_READ_AHEAD_BLOCK_SIZE];
+} spiFlashReadAhead_t;
+
+#if defined(SPI_FLASH_BENCHMARK)
+#define SPI_FLASH_STATISTICS_NUM_BLOCKS  256 // 64KB blocks of the 16MB W25Q128
+
+// Traffic that actually reached the Flash chip, i.e. not served by the write cache
+typedef struct
+{
+	uint32_t reads;
+	uint32_t readBytes;
+	uint32_t programs;
+	uint32_t programBytes;
+	uint32_t erases;
+	uint16_t blockErases[SPI_FLASH_STATISTICS_NUM_BLOCKS];// Sector erases, per 64KB block
+} spiFlashStatistics_t;
+#endif
+
 extern uint8_t SPI_Flash_sectorbuffer[4096];
 extern uint32_t flashChipPartNumber;
 
 // Public functions
 bool SPI_Flash_init(void);
 bool SPI_Flash_read(uint32_t addrress,uint8_t *buf,int size);
-bool SPI_Flash_write(uint32_t addr, uint8_t *dataBuf, int size);
+bool SPI_Flash_write(uint32_t addr, uint8_t *dataBuf, int size);// write back cached, see SPI_Flash_sync()
+bool SPI_Flash_sync(void);// writes back all the pending cached writes
+void SPI_Flash_syncIfNeeded(void);// timed write back, called from the main loop
 bool SPI_Flash_writePage(uint32_t address,uint8_t *dataBuf);// page is 256 bytes
+bool SPI_Flash_programBytes(uint32_t address, uint8_t *dataBuf, int size);// no erase, target has to be blank
 bool SPI_Flash_eraseSector(uint32_t address);// sector is 16 pages  = 4k bytes
 uint8_t SPI_Flash_readManufacturer(void);// Not necessarily Winbond !
 uint32_t SPI_Flash_readPartID(void);// Should be 4014 for 1M or 4017 for 8M
@@ -74,4 +120,25 @@ bool SPI_Flash_readSecurityRegisters(int startBlock, uint8_t *dataBuf, int size)
 uint8_t SPI_Flash_readSingleSecurityRegister(int addr);                                 // Used to read a single security register. Used for Display Type
 //bool SPI_Flash_StateIsBusy(void);
 
+// Asynchronous requests, queued and executed in order. Return false if the queue is full.
+// Buffers must stay valid until the callback is called, buffers in CCM RAM are transferred without DMA.
+// These requests bypass the write cache, call SPI_Flash_sync() first if needed.
+bool SPI_Flash_readAsync(uint32_t address, uint8_t *dataBuf, int size, spiFlashRequestCallback_t callback, void *userData);
+bool SPI_Flash_programAsync(uint32_t address, uint8_t *dataBuf, int size, spiFlashRequestCallback_t callback, void *userData);// no erase, target has to be blank
+bool SPI_Flash_eraseSectorAsync(uint32_t address, spiFlashRequestCallback_t callback, void *userData);
+bool SPI_Flash_isIdle(void);
+bool SPI_Flash_isTransferring(void);
+
+void SPI_Flash_setReadMode(spiFlashReadMode_t mode);
+spiFlashReadMode_t SPI_Flash_getReadMode(void);
+#if defined(SPI_FLASH_BENCHMARK)
+uint32_t SPI_Flash_benchmarkReadMode(spiFlashReadMode_t mode, uint32_t address, int size);// returns bytes per second
+void SPI_Flash_getStatistics(spiFlashStatistics_t *statistics);
+void SPI_Flash_resetStatistics(void);
+#endif
+
+void SPI_Flash_readAheadInit(spiFlashReadAhead_t *readAhead, uint32_t address);
+bool SPI_Flash_readAheadRead(spiFlashReadAhead_t *readAhead, uint32_t address, uint8_t *dataBuf, int size);
+void SPI_Flash_readAheadEnd(spiFlashReadAhead_t *readAhead);// has to be called before the reader goes out of scope
+
 #endif /* _OPENGD77_SPI_FLASH_H_ */
@@ -50,7 +50,12 @@ void radioInit(void);
 void radioPostinit(void);
 RadioDevice_t radioSetTRxDevice(RadioDevice_t deviceId);
 RadioDevice_t radioGetTRxDeviceId(void);
+void radioBeginRegisterBatch(void);
+void radioEndRegisterBatch(void);
 void radioSetBandwidth(bool Is25K);
+#if defined(PLATFORM_MD2017)
+void radioSetSecondaryReceiverChannel(uint32_t rxFreq, int mode, bool bandwidthIs25kHz);
+#endif
 void radioSetCalibration(void);
 void radioSetIF(int band, bool wide);
 void radioSetMode(int mode);
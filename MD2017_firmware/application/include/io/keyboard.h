@@ -87,7 +87,10 @@
 #define EVENT_KEY_NONE   0
 #define EVENT_KEY_CHANGE 1
 
-#define KEY_DEBOUNCE_COUNTER   20
+#define KEY_DEBOUNCE_MS        20
+
+#define KEYBOARD_ROW_SIDE_BUTTONS  2
+#define KEYBOARD_COLUMN(n)         (1U << (n)) // keyboardReadRowColumns() bit of LCD_Dn
 
 #if defined(PLATFORM_MD380) || defined(PLATFORM_MDUV380) || defined(PLATFORM_RT84_DM1701) || defined(PLATFORM_MD2017)
 #if defined(PLATFORM_RT84_DM1701) || defined(PLATFORM_MD2017)
@@ -152,6 +155,10 @@ extern volatile trackballData_t trackballData;
 void keyboardInit(void);
 void keyboardReset(void);
 uint32_t keyboardRead(void);
+uint8_t keyboardReadRowColumns(uint32_t row);
+void keyboardScanTimerISR(void);
+void keyboardScanSuspend(void);
+void keyboardScanResume(void);
 bool keyboardKeyIsDTMFKey(char key);
 void keyboardCheckKeyEvent(keyboardCode_t *keys, int *event);
 bool keyboardScanKey(uint32_t scancode, char *keycode);
@@ -193,8 +193,10 @@ typedef uint32_t time_t_custom;     /* date/time in unix secs past 1-Jan-70 */
 
 #define FREQ_ENTER_DIGITS_MAX                 12
 
-#define MIN_ENTRIES_BEFORE_USING_SLICES       40 // Minimal number of available IDs before using slices stuff
-#define ID_SLICES                             14 // Number of slices in whole DMRIDs DB
+#define DMRID_INDEX_SIZE                     512 // Number of first-ID-of-block entries in the RAM index of the DMRIDs DB
+#define DMRID_INDEX_WINDOW_SIZE              256 // Maximum number of bytes read from the DMRIDs DB per lookup probe
+#define DMRID_INDEX_WINDOW_PROBES              2 // Number of window probes before falling back to a plain binary search
+#define DMRID_LOOKUP_CACHE_SIZE               16 // Number of decoded DMRIDs DB records kept in RAM
 
 #define TIMESLOT_DURATION                     30
 
@@ -176,8 +176,11 @@ typedef struct
 {
 	uint32_t			entries;
 	uint8_t				contactLength;
-	uint32_t			slices[ID_SLICES]; // [0] is min availabel ID, [ID_SLICES - 1] is max available ID
-	uint32_t			IDsPerSlice;
+	uint32_t			minID;
+	uint32_t			maxID;
+	uint32_t			IDsPerBlock;
+	uint32_t			blocks;
+	uint32_t			index[DMRID_INDEX_SIZE]; // First ID of each block of IDsPerBlock records
 } dmrIDsCache_t;
 
 
@@ -199,6 +202,7 @@ void dmrIDCacheInit(void);
 void dmrIDCacheClear(void);
 uint32_t dmrIDCacheGetCount(void);
 bool dmrIDLookup(uint32_t targetId, dmrIdDataStruct_t *foundRecord);
+void dmrIDLookupCacheGetStats(uint32_t *hits, uint32_t *misses);
 bool contactIDLookup(uint32_t id, uint32_t calltype, char *buffer);
 void uiUtilityRenderQSOData(void);
 void uiUtilityRenderHeader(bool isVFODualWatchScanning, bool isVFOSweepScanning);
@@ -36,6 +36,7 @@
 #include "interfaces/adc.h"
 #include "interfaces/batteryRAM.h"
 #include "hardware/SPI_Flash.h"
+#include "hardware/EEPROM.h"
 #include "interfaces/adc.h"
 #include "hardware/radioHardwareInterface.h"
 
@@ -52,7 +53,7 @@
 #include "interfaces/adc.h"
 #include "functions/rxPowerSaving.h"
 
-#if defined(USING_EXTERNAL_DEBUGGER)
+#if defined(USING_EXTERNAL_DEBUGGER) || defined(SPI_FLASH_BENCHMARK)
 #include "SeggerRTT/RTT/SEGGER_RTT.h"
 #endif
 
@@ -136,6 +137,66 @@ static void hexDump(uint8_t *ptr, int len)
 #endif
 
 
+#if defined(SPI_FLASH_BENCHMARK)
+static uint32_t benchmarkStart(void)
+{
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	SPI_Flash_resetStatistics();
+
+	return DWT->CYCCNT;
+}
+
+static void benchmarkEnd(const char *name, uint32_t startCycles, int iterations)
+{
+	uint32_t elapsedUs = (uint32_t)(((uint64_t)(DWT->CYCCNT - startCycles) * 1000000U) / SystemCoreClock);
+	spiFlashStatistics_t statistics;
+
+	SPI_Flash_getStatistics(&statistics);
+	SEGGER_RTT_printf(0, "%s: %u us for %d, %u reads (%u bytes)\n", name, elapsedUs, iterations, statistics.reads, statistics.readBytes);
+}
+
+// Times the codeplug and DMR ID DB accesses the UI relies on, using the installed codeplug and DB.
+static void benchmarkCodeplug(void)
+{
+	struct_codeplugContact_t contact;
+	struct_codeplugZone_t zone;
+	dmrIdDataStruct_t dmrIdRecord;
+	uint32_t startCycles;
+	int numZones;
+
+	startCycles = benchmarkStart();
+	codeplugInitCaches();
+	benchmarkEnd("Codeplug caches init", startCycles, 1);
+
+	startCycles = benchmarkStart();
+	dmrIDCacheInit();
+	benchmarkEnd("DMR ID cache init", startCycles, 1);
+
+	startCycles = benchmarkStart();
+	for (uint32_t tg = 1; tg <= 100; tg++)
+	{
+		codeplugContactIndexByTGorPC(tg, CONTACT_CALLTYPE_TG, &contact, ((tg & 0x01) + 1));
+	}
+	benchmarkEnd("Contact lookup", startCycles, 100);
+
+	numZones = codeplugZonesGetCount();
+	startCycles = benchmarkStart();
+	for (int i = 0; i < (numZones * 2); i++)
+	{
+		codeplugZoneGetDataForNumber((i % numZones), &zone);
+	}
+	benchmarkEnd("Zone switching", startCycles, (numZones * 2));
+
+	startCycles = benchmarkStart();
+	for (uint32_t id = 2340000; id < 2340100; id++)
+	{
+		dmrIDLookup(id, &dmrIdRecord);
+	}
+	benchmarkEnd("DMR ID lookup", startCycles, 100);
+}
+#endif
+
 static void keyBeepHandler(uiEvent_t *ev, bool ptttoggleddown)
 {
 	bool isScanning = (uiVFOModeIsScanning() || uiChannelModeIsScanning()) && !uiVFOModeSweepScanning(false);
@@ -386,6 +447,19 @@ void applicationMainTask(void)
 #endif
 
 	spiFlashInitHasFailed = !SPI_Flash_init();
+	if (spiFlashInitHasFailed == false)
+	{
+		EEPROM_Init();
+
+#if defined(SPI_FLASH_BENCHMARK)
+		for (int mode = SPI_FLASH_READ_MODE_NORMAL; mode <= SPI_FLASH_READ_MODE_FAST; mode++)
+		{
+			uint32_t bytesPerSecond = SPI_Flash_benchmarkReadMode(mode, 0x20000, (64 * 1024));
+
+			SEGGER_RTT_printf(0, "Flash read mode %d: %u.%02u MB/s\n", mode, (bytesPerSecond / 1000000), ((bytesPerSecond / 10000) % 100));
+		}
+#endif
+	}
 	if (spiFlashInitHasFailed)
 	{
 		safeBootBranching:
@@ -496,6 +570,10 @@ void applicationMainTask(void)
 	dmrIDCacheInit();
 	voicePromptsCacheInit();
 
+#if defined(SPI_FLASH_BENCHMARK)
+	benchmarkCodeplug();
+#endif
+
 	if (wasRestoringDefaultsettings || (keyboardRead() == KEY_HASH))
 	{
 		enableVoicePromptsIfLoaded((keyboardRead() == KEY_HASH));
@@ -1379,6 +1457,7 @@ void applicationMainTask(void)
 			gpsTick();
 			aprsBeaconingTick(&ev);
 			settingsSaveIfNeeded(false);
+			SPI_Flash_syncIfNeeded();
 
 			if (((trxTransmissionEnabled || trxIsTransmitting) == false))
 			{
@@ -32,104 +32,41 @@
 
 static uint16_t bitbuffer_encode[72];
 
-void codecDecode(uint8_t *indata_ptr, int numbBlocks)
-{
-	uint16_t bitbuffer_decode[49];
-
-
-	register int r0 asm ("r0") __attribute__((unused));
-	register int r1 asm ("r1") __attribute__((unused));
-	register int r2 asm ("r2") __attribute__((unused));
-
-    for (int idx = 0; idx < numbBlocks; idx++)
-    {
-		initFrame(indata_ptr, bitbuffer_decode);
-		indata_ptr += 9;
-
-		soundSetupBuffer();// this just sets currentWaveBuffer but the compiler seems to optimise out the code if I try to do it in this file
-		r2 = (int)bitbuffer_decode;
-		r0 = (int)currentWaveBuffer;
-		r1 = (int)ambebuffer_decode;
-
-		asm volatile (
-			"PUSH {R4-R11}\n"
-			"SUB SP, SP, #0x10\n"
-			"STR R1, [SP, #0x08]\n"
-			"LDR R1, =0\n"
-			"STR R1, [SP, #0x04]\n"
-			"LDR R1, =0\n"
-			"STR R1, [SP, #0x00]\n"
-			"LDR R3, =0\n"
-			"LDR R1, =80\n"
-			"BL " QU(AMBE_DECODE)
-			"ADD SP, SP, #0x10\n"
-			"POP {R4-R11}"
-		);
-
-		soundStoreBuffer();
-
-		soundSetupBuffer();// this just sets currentWaveBuffer but the compiler seems to optimise out the code if I try to do it in this file
-		r2 = (int)bitbuffer_decode;
-		r0 = (int)currentWaveBuffer;
-		r1 = (int)ambebuffer_decode;
-
-		asm volatile (
-			"PUSH {R4-R11}\n"
-			"SUB SP, SP, #0x10\n"
-			"STR R1, [SP, #0x08]\n"
-			"LDR R1, =1\n"
-			"STR R1, [SP, #0x04]\n"
-			"LDR R1, =0\n"
-			"STR R1, [SP, #0x00]\n"
-			"LDR R3, =0\n"
-			"LDR R1, =80\n"
-			"BL " QU(AMBE_DECODE)
-			"ADD SP, SP, #0x10\n"
-			"POP {R4-R11}"
-		);
-
-		soundStoreBuffer();
-    }
-}
-
-void codecEncodeBlock(uint8_t *outdata_ptr)
+//
+// AMBE blob calls. The blob expects its parameters in r0..r2 and on the stack, the half (20ms) of the block being on the stack.
+// The parameters are passed as asm operands, local register variables are only guaranteed to hold their value that way.
+// The blob follows the AAPCS, it's free to change r0..r3, r12 and lr.
+//
+static void codecAMBEDecodeHalfBlock(uint16_t bitbufferDecode[49], uint8_t *wavBuffer, int half)
 {
-	register int r0 asm ("r0") __attribute__((unused));
-	register int r1 asm ("r1") __attribute__((unused));
-	register int r2 asm ("r2") __attribute__((unused));
-
-	memset((uint8_t *)outdata_ptr, 0, 9);// fills with zeros
-	memset(bitbuffer_encode, 0, sizeof(bitbuffer_encode));// faster to call memset as it will be compiled as optimised code
-
-
-	soundRetrieveBuffer();// gets currentWaveBuffer pointer used as input r2 to the encoder
-
-	r0 = (int)bitbuffer_encode;
-	r2 = (int)currentWaveBuffer;//tmp_wavbuffer;
-	r1 = (int)ambebuffer_encode;// seems to be a hard coded (defined) memory address of 0x1FFF6B60. I'm not sure why it has to be hard coded, since its passed as a paramater (register)
+	register int r0 asm ("r0") = (int)wavBuffer;
+	register int r1 asm ("r1") = (int)ambebuffer_decode;
+	register int r2 asm ("r2") = (int)bitbufferDecode;
 
 	asm volatile (
 		"PUSH {R4-R11}\n"
-		"SUB SP, SP, #0x14\n"
-		"STR R1, [SP, #0x0C]\n"
-		"LDR R1, =0x00002000\n"
+		"SUB SP, SP, #0x10\n"
 		"STR R1, [SP, #0x08]\n"
+		"STR %[half], [SP, #0x04]\n"
 		"LDR R1, =0\n"
-		"STR R1, [SP, #0x04]\n"
-		"LDR R1, =0x00001840\n"
 		"STR R1, [SP, #0x00]\n"
-		"LDR R3, =80\n"
-		"LDR R1, =0\n"
-		"BL " QU(AMBE_ENCODE)
-		"ADD SP, SP, #0x14\n"
+		"LDR R3, =0\n"
+		"LDR R1, =80\n"
+		"BL " QU(AMBE_DECODE)
+		"ADD SP, SP, #0x10\n"
 		"POP {R4-R11}"
+		: "+r" (r0), "+r" (r1), "+r" (r2)
+		: [half] "r" (half)
+		: "r3", "r12", "lr", "cc", "memory"
 	);
+}
 
-	soundRetrieveBuffer();// gets currentWaveBuffer pointer used as input r2 to the encoder
-
-	r0 = (int)bitbuffer_encode;
-	r2 = (int)currentWaveBuffer;//tmp_wavbuffer;
-	r1 = (int)ambebuffer_encode;
+static void codecAMBEEncodeHalfBlock(uint16_t bitbufferEncode[72], uint8_t *wavBuffer, int half)
+{
+	register int r0 asm ("r0") = (int)bitbufferEncode;
+	register int r1 asm ("r1") = (int)ambebuffer_encode;// seems to be a hard coded (defined) memory address of 0x1FFF6B60. I'm not sure why it has to be hard coded, since its passed as a paramater (register)
+	register int r2 asm ("r2") = (int)wavBuffer;
+	int wavOffset = ((half == 0) ? 0x00001840 : 0x00000800);
 
 	asm volatile (
 		"PUSH {R4-R11}\n"
@@ -137,19 +74,23 @@ void codecEncodeBlock(uint8_t *outdata_ptr)
 		"STR R1, [SP, #0x0C]\n"
 		"LDR R1, =0x00002000\n"
 		"STR R1, [SP, #0x08]\n"
-		"LDR R1, =1\n"
-		"STR R1, [SP, #0x04]\n"
-		"LDR R1, =0x00000800\n"
-		"STR R1, [SP, #0x00]\n"
+		"STR %[half], [SP, #0x04]\n"
+		"STR %[wavOffset], [SP, #0x00]\n"
 		"LDR R3, =80\n"
 		"LDR R1, =0\n"
 		"BL " QU(AMBE_ENCODE)
 		"ADD SP, SP, #0x14\n"
 		"POP {R4-R11}"
+		: "+r" (r0), "+r" (r1), "+r" (r2)
+		: [half] "r" (half), [wavOffset] "r" (wavOffset)
+		: "r3", "r12", "lr", "cc", "memory"
 	);
+}
 
-	r0 = (int)bitbuffer_encode;
-	r1 = (int)ambebuffer_encode_ecc;
+static void codecAMBEEncodeECC(uint16_t bitbufferEncode[72])
+{
+	register int r0 asm ("r0") = (int)bitbufferEncode;
+	register int r1 asm ("r1") = (int)ambebuffer_encode_ecc;
 
 	asm volatile (
 		"PUSH {R4-R11}\n"
@@ -160,7 +101,42 @@ void codecEncodeBlock(uint8_t *outdata_ptr)
 		"BL " QU(AMBE_ENCODE_ECC)
 		"ADD SP, SP, #0x14\n"
 		"POP {R4-R11}"
+		: "+r" (r0), "+r" (r1)
+		:
+		: "r2", "r3", "r12", "lr", "cc", "memory"
 	);
+}
+
+void codecDecode(uint8_t *indata_ptr, int numbBlocks)
+{
+	uint16_t bitbuffer_decode[49];
+
+	for (int idx = 0; idx < numbBlocks; idx++)
+	{
+		initFrame(indata_ptr, bitbuffer_decode);
+		indata_ptr += 9;
+
+		for (int half = 0; half < 2; half++)
+		{
+			soundSetupBuffer();// sets currentWaveBuffer
+			codecAMBEDecodeHalfBlock(bitbuffer_decode, (uint8_t *)currentWaveBuffer, half);
+			soundStoreBuffer();
+		}
+	}
+}
+
+void codecEncodeBlock(uint8_t *outdata_ptr)
+{
+	memset((uint8_t *)outdata_ptr, 0, 9);// fills with zeros
+	memset(bitbuffer_encode, 0, sizeof(bitbuffer_encode));// faster to call memset as it will be compiled as optimised code
+
+	for (int half = 0; half < 2; half++)
+	{
+		soundRetrieveBuffer();// gets currentWaveBuffer pointer used as input to the encoder
+		codecAMBEEncodeHalfBlock(bitbuffer_encode, (uint8_t *)currentWaveBuffer, half);
+	}
+
+	codecAMBEEncodeECC(bitbuffer_encode);
 
 	for (int i = 0; i < 72; i++)
 	{
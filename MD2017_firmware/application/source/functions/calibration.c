@@ -178,6 +178,11 @@ typedef struct __attribute__((__packed__))
 static __attribute__((section(".ccmram"))) CalibrationData_t calibrationData;
 #define CALIBRATION_TABLE_LOCAL_COPY_ADDRESS  0x10000        //Flash address for local calibration copy.
 
+// Direct mapped, one slot per 6.25kHz step, so adjacent channels don't evict each other
+#define CALIBRATION_SNAPSHOT_CACHE_SIZE         32 // Needs to be a power of two
+#define CALIBRATION_SNAPSHOT_BUCKET_WIDTH      625 // 6.25kHz, in 10Hz units
+static calibrationSnapshot_t calibrationSnapshotCache[CALIBRATION_SNAPSHOT_CACHE_SIZE];
+
 const int MARKER_BYTES_LENGTH = 4;
 const uint8_t MARKER_BYTES[] = {0xCD, 0xE8, 0xEA, 0xE0};	//  400.02500   400.145
 
@@ -259,11 +264,14 @@ void calibrationInit(void)
             memcpy(&calibrationData.MARKER[0] , MARKER_BYTES , MARKER_BYTES_LENGTH);
             calibrationSaveLocal();																    //to the local copy
 	}
+
+	calibrationInvalidateSnapshots();
 }
 
 void calibrationReadLocal(void)
 {
 	(void)SPI_Flash_read(CALIBRATION_TABLE_LOCAL_COPY_ADDRESS , (uint8_t *)&calibrationData, CALIBRATION_TABLE_LENGTH);
+	calibrationInvalidateSnapshots();
 }
 
 void calibrationSaveLocal(void)
@@ -274,8 +282,51 @@ void calibrationSaveLocal(void)
 void calibrationReadFactory(void)
 {
 	(void)SPI_Flash_readSecurityRegisters(0, (uint8_t *)&calibrationData, CALIBRATION_TABLE_LENGTH);
+	calibrationInvalidateSnapshots();
+}
+
+static calibrationSnapshot_t *calibrationSnapshotSlotForFrequency(int freq)
+{
+	return &calibrationSnapshotCache[((uint32_t)freq / CALIBRATION_SNAPSHOT_BUCKET_WIDTH) & (CALIBRATION_SNAPSHOT_CACHE_SIZE - 1)];
+}
+
+static void calibrationFillSnapshot(calibrationSnapshot_t *snapshot, int freq)
+{
+	snapshot->frequency = 0; // Invalid until the slot is complete
+
+	snapshot->analogIGain = calibrationGetAnalogIGainForFrequency(freq);
+	snapshot->analogQGain = calibrationGetAnalogQGainForFrequency(freq);
+	snapshot->digitalIGain = calibrationGetDigitalIGainForFrequency(freq);
+	snapshot->digitalQGain = calibrationGetDigitalQGainForFrequency(freq);
+	calibrationGetPowerForFrequency(freq, &snapshot->powerSettings);
+
+	snapshot->frequency = freq;
+}
 
+// Returns the interpolated values for the given frequency, only computing them on a cache miss.
+// The pointer stays valid until the slot is reused by another frequency.
+const calibrationSnapshot_t *calibrationGetSnapshotForFrequency(int freq)
+{
+	calibrationSnapshot_t *snapshot = calibrationSnapshotSlotForFrequency(freq);
+
+	if (snapshot->frequency != (uint32_t)freq)
+	{
+		calibrationFillSnapshot(snapshot, freq);
+	}
 
+	return snapshot;
+}
+
+// Computes the snapshot ahead of time, e.g. for the channel the scan is about to switch to
+void calibrationPrefillSnapshotForFrequency(int freq)
+{
+	(void)calibrationGetSnapshotForFrequency(freq);
+}
+
+// Has to be called each time calibrationData is changed
+void calibrationInvalidateSnapshots(void)
+{
+	memset(calibrationSnapshotCache, 0, sizeof(calibrationSnapshotCache));
 }
 
 //look up the tuning voltage and interpolate between points (not used on MDuV380 but retained for MD-9600)
@@ -883,6 +934,8 @@ void calibrationPutPower(int freqindex, int powerindex, uint8_t val)
 				break;
 		}
 	}
+
+	calibrationInvalidateSnapshots();
 }
 
 uint8_t *calibrationGetLocalDataPointer(void)
@@ -42,6 +42,7 @@
 const int CODEPLUG_ADDR_EX_ZONE_BASIC = 0x8000;
 const int CODEPLUG_ADDR_EX_ZONE_INUSE_PACKED_DATA = 0x8010;
 #define CODEPLUG_EX_ZONE_INUSE_PACKED_DATA_SIZE  32
+#define CODEPLUG_ZONES_CACHE_SIZE                 4 // Number of recently used zones kept in RAM
 const int CODEPLUG_ADDR_EX_ZONE_LIST = 0x8030;
 
 const int CODEPLUG_ZONE_MAX_COUNT = 250;
@@ -103,6 +104,7 @@ typedef struct
 {
 	uint32_t tgOrPCNum;
 	uint16_t index;
+	uint8_t  reserve1; // TS override flags, see struct_codeplugContact_t
 } codeplugContactCache_t;
 
 
@@ -118,6 +120,7 @@ typedef struct
 	int numALLContacts;
 	int numDTMFContacts;
 	codeplugContactCache_t contactsLookupCache[CODEPLUG_CONTACTS_MAX];
+	uint16_t contactsSortedByTGorPC[CODEPLUG_CONTACTS_MAX]; // Positions in contactsLookupCache, sorted on tgOrPCNum then position
 	codeplugDTMFContactCache_t contactsDTMFLookupCache[CODEPLUG_DTMF_CONTACTS_MAX];
 } codeplugContactsCache_t;
 
@@ -136,7 +139,20 @@ __attribute__((section(".data.$RAM2"))) codeplugContactsCache_t codeplugContacts
 
 __attribute__((section(".data.$RAM2"))) uint8_t codeplugRXGroupCache[CODEPLUG_RX_GROUPLIST_MAX];
 __attribute__((section(".data.$RAM2"))) uint8_t codeplugAllChannelsCache[128];
+__attribute__((section(".data.$RAM2"))) codeplugChannelSummary_t codeplugChannelsSummaryCache[CODEPLUG_CHANNELS_MAX];
 __attribute__((section(".data.$RAM2"))) uint8_t codeplugZonesInUseCache[CODEPLUG_EX_ZONE_INUSE_PACKED_DATA_SIZE];
+__attribute__((section(".data.$RAM2"))) uint8_t codeplugZonesSlotForNumber[CODEPLUG_EX_ZONE_INUSE_PACKED_DATA_SIZE * 8]; // Zone number to zone data index (select table)
+static int codeplugZonesCount = 1;
+
+typedef struct
+{
+	struct_codeplugZone_t zone;
+	uint32_t              lastUse;
+	bool                  valid;
+} codeplugZoneCacheEntry_t;
+
+__attribute__((section(".data.$RAM2"))) codeplugZoneCacheEntry_t codeplugZonesCache[CODEPLUG_ZONES_CACHE_SIZE];
+static uint32_t codeplugZonesCacheUseCounter = 0;
 __attribute__((section(".data.$RAM2"))) uint16_t quickKeysCache[CODEPLUG_QUICKKEYS_SIZE];
 
 __attribute__((section(".data.$RAM2"))) uint8_t lastUsedChannelInZoneData[CODEPLUG_ALL_ZONES_MAX + 1]; // All zones (0..79) + AllChannel 0..1023 (hence one extra byte to store this value)
@@ -144,7 +160,6 @@ static bool lastUsedChannelInZoneHasChanged = false;
 
 __attribute__((section(".data.$RAM2"))) codeplugAPRSConfigsCache_t codeplugAPRSCache;
 
-static bool codeplugContactGetReserve1ByteForIndex(int index, struct_codeplugContact_t *contact);
 
 uint32_t byteSwap32(uint32_t n)
 {
@@ -294,19 +309,54 @@ void codeplugUtilConvertStringToBuf(char *inBuf, char *outBuf, int len)
 
 void codeplugZonesInitCache(void)
 {
+	int numZones = 0;
+
 	EEPROM_Read(CODEPLUG_ADDR_EX_ZONE_INUSE_PACKED_DATA, (uint8_t *)&codeplugZonesInUseCache, CODEPLUG_EX_ZONE_INUSE_PACKED_DATA_SIZE);
+
+	// Because the Zones data is not guaranteed to be packed by the CPS (though we should attempt to make the CPS always pack the Zones),
+	// store the index into the Zones data of each Zone number
+	for(int i = 0; i < (CODEPLUG_EX_ZONE_INUSE_PACKED_DATA_SIZE * 8); i++)
+	{
+		if (((codeplugZonesInUseCache[i / 8] >> (i % 8)) & 0x01) == 0x01)
+		{
+			codeplugZonesSlotForNumber[numZones++] = i;
+		}
+	}
+
+	codeplugZonesCount = numZones + 1;// Add one extra zone to allow for the special 'All Channels' Zone
+
+	memset(codeplugZonesCache, 0, sizeof(codeplugZonesCache));
 }
 
 int codeplugZonesGetCount(void)
 {
-	int numZones = 1;// Add one extra zone to allow for the special 'All Channels' Zone
+	return codeplugZonesCount;
+}
 
-	for(int i = 0; i < CODEPLUG_EX_ZONE_INUSE_PACKED_DATA_SIZE; i++)
+// Returns the cache entry holding the Zone data at index, or the one to reuse for it
+static codeplugZoneCacheEntry_t *codeplugZonesCacheFind(int index, bool *found)
+{
+	codeplugZoneCacheEntry_t *entry = &codeplugZonesCache[0];
+
+	for (int i = 0; i < CODEPLUG_ZONES_CACHE_SIZE; i++)
 	{
-		numZones += __builtin_popcount(codeplugZonesInUseCache[i]);
+		codeplugZoneCacheEntry_t *e = &codeplugZonesCache[i];
+
+		if (e->valid && (e->zone.NOT_IN_CODEPLUGDATA_indexNumber == index))
+		{
+			*found = true;
+			return e;
+		}
+
+		// Keep track of the least recently used entry, an empty one being the best choice
+		if (entry->valid && ((e->valid == false) || (e->lastUse < entry->lastUse)))
+		{
+			entry = e;
+		}
 	}
 
-	return numZones;
+	*found = false;
+	return entry;
 }
 
 bool codeplugZoneGetDataForNumber(int zoneNum, struct_codeplugZone_t *returnBuf)
@@ -330,32 +380,21 @@ bool codeplugZoneGetDataForNumber(int zoneNum, struct_codeplugZone_t *returnBuf)
 	else
 	{
 		// Need to find the index into the Zones data for the specific Zone number.
-		// Because the Zones data is not guaranteed to be packed by the CPS (though we should attempt to make the CPS always pack the Zones)
-		int count = -1;// Need to start counting at -1 because the Zone number is zero indexed
-		int foundIndex = -1;
+		int foundIndex = (((zoneNum >= 0) && (zoneNum < (codeplugZonesCount - 1))) ? codeplugZonesSlotForNumber[zoneNum] : -1);
 
-		// Go though each byte in the In Use table
-		for(int i = 0; i < CODEPLUG_EX_ZONE_INUSE_PACKED_DATA_SIZE; i++)
+		if (foundIndex != -1)
 		{
-			// Go though each binary bit, counting them one by one
-			for(int j = 0; j < 8; j++)
+			bool cached;
+			codeplugZoneCacheEntry_t *cacheEntry = codeplugZonesCacheFind(foundIndex, &cached);
+
+			cacheEntry->lastUse = ++codeplugZonesCacheUseCounter;
+
+			if (cached)
 			{
-				if (((codeplugZonesInUseCache[i] >> j) & 0x01) == 0x01)
-				{
-					count++;
-
-					if (count == zoneNum)
-					{
-						// found it. So save the index before we exit the "for" loops
-						foundIndex = (i * 8) + j;
-						break;// Will break out of this loop, but the outer loop breaks because it also checks for foundIndex
-					}
-				}
+				memcpy(returnBuf, &cacheEntry->zone, sizeof(struct_codeplugZone_t));
+				return true;
 			}
-		}
 
-		if (foundIndex != -1)
-		{
 			// Save this in case we need to add channels to a zone and hence need the index number so it can be saved back to the codeplug memory
 			returnBuf->NOT_IN_CODEPLUGDATA_indexNumber = foundIndex;
 
@@ -370,6 +409,9 @@ bool codeplugZoneGetDataForNumber(int zoneNum, struct_codeplugZone_t *returnBuf)
 				if ((returnBuf->channels[i] == 0) || (i == (codeplugChannelsPerZone - 1)))
 				{
 					returnBuf->NOT_IN_CODEPLUGDATA_highestIndex = returnBuf->NOT_IN_CODEPLUGDATA_numChannelsInZone = (i + ((returnBuf->channels[i] == 0) ? 0 : 1));
+
+					memcpy(&cacheEntry->zone, returnBuf, sizeof(struct_codeplugZone_t));
+					cacheEntry->valid = true;
 					return true;
 				}
 			}
@@ -390,6 +432,14 @@ bool codeplugZoneAddChannelToZoneAndSave(int channelIndex, struct_codeplugZone_t
 		zoneBuf->channels[zoneBuf->NOT_IN_CODEPLUGDATA_numChannelsInZone++] = channelIndex;// add channel to zone, and increment numb channels in zone
 		zoneBuf->NOT_IN_CODEPLUGDATA_highestIndex = zoneBuf->NOT_IN_CODEPLUGDATA_numChannelsInZone;
 
+		// Keep the cached copy of this zone, if any, in step
+		bool cached;
+		codeplugZoneCacheEntry_t *cacheEntry = codeplugZonesCacheFind(zoneBuf->NOT_IN_CODEPLUGDATA_indexNumber, &cached);
+		if (cached)
+		{
+			memcpy(&cacheEntry->zone, zoneBuf, sizeof(struct_codeplugZone_t));
+		}
+
 		// IMPORTANT. Write size is different from the size of the data, because it the zone struct contains properties not in the codeplug data
 		return EEPROM_Write(CODEPLUG_ADDR_EX_ZONE_LIST + (zoneBuf->NOT_IN_CODEPLUGDATA_indexNumber * (16 + (sizeof(uint16_t) * codeplugChannelsPerZone))),
 				(uint8_t *)zoneBuf, ((codeplugChannelsPerZone == 16) ? CODEPLUG_ZONE_DATA_ORIGINAL_STRUCT_SIZE : CODEPLUG_ZONE_DATA_OPENGD77_STRUCT_SIZE));
@@ -464,6 +514,58 @@ void codeplugAllChannelsIndexSetUsed(int index)
 
 
 
+static void codeplugChannelSetSummaryForIndex(int index, struct_codeplugChannel_t *channelBuf)
+{
+	if ((index < CODEPLUG_CHANNELS_MIN) || (index > CODEPLUG_CHANNELS_MAX))
+	{
+		return;
+	}
+
+	codeplugChannelSummary_t *summary = &codeplugChannelsSummaryCache[index - 1];
+
+	summary->rxFreq = channelBuf->rxFreq;
+	summary->isDigital = (channelBuf->chMode == RADIO_MODE_DIGITAL);
+	summary->rxTone = channelBuf->rxTone;
+	summary->flag4 = channelBuf->flag4;
+	summary->nameHash = codeplugChannelNameHash(channelBuf->name);
+}
+
+static void codeplugChannelsSummaryInitCache(void)
+{
+	struct_codeplugChannel_t channel;
+	spiFlashReadAhead_t      readAhead; // Flash channels are read sequentially
+
+	memset(codeplugChannelsSummaryCache, 0, sizeof(codeplugChannelsSummaryCache));
+
+	SPI_Flash_readAheadInit(&readAhead, FLASH_ADDRESS_OFFSET + CODEPLUG_ADDR_CHANNEL_FLASH);
+
+	for (int index = CODEPLUG_CHANNELS_MIN; index <= allChannelsHighestChannelIndex; index++)
+	{
+		if (codeplugAllChannelsIndexIsInUse(index))
+		{
+			if (index <= 128)
+			{
+				EEPROM_Read(CODEPLUG_ADDR_CHANNEL_EEPROM + ((index - 1) * CODEPLUG_CHANNEL_DATA_STRUCT_SIZE), (uint8_t *)&channel, CODEPLUG_CHANNEL_DATA_STRUCT_SIZE);
+			}
+			else
+			{
+				int flashIndex = (index - 1) - 128;// Same layout as in codeplugChannelGetDataWithOffsetAndLengthForIndex()
+
+				SPI_Flash_readAheadRead(&readAhead, FLASH_ADDRESS_OFFSET + CODEPLUG_ADDR_CHANNEL_FLASH + (16 * (flashIndex / 128)) + (flashIndex * CODEPLUG_CHANNEL_DATA_STRUCT_SIZE),
+						(uint8_t *)&channel, CODEPLUG_CHANNEL_DATA_STRUCT_SIZE);
+			}
+
+			channel.chMode = (channel.chMode == 0) ? RADIO_MODE_ANALOG : RADIO_MODE_DIGITAL;
+			channel.rxFreq = bcd2int(channel.rxFreq);
+			channel.rxTone = codeplugCSSToInt(channel.rxTone);
+
+			codeplugChannelSetSummaryForIndex(index, &channel);
+		}
+	}
+
+	SPI_Flash_readAheadEnd(&readAhead);
+}
+
 void codeplugAllChannelsInitCache(void)
 {
 	// There are 8 banks
@@ -484,6 +586,34 @@ void codeplugAllChannelsInitCache(void)
 	}
 
 	allChannelsTotalNumOfChannels = codeplugAllChannelsGetCount();
+
+	codeplugChannelsSummaryInitCache();
+}
+
+// Returns the summary of a channel, all zeros if the channel isn't in use
+const codeplugChannelSummary_t *codeplugChannelGetSummaryForIndex(int index)
+{
+	static const codeplugChannelSummary_t emptySummary = { 0 };
+
+	if ((index >= CODEPLUG_CHANNELS_MIN) && (index <= CODEPLUG_CHANNELS_MAX))
+	{
+		return &codeplugChannelsSummaryCache[index - 1];
+	}
+
+	return &emptySummary;
+}
+
+// 8 bits FNV-1a like hash of a 0xFF (or 0x00) terminated codeplug name
+uint8_t codeplugChannelNameHash(const char *name)
+{
+	uint8_t hash = 0x81;
+
+	for (int i = 0; (i < 16) && (name[i] != (char)0xFF) && (name[i] != 0x00); i++)
+	{
+		hash = (hash ^ (uint8_t)name[i]) * 0x1B;
+	}
+
+	return hash;
 }
 
 uint32_t codeplugChannelGetOptionalDMRID(struct_codeplugChannel_t *channelBuf)
@@ -662,6 +792,7 @@ void codeplugChannelGetDataForIndex(int index, struct_codeplugChannel_t *channel
 bool codeplugChannelSaveDataForIndex(int index, struct_codeplugChannel_t *channelBuf)
 {
 	bool retVal = true;
+	int channelIndex = index;
 #if defined(PLATFORM_MD9600)
 	bool outOfBandFlag = ((channelBuf->LibreDMR_flag1 & CODEPLUG_CHANNEL_LIBREDMR_FLAG1_OUT_OF_BAND) != 0);
 
@@ -685,9 +816,6 @@ bool codeplugChannelSaveDataForIndex(int index, struct_codeplugChannel_t *channe
 	else
 	{
 		int flashWritePos = CODEPLUG_ADDR_CHANNEL_FLASH;
-		int flashSector;
-		int flashEndSector;
-		int bytesToWriteInCurrentSector = CODEPLUG_CHANNEL_DATA_STRUCT_SIZE;
 
 		index -= 128;// First 128 channels are in the EEPOM, so subtract 128 from the number when looking in the Flash
 
@@ -695,61 +823,10 @@ bool codeplugChannelSaveDataForIndex(int index, struct_codeplugChannel_t *channe
 		flashWritePos += 16 * (index / 128);// we just need to skip over that these flag bits when calculating the position of the channel data in memory
 		flashWritePos += index * CODEPLUG_CHANNEL_DATA_STRUCT_SIZE;// go to the position of the specific index
 
-		flashSector 	= flashWritePos / 4096;
-		flashEndSector 	= (flashWritePos + CODEPLUG_CHANNEL_DATA_STRUCT_SIZE) / 4096;
-
-		if (flashSector != flashEndSector)
-		{
-			bytesToWriteInCurrentSector = (flashEndSector * 4096) - flashWritePos;
-		}
-
-		SPI_Flash_read(FLASH_ADDRESS_OFFSET + (flashSector * 4096), SPI_Flash_sectorbuffer, 4096);
-		uint8_t *writePos = SPI_Flash_sectorbuffer + flashWritePos - (flashSector * 4096);
-		memcpy(writePos, channelBuf, bytesToWriteInCurrentSector);
-
-		retVal = SPI_Flash_eraseSector(FLASH_ADDRESS_OFFSET + (flashSector * 4096));
-		if (!retVal)
-		{
-			goto errorExit;
-		}
-
-		for (int i = 0; i < 16; i++)
-		{
-			retVal = SPI_Flash_writePage(FLASH_ADDRESS_OFFSET + (flashSector * 4096) + (i * 256), SPI_Flash_sectorbuffer + (i * 256));
-			if (!retVal)
-			{
-				goto errorExit;
-			}
-		}
-
-		if (flashSector != flashEndSector)
-		{
-			uint8_t *channelBufPusOffset = (uint8_t *)channelBuf + bytesToWriteInCurrentSector;
-			bytesToWriteInCurrentSector = CODEPLUG_CHANNEL_DATA_STRUCT_SIZE - bytesToWriteInCurrentSector;
-
-			SPI_Flash_read(FLASH_ADDRESS_OFFSET + (flashEndSector * 4096), SPI_Flash_sectorbuffer, 4096);
-			memcpy(SPI_Flash_sectorbuffer, (uint8_t *)channelBufPusOffset, bytesToWriteInCurrentSector);
-
-			retVal = SPI_Flash_eraseSector(FLASH_ADDRESS_OFFSET + (flashEndSector * 4096));
-
-			if (!retVal)
-			{
-				goto errorExit;
-			}
-			for (int i = 0; i < 16; i++)
-			{
-				retVal = SPI_Flash_writePage(FLASH_ADDRESS_OFFSET + (flashEndSector * 4096) + (i * 256), SPI_Flash_sectorbuffer + (i * 256));
-
-				if (!retVal)
-				{
-					goto errorExit;
-				}
-			}
-
-		}
+		// Merged into the Flash write cache, consecutive saves in the same sector only cost one erase.
+		retVal = SPI_Flash_write(FLASH_ADDRESS_OFFSET + flashWritePos, (uint8_t *)channelBuf, CODEPLUG_CHANNEL_DATA_STRUCT_SIZE);
 	}
 
-errorExit:
 #if defined(PLATFORM_MD9600)
 	if (outOfBandFlag)
 	{
@@ -765,6 +842,11 @@ errorExit:
 	channelBuf->txTone = codeplugCSSToInt(channelBuf->txTone);
 	channelBuf->rxTone = codeplugCSSToInt(channelBuf->rxTone);
 
+	if (retVal)
+	{
+		codeplugChannelSetSummaryForIndex(channelIndex, channelBuf);
+	}
+
 	return retVal;
 }
 
@@ -869,52 +951,124 @@ int codeplugContactGetDataForNumberInType(int number, uint32_t callType, struct_
 	return 0;
 }
 
+// Returns the first slot of contactsSortedByTGorPC holding an entry >= (tgOrPCNum, pos)
+static int codeplugContactsSortedLowerBound(uint32_t tgOrPCNum, int pos, int numContacts)
+{
+	int first = 0;
+	int last = numContacts;
+
+	while (first < last)
+	{
+		int mid = (first + last) >> 1;
+		int midPos = codeplugContactsCache.contactsSortedByTGorPC[mid];
+		uint32_t midTGorPCNum = codeplugContactsCache.contactsLookupCache[midPos].tgOrPCNum;
+
+		if ((midTGorPCNum < tgOrPCNum) || ((midTGorPCNum == tgOrPCNum) && (midPos < pos)))
+		{
+			first = mid + 1;
+		}
+		else
+		{
+			last = mid;
+		}
+	}
+
+	return first;
+}
+
+// Add the contactsLookupCache entry at pos, numContacts being the count before the insertion.
+// Positions of the following entries must already have been shifted.
+static void codeplugContactsSortedInsert(int pos, int numContacts)
+{
+	int slot = codeplugContactsSortedLowerBound(codeplugContactsCache.contactsLookupCache[pos].tgOrPCNum, pos, numContacts);
+
+	memmove(&codeplugContactsCache.contactsSortedByTGorPC[slot + 1], &codeplugContactsCache.contactsSortedByTGorPC[slot], (numContacts - slot) * sizeof(uint16_t));
+	codeplugContactsCache.contactsSortedByTGorPC[slot] = pos;
+}
+
+// Remove the contactsLookupCache entry at pos, numContacts being the count before the removal.
+static void codeplugContactsSortedRemove(int pos, int numContacts)
+{
+	int slot = codeplugContactsSortedLowerBound(codeplugContactsCache.contactsLookupCache[pos].tgOrPCNum, pos, numContacts);
+
+	memmove(&codeplugContactsCache.contactsSortedByTGorPC[slot], &codeplugContactsCache.contactsSortedByTGorPC[slot + 1], (numContacts - 1 - slot) * sizeof(uint16_t));
+}
+
+// Keep the sorted positions in step with an insertion (+1) or a removal (-1) at pos in contactsLookupCache
+static void codeplugContactsSortedShiftPositions(int pos, int delta, int numContacts)
+{
+	for (int i = 0; i < numContacts; i++)
+	{
+		if (codeplugContactsCache.contactsSortedByTGorPC[i] >= pos)
+		{
+			codeplugContactsCache.contactsSortedByTGorPC[i] += delta;
+		}
+	}
+}
+
+// Scan the contacts matching tgOrPCNum from position number, in position order,
+// returning the first one that matches the TS override and the first one at all.
+static void codeplugContactsFindMatches(uint32_t tgOrPCNum, int number, uint8_t optionalTS, int numContacts, int *tsMatch, int *firstMatch)
+{
+	for (int i = codeplugContactsSortedLowerBound(tgOrPCNum, number, numContacts); i < numContacts; i++)
+	{
+		int pos = codeplugContactsCache.contactsSortedByTGorPC[i];
+		uint8_t reserve1 = codeplugContactsCache.contactsLookupCache[pos].reserve1;
+
+		if (codeplugContactsCache.contactsLookupCache[pos].tgOrPCNum != tgOrPCNum)
+		{
+			break;
+		}
+
+		if ((*firstMatch < 0) || (pos < *firstMatch))
+		{
+			*firstMatch = pos;
+		}
+
+		// Check for the contact TS override
+		if ((optionalTS == 0) ||
+				(((reserve1 & CODEPLUG_CONTACT_FLAG_NO_TS_OVERRIDE) == 0x00) && (((reserve1 & CODEPLUG_CONTACT_FLAG_TS_OVERRIDE_TIMESLOT_MASK) >> 1) == (optionalTS - 1))))
+		{
+			if ((*tsMatch < 0) || (pos < *tsMatch))
+			{
+				*tsMatch = pos;
+			}
+			break;
+		}
+	}
+}
+
 // optionalTS: 0 = no TS checking, 1..2 = TS
 int codeplugContactIndexByTGorPCFromNumber(int number, uint32_t tgorpc, uint32_t callType, struct_codeplugContact_t *contact, uint8_t optionalTS)
 {
 	int numContacts = codeplugContactsCache.numTGContacts + codeplugContactsCache.numALLContacts + codeplugContactsCache.numPCContacts;
+	int tsMatch = -1;
 	int firstMatch = -1;
 
-	for (int i = number; i < numContacts; i++)
+	if (tgorpc == ALL_CALL_VALUE)
 	{
-		if (((codeplugContactsCache.contactsLookupCache[i].tgOrPCNum & 0xFFFFFF) == tgorpc) &&
-				/* All Call, hence ignore callType */
-				((tgorpc == ALL_CALL_VALUE) || ((codeplugContactsCache.contactsLookupCache[i].tgOrPCNum >> 24) == callType)))
+		// All Call, hence ignore callType
+		for (uint32_t ct = CONTACT_CALLTYPE_TG; ct <= CONTACT_CALLTYPE_ALL; ct++)
 		{
-			// Check for the contact TS override
-			if (optionalTS > 0)
-			{
-				// Just read the reserve1 byte for now
-				codeplugContactGetReserve1ByteForIndex(codeplugContactsCache.contactsLookupCache[i].index, contact);
-
-				if (((contact->reserve1 & CODEPLUG_CONTACT_FLAG_NO_TS_OVERRIDE) == 0x00) && (((contact->reserve1 & CODEPLUG_CONTACT_FLAG_TS_OVERRIDE_TIMESLOT_MASK) >> 1) == (optionalTS - 1)))
-				{
-					codeplugContactGetDataForIndex(codeplugContactsCache.contactsLookupCache[i].index, contact);
-					return i;
-				}
-				else
-				{
-					if (firstMatch < 0)
-					{
-						firstMatch = i;
-					}
-				}
-			}
-			else
-			{
-				codeplugContactGetDataForIndex(codeplugContactsCache.contactsLookupCache[i].index, contact);
-				return i;
-			}
+			codeplugContactsFindMatches((tgorpc | (ct << 24)), number, optionalTS, numContacts, &tsMatch, &firstMatch);
 		}
 	}
+	else
+	{
+		codeplugContactsFindMatches(((tgorpc & 0xFFFFFF) | (callType << 24)), number, optionalTS, numContacts, &tsMatch, &firstMatch);
+	}
 
-	if (firstMatch >= 0)
+	if (tsMatch < 0)
 	{
-		codeplugContactGetDataForIndex(codeplugContactsCache.contactsLookupCache[firstMatch].index, contact);
-		return firstMatch;
+		tsMatch = firstMatch;
 	}
 
-	return -1;
+	if (tsMatch >= 0)
+	{
+		codeplugContactGetDataForIndex(codeplugContactsCache.contactsLookupCache[tsMatch].index, contact);
+	}
+
+	return tsMatch;
 }
 
 // optionalTS: 0 = no TS checking, 1..2 = TS
@@ -926,17 +1080,14 @@ int codeplugContactIndexByTGorPC(uint32_t tgorpc, uint32_t callType, struct_code
 bool codeplugContactsContainsPC(uint32_t pc)
 {
 	int numContacts =  codeplugContactsCache.numTGContacts + codeplugContactsCache.numALLContacts + codeplugContactsCache.numPCContacts;
+	int slot;
+
 	pc = pc & 0x00FFFFFF;
 	pc = pc | (CONTACT_CALLTYPE_PC << 24);
 
-	for (int i = 0; i < numContacts; i++)
-	{
-		if (codeplugContactsCache.contactsLookupCache[i].tgOrPCNum == pc)
-		{
-			return true;
-		}
-	}
-	return false;
+	slot = codeplugContactsSortedLowerBound(pc, 0, numContacts);
+
+	return ((slot < numContacts) && (codeplugContactsCache.contactsLookupCache[codeplugContactsCache.contactsSortedByTGorPC[slot]].tgOrPCNum == pc));
 }
 
 static void codeplugInitContactsCache(void)
@@ -944,21 +1095,25 @@ static void codeplugInitContactsCache(void)
 	struct_codeplugContact_t contact;
 	uint8_t                  c;
 	int                      codeplugNumContacts = 0;
+	spiFlashReadAhead_t      readAhead; // Contacts are read sequentially
 
 	codeplugContactsCache.numTGContacts = 0;
 	codeplugContactsCache.numPCContacts = 0;
 	codeplugContactsCache.numALLContacts = 0;
 	codeplugContactsCache.numDTMFContacts = 0;
 
+	SPI_Flash_readAheadInit(&readAhead, FLASH_ADDRESS_OFFSET + CODEPLUG_ADDR_CONTACTS);
+
 	for(int i = 0; i < CODEPLUG_CONTACTS_MAX; i++)
 	{
-		if (SPI_Flash_read(FLASH_ADDRESS_OFFSET + (CODEPLUG_ADDR_CONTACTS + (i * CODEPLUG_CONTACT_DATA_SIZE)), (uint8_t *)&contact, 16 + 4 + 1))// Name + TG/ID + Call type
+		if (SPI_Flash_readAheadRead(&readAhead, FLASH_ADDRESS_OFFSET + (CODEPLUG_ADDR_CONTACTS + (i * CODEPLUG_CONTACT_DATA_SIZE)), (uint8_t *)&contact, 16 + 4 + 4))// Name + TG/ID + Call type .. reserve1
 		{
 			if (contact.name[0] != 0xFF)
 			{
 				codeplugContactsCache.contactsLookupCache[codeplugNumContacts].tgOrPCNum = bcd2int(byteSwap32(contact.tgNumber));
 				codeplugContactsCache.contactsLookupCache[codeplugNumContacts].index = i + 1;// Contacts are numbered from 1 to 1024
 				codeplugContactsCache.contactsLookupCache[codeplugNumContacts].tgOrPCNum |= (contact.callType << 24);// Store the call type in the upper byte
+				codeplugContactsCache.contactsLookupCache[codeplugNumContacts].reserve1 = contact.reserve1;
 				if (contact.callType == CONTACT_CALLTYPE_PC)
 				{
 					codeplugContactsCache.numPCContacts++;
@@ -976,6 +1131,13 @@ static void codeplugInitContactsCache(void)
 			}
 		}
 	}
+	SPI_Flash_readAheadEnd(&readAhead);
+
+	codeplugNumContacts = codeplugContactsCache.numTGContacts + codeplugContactsCache.numALLContacts + codeplugContactsCache.numPCContacts;
+	for (int i = 0; i < codeplugNumContacts; i++)
+	{
+		codeplugContactsSortedInsert(i, i);
+	}
 
 	for (int i = 0; i < CODEPLUG_DTMF_CONTACTS_MAX; i++)
 	{
@@ -1032,8 +1194,11 @@ void codeplugContactsCacheUpdateOrInsertContactAt(int index, struct_codeplugCont
 				}
 			}
 			//update the
+			codeplugContactsSortedRemove(i, numContacts);
 			codeplugContactsCache.contactsLookupCache[i].tgOrPCNum = bcd2int(byteSwap32(contact->tgNumber));
 			codeplugContactsCache.contactsLookupCache[i].tgOrPCNum |= (contact->callType << 24);// Store the call type in the upper byte
+			codeplugContactsCache.contactsLookupCache[i].reserve1 = contact->reserve1;
+			codeplugContactsSortedInsert(i, (numContacts - 1));
 
 			return;
 		}
@@ -1058,10 +1223,13 @@ void codeplugContactsCacheUpdateOrInsertContactAt(int index, struct_codeplugCont
 
 				// Note . Need to use memmove as the source and destination overlap.
 				memmove(&codeplugContactsCache.contactsLookupCache[i + 2], &codeplugContactsCache.contactsLookupCache[i + 1], (numContacts - 2 - i) * sizeof(codeplugContactCache_t));
+				codeplugContactsSortedShiftPositions((i + 1), 1, (numContacts - 1));
 
 				codeplugContactsCache.contactsLookupCache[i + 1].tgOrPCNum = bcd2int(byteSwap32(contact->tgNumber));
 				codeplugContactsCache.contactsLookupCache[i + 1].index = index;// Contacts are numbered from 1 to 1024
 				codeplugContactsCache.contactsLookupCache[i + 1].tgOrPCNum |= (contact->callType << 24);// Store the call type in the upper byte
+				codeplugContactsCache.contactsLookupCache[i + 1].reserve1 = contact->reserve1;
+				codeplugContactsSortedInsert((i + 1), (numContacts - 1));
 				return;
 			}
 		}
@@ -1087,6 +1255,8 @@ void codeplugContactsCacheUpdateOrInsertContactAt(int index, struct_codeplugCont
 	codeplugContactsCache.contactsLookupCache[numContacts].tgOrPCNum = bcd2int(byteSwap32(contact->tgNumber));
 	codeplugContactsCache.contactsLookupCache[numContacts].index = index;// Contacts are numbered from 1 to 1024
 	codeplugContactsCache.contactsLookupCache[numContacts].tgOrPCNum |= (contact->callType << 24);// Store the call type in the upper byte
+	codeplugContactsCache.contactsLookupCache[numContacts].reserve1 = contact->reserve1;
+	codeplugContactsSortedInsert(numContacts, numContacts);
 }
 
 void codeplugContactsCacheRemoveContactAt(int index)
@@ -1110,8 +1280,10 @@ void codeplugContactsCacheRemoveContactAt(int index)
 			{
 				codeplugContactsCache.numALLContacts--;
 			}
+			codeplugContactsSortedRemove(i, numContacts);
 			// Note memcpy should work here, because memcpy normally copys from the lowest memory location upwards
 			memcpy(&codeplugContactsCache.contactsLookupCache[i], &codeplugContactsCache.contactsLookupCache[i + 1], (numContacts - 1 - i) * sizeof(codeplugContactCache_t));
+			codeplugContactsSortedShiftPositions((i + 1), -1, (numContacts - 1));
 			return;
 		}
 	}
@@ -1160,18 +1332,6 @@ bool codeplugDTMFContactGetDataForIndex(int index, struct_codeplugDTMFContact_t
 	return false;
 }
 
-static bool codeplugContactGetReserve1ByteForIndex(int index, struct_codeplugContact_t *contact)
-{
-	if (((codeplugContactsCache.numTGContacts > 0) || (codeplugContactsCache.numPCContacts > 0) || (codeplugContactsCache.numALLContacts > 0)) &&
-			(index >= CODEPLUG_CONTACTS_MIN) && (index <= CODEPLUG_CONTACTS_MAX))
-	{
-		index--;
-		SPI_Flash_read(FLASH_ADDRESS_OFFSET + CODEPLUG_ADDR_CONTACTS + (index * CODEPLUG_CONTACT_DATA_SIZE) + 23 , (uint8_t *)contact + 23, 1);
-		return true;
-	}
-	return false;
-}
-
 bool codeplugContactGetDataForIndex(int index, struct_codeplugContact_t *contact)
 {
 	char buf[SCREEN_LINE_BUFFER_SIZE];
@@ -1200,9 +1360,6 @@ int codeplugContactSaveDataForIndex(int index, struct_codeplugContact_t *contact
 {
 	int retVal;
 	int flashWritePos = CODEPLUG_ADDR_CONTACTS;
-	int flashSector;
-	int flashEndSector;
-	int bytesToWriteInCurrentSector = CODEPLUG_CONTACT_DATA_SIZE;
 	uint32_t unconvertedTgNumber = contact->tgNumber;
 
 	index--;
@@ -1210,59 +1367,13 @@ int codeplugContactSaveDataForIndex(int index, struct_codeplugContact_t *contact
 
 	flashWritePos += index * CODEPLUG_CONTACT_DATA_SIZE;// go to the position of the specific index
 
-	flashSector 	= flashWritePos / 4096;
-	flashEndSector 	= (flashWritePos + CODEPLUG_CONTACT_DATA_SIZE) / 4096;
-
-	if (flashSector != flashEndSector)
-	{
-		bytesToWriteInCurrentSector = (flashEndSector * 4096) - flashWritePos;
-	}
-
-	SPI_Flash_read(FLASH_ADDRESS_OFFSET + (flashSector * 4096), SPI_Flash_sectorbuffer, 4096);
-	uint8_t *writePos = SPI_Flash_sectorbuffer + flashWritePos - (flashSector * 4096);
-	memcpy(writePos, contact, bytesToWriteInCurrentSector);
-
-	retVal = SPI_Flash_eraseSector(FLASH_ADDRESS_OFFSET + (flashSector * 4096));
+	// Merged into the Flash write cache, consecutive saves in the same sector only cost one erase.
+	retVal = SPI_Flash_write(FLASH_ADDRESS_OFFSET + flashWritePos, (uint8_t *)contact, CODEPLUG_CONTACT_DATA_SIZE);
 	if (!retVal)
 	{
 		goto hasFailed;
 	}
 
-	for (int i = 0; i < 16; i++)
-	{
-		retVal = SPI_Flash_writePage(FLASH_ADDRESS_OFFSET + (flashSector * 4096) + (i * 256), SPI_Flash_sectorbuffer + (i * 256));
-		if (!retVal)
-		{
-			goto hasFailed;
-		}
-	}
-
-	if (flashSector != flashEndSector)
-	{
-		uint8_t *channelBufPusOffset = (uint8_t *)contact + bytesToWriteInCurrentSector;
-		bytesToWriteInCurrentSector = CODEPLUG_CONTACT_DATA_SIZE - bytesToWriteInCurrentSector;
-
-		SPI_Flash_read(FLASH_ADDRESS_OFFSET + (flashEndSector * 4096), SPI_Flash_sectorbuffer, 4096);
-		memcpy(SPI_Flash_sectorbuffer, (uint8_t *)channelBufPusOffset, bytesToWriteInCurrentSector);
-
-		retVal = SPI_Flash_eraseSector(FLASH_ADDRESS_OFFSET + (flashEndSector * 4096));
-
-		if (!retVal)
-		{
-			goto hasFailed;
-		}
-
-		for (int i = 0; i < 16; i++)
-		{
-			retVal = SPI_Flash_writePage(FLASH_ADDRESS_OFFSET + (flashEndSector * 4096) + (i * 256), SPI_Flash_sectorbuffer + (i * 256));
-
-			if (!retVal)
-			{
-				goto hasFailed;
-			}
-		}
-
-	}
 	if ((contact->name[0] == 0xff) || (contact->callType == 0xFF))
 	{
 		codeplugContactsCacheRemoveContactAt(index + 1);// index was decremented at the start of the function
@@ -0,0 +1,402 @@
+/*
+ * Copyright (C) 2019-2024 Roger Clark, VK3KYY / G4KYF
+ *                         Daniel Caujolle-Bert, F1RMB
+ *
+ * Low level DMR stream implementation informed by code written by
+ *                         DSD Author (anonymous)
+ *                         MBELib Author (anonymous)
+ *                         Ian Wraith G7GHH
+ *                         Jonathan Naylor G4KLX
+ *
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "functions/dmrFEC.h"
+
+static uint8_t hammingGetSyndrome(uint16_t codeword);
+static uint16_t hammingEncode15113(uint16_t codeword);
+static uint16_t hammingEncode16114(uint16_t codeword);
+static bool hammingDecode15113(uint16_t *codeword);
+static bool hammingDecode16114(uint16_t *codeword);
+static uint32_t CRC_encodeFiveBit(const bool *in);
+
+// Hamming syndrome of the upper and lower bytes of a codeword
+static const uint8_t HAMMING_SYNDROME_HIGH[256] = {
+		0x00, 0x16, 0x0B, 0x1D, 0x15, 0x03, 0x1E, 0x08, 0x0E, 0x18, 0x05, 0x13, 0x1B, 0x0D, 0x10, 0x06,
+		0x1C, 0x0A, 0x17, 0x01, 0x09, 0x1F, 0x02, 0x14, 0x12, 0x04, 0x19, 0x0F, 0x07, 0x11, 0x0C, 0x1A,
+		0x1F, 0x09, 0x14, 0x02, 0x0A, 0x1C, 0x01, 0x17, 0x11, 0x07, 0x1A, 0x0C, 0x04, 0x12, 0x0F, 0x19,
+		0x03, 0x15, 0x08, 0x1E, 0x16, 0x00, 0x1D, 0x0B, 0x0D, 0x1B, 0x06, 0x10, 0x18, 0x0E, 0x13, 0x05,
+		0x1A, 0x0C, 0x11, 0x07, 0x0F, 0x19, 0x04, 0x12, 0x14, 0x02, 0x1F, 0x09, 0x01, 0x17, 0x0A, 0x1C,
+		0x06, 0x10, 0x0D, 0x1B, 0x13, 0x05, 0x18, 0x0E, 0x08, 0x1E, 0x03, 0x15, 0x1D, 0x0B, 0x16, 0x00,
+		0x05, 0x13, 0x0E, 0x18, 0x10, 0x06, 0x1B, 0x0D, 0x0B, 0x1D, 0x00, 0x16, 0x1E, 0x08, 0x15, 0x03,
+		0x19, 0x0F, 0x12, 0x04, 0x0C, 0x1A, 0x07, 0x11, 0x17, 0x01, 0x1C, 0x0A, 0x02, 0x14, 0x09, 0x1F,
+		0x13, 0x05, 0x18, 0x0E, 0x06, 0x10, 0x0D, 0x1B, 0x1D, 0x0B, 0x16, 0x00, 0x08, 0x1E, 0x03, 0x15,
+		0x0F, 0x19, 0x04, 0x12, 0x1A, 0x0C, 0x11, 0x07, 0x01, 0x17, 0x0A, 0x1C, 0x14, 0x02, 0x1F, 0x09,
+		0x0C, 0x1A, 0x07, 0x11, 0x19, 0x0F, 0x12, 0x04, 0x02, 0x14, 0x09, 0x1F, 0x17, 0x01, 0x1C, 0x0A,
+		0x10, 0x06, 0x1B, 0x0D, 0x05, 0x13, 0x0E, 0x18, 0x1E, 0x08, 0x15, 0x03, 0x0B, 0x1D, 0x00, 0x16,
+		0x09, 0x1F, 0x02, 0x14, 0x1C, 0x0A, 0x17, 0x01, 0x07, 0x11, 0x0C, 0x1A, 0x12, 0x04, 0x19, 0x0F,
+		0x15, 0x03, 0x1E, 0x08, 0x00, 0x16, 0x0B, 0x1D, 0x1B, 0x0D, 0x10, 0x06, 0x0E, 0x18, 0x05, 0x13,
+		0x16, 0x00, 0x1D, 0x0B, 0x03, 0x15, 0x08, 0x1E, 0x18, 0x0E, 0x13, 0x05, 0x0D, 0x1B, 0x06, 0x10,
+		0x0A, 0x1C, 0x01, 0x17, 0x1F, 0x09, 0x14, 0x02, 0x04, 0x12, 0x0F, 0x19, 0x11, 0x07, 0x1A, 0x0C
+};
+
+static const uint8_t HAMMING_SYNDROME_LOW[256] = {
+		0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+		0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F,
+		0x07, 0x06, 0x05, 0x04, 0x03, 0x02, 0x01, 0x00, 0x0F, 0x0E, 0x0D, 0x0C, 0x0B, 0x0A, 0x09, 0x08,
+		0x17, 0x16, 0x15, 0x14, 0x13, 0x12, 0x11, 0x10, 0x1F, 0x1E, 0x1D, 0x1C, 0x1B, 0x1A, 0x19, 0x18,
+		0x0D, 0x0C, 0x0F, 0x0E, 0x09, 0x08, 0x0B, 0x0A, 0x05, 0x04, 0x07, 0x06, 0x01, 0x00, 0x03, 0x02,
+		0x1D, 0x1C, 0x1F, 0x1E, 0x19, 0x18, 0x1B, 0x1A, 0x15, 0x14, 0x17, 0x16, 0x11, 0x10, 0x13, 0x12,
+		0x0A, 0x0B, 0x08, 0x09, 0x0E, 0x0F, 0x0C, 0x0D, 0x02, 0x03, 0x00, 0x01, 0x06, 0x07, 0x04, 0x05,
+		0x1A, 0x1B, 0x18, 0x19, 0x1E, 0x1F, 0x1C, 0x1D, 0x12, 0x13, 0x10, 0x11, 0x16, 0x17, 0x14, 0x15,
+		0x19, 0x18, 0x1B, 0x1A, 0x1D, 0x1C, 0x1F, 0x1E, 0x11, 0x10, 0x13, 0x12, 0x15, 0x14, 0x17, 0x16,
+		0x09, 0x08, 0x0B, 0x0A, 0x0D, 0x0C, 0x0F, 0x0E, 0x01, 0x00, 0x03, 0x02, 0x05, 0x04, 0x07, 0x06,
+		0x1E, 0x1F, 0x1C, 0x1D, 0x1A, 0x1B, 0x18, 0x19, 0x16, 0x17, 0x14, 0x15, 0x12, 0x13, 0x10, 0x11,
+		0x0E, 0x0F, 0x0C, 0x0D, 0x0A, 0x0B, 0x08, 0x09, 0x06, 0x07, 0x04, 0x05, 0x02, 0x03, 0x00, 0x01,
+		0x14, 0x15, 0x16, 0x17, 0x10, 0x11, 0x12, 0x13, 0x1C, 0x1D, 0x1E, 0x1F, 0x18, 0x19, 0x1A, 0x1B,
+		0x04, 0x05, 0x06, 0x07, 0x00, 0x01, 0x02, 0x03, 0x0C, 0x0D, 0x0E, 0x0F, 0x08, 0x09, 0x0A, 0x0B,
+		0x13, 0x12, 0x11, 0x10, 0x17, 0x16, 0x15, 0x14, 0x1B, 0x1A, 0x19, 0x18, 0x1F, 0x1E, 0x1D, 0x1C,
+		0x03, 0x02, 0x01, 0x00, 0x07, 0x06, 0x05, 0x04, 0x0B, 0x0A, 0x09, 0x08, 0x0F, 0x0E, 0x0D, 0x0C
+};
+
+// Syndrome to bit to flip, 0 when not correctable
+static const uint16_t HAMMING_15113_CORRECTION[16] = {
+		0x0000, 0x0002, 0x0004, 0x0020, 0x0008, 0x0200, 0x0040, 0x0800,
+		0x0010, 0x8000, 0x0400, 0x0100, 0x0080, 0x4000, 0x1000, 0x2000
+};
+
+static const uint16_t HAMMING_16114_CORRECTION[32] = {
+		0x0000, 0x0001, 0x0002, 0x0000, 0x0004, 0x0000, 0x0000, 0x0020,
+		0x0008, 0x0000, 0x0000, 0x0200, 0x0000, 0x0040, 0x0800, 0x0000,
+		0x0010, 0x0000, 0x0000, 0x8000, 0x0000, 0x0400, 0x0100, 0x0000,
+		0x0000, 0x0080, 0x4000, 0x0000, 0x1000, 0x0000, 0x0000, 0x2000
+};
+
+// Burst bit of each BPTC(196,96) matrix bit (R(3) excluded), after deinterleaving
+static const uint16_t BPTC19696_MATRIX_TO_BURST_BIT[195] = {
+		249, 234, 219, 204, 189, 174,  91,  76,  61,  46,  31,  16,   1, 250, 235,
+		220, 205, 190, 175,  92,  77,  62,  47,  32,  17,   2, 251, 236, 221, 206,
+		191, 176,  93,  78,  63,  48,  33,  18,   3, 252, 237, 222, 207, 192, 177,
+		 94,  79,  64,  49,  34,  19,   4, 253, 238, 223, 208, 193, 178,  95,  80,
+		 65,  50,  35,  20,   5, 254, 239, 224, 209, 194, 179,  96,  81,  66,  51,
+		 36,  21,   6, 255, 240, 225, 210, 195, 180,  97,  82,  67,  52,  37,  22,
+		  7, 256, 241, 226, 211, 196, 181, 166,  83,  68,  53,  38,  23,   8, 257,
+		242, 227, 212, 197, 182, 167,  84,  69,  54,  39,  24,   9, 258, 243, 228,
+		213, 198, 183, 168,  85,  70,  55,  40,  25,  10, 259, 244, 229, 214, 199,
+		184, 169,  86,  71,  56,  41,  26,  11, 260, 245, 230, 215, 200, 185, 170,
+		 87,  72,  57,  42,  27,  12, 261, 246, 231, 216, 201, 186, 171,  88,  73,
+		 58,  43,  28,  13, 262, 247, 232, 217, 202, 187, 172,  89,  74,  59,  44,
+		 29,  14, 263, 248, 233, 218, 203, 188, 173,  90,  75,  60,  45,  30,  15
+};
+
+void dmrFECBPTCDecode(const uint8_t *inputData, uint8_t *outputData)
+{
+	// 0xFF means don't use this value
+	const uint8_t BITS_LOOKUP[16] = {0xFF, 9, 10, 6, 11, 3, 7, 1, 12, 0xFF, 4, 0xFF, 8, 5, 2, 0};
+	uint16_t rows[13]; // 13 rows of 15 columns, column 0 in bit 15
+	const uint16_t *burstBit = BPTC19696_MATRIX_TO_BURST_BIT;
+	bool stillProcessing;
+	uint32_t bits;
+	int bitsCount;
+	int outputIndex = 1;
+
+	// Deinterleave straight from the burst, R(3) is skipped
+	for (int r = 0; r < 13; r++)
+	{
+		uint16_t row = 0;
+
+		for (int c = 0; c < 15; c++, burstBit++)
+		{
+			row = (row << 1) | ((inputData[*burstBit >> 3] >> (7 - (*burstBit & 7))) & 0x01);
+		}
+
+		rows[r] = row << 1;
+	}
+
+	stillProcessing = true;// Need to initially set this to true to start the for loop
+
+	for (int i = 0; ((i < 5) && stillProcessing); i++)
+	{
+		// Hamming (13,9,3) syndromes of all the columns at once, one bit per column
+		uint16_t s0 = rows[0] ^ rows[1] ^ rows[3] ^ rows[5] ^ rows[6] ^ rows[9];
+		uint16_t s1 = rows[0] ^ rows[1] ^ rows[2] ^ rows[4] ^ rows[6] ^ rows[7] ^ rows[10];
+		uint16_t s2 = rows[0] ^ rows[1] ^ rows[2] ^ rows[3] ^ rows[5] ^ rows[7] ^ rows[8] ^ rows[11];
+		uint16_t s3 = rows[0] ^ rows[2] ^ rows[4] ^ rows[5] ^ rows[8] ^ rows[12];
+		uint16_t columns = (s0 | s1 | s2 | s3) & 0xFFFE;
+
+		stillProcessing = false;
+
+		while (columns != 0)
+		{
+			uint16_t column = columns & -columns;
+			uint8_t bitLocation = BITS_LOOKUP[((s0 & column) ? 0x01 : 0x00) | ((s1 & column) ? 0x02 : 0x00) | ((s2 & column) ? 0x04 : 0x00) | ((s3 & column) ? 0x08 : 0x00)];
+
+			if (bitLocation != 0xFF)
+			{
+				rows[bitLocation] ^= column;
+				stillProcessing = true;
+			}
+
+			columns &= ~column;
+		}
+
+		for (int j = 0; j < 9; j++)
+		{
+			if (hammingDecode15113(&rows[j]))
+			{
+				stillProcessing = true;
+			}
+		}
+	}
+
+	// 8 data bits in the first row (after R(3)), 11 in the next 8 ones
+	outputData[0] = (uint8_t)(rows[0] >> 5);
+	bits = 0;
+	bitsCount = 0;
+
+	for (int r = 1; r < 9; r++)
+	{
+		bits = (bits << 11) | (rows[r] >> 5);
+		bitsCount += 11;
+
+		while (bitsCount >= 8)
+		{
+			bitsCount -= 8;
+			outputData[outputIndex++] = (uint8_t)(bits >> bitsCount);
+		}
+	}
+}
+
+void dmrFECBPTCEncode(const uint8_t *inputData, uint8_t *outputData)
+{
+	uint16_t rows[13]; // 13 rows of 15 columns, column 0 in bit 15
+	const uint16_t *burstBit = BPTC19696_MATRIX_TO_BURST_BIT;
+	uint32_t bits = 0;
+	int bitsCount = 0;
+	int inputIndex = 0;
+
+	// 8 data bits in the first row (after R(3)), 11 in the next 8 ones
+	for (int r = 0; r < 9; r++)
+	{
+		int width = ((r == 0) ? 8 : 11);
+
+		while (bitsCount < width)
+		{
+			bits = (bits << 8) | inputData[inputIndex++];
+			bitsCount += 8;
+		}
+
+		bitsCount -= width;
+		rows[r] = hammingEncode15113((uint16_t)(((bits >> bitsCount) & ((1U << width) - 1)) << 5));
+	}
+
+	// Hamming (13,9,3) of all the columns at once
+	rows[9]  = rows[0] ^ rows[1] ^ rows[3] ^ rows[5] ^ rows[6];
+	rows[10] = rows[0] ^ rows[1] ^ rows[2] ^ rows[4] ^ rows[6] ^ rows[7];
+	rows[11] = rows[0] ^ rows[1] ^ rows[2] ^ rows[3] ^ rows[5] ^ rows[7] ^ rows[8];
+	rows[12] = rows[0] ^ rows[2] ^ rows[4] ^ rows[5] ^ rows[8];
+
+	// Interleave straight into the burst, keeping the slot type and sync bits
+	memset(outputData, 0, 12);
+	outputData[12] &= 0x3F;
+	outputData[20] &= 0xFC;
+	memset(outputData + 21, 0, 12);
+
+	for (int r = 0; r < 13; r++)
+	{
+		for (uint16_t column = 0x8000; column > 0x0001; column >>= 1, burstBit++)
+		{
+			if (rows[r] & column)
+			{
+				outputData[*burstBit >> 3] |= (0x80 >> (*burstBit & 7));
+			}
+		}
+	}
+}
+
+// Codewords are MSB first in a 16 bits word: the 11 data bits are the upper ones, then the check bits.
+// The syndrome bits match the check bits positions (only the upper 4 are used for Hamming (15,11,3))
+static uint8_t hammingGetSyndrome(uint16_t codeword)
+{
+	return (HAMMING_SYNDROME_HIGH[codeword >> 8] ^ HAMMING_SYNDROME_LOW[codeword & 0xFF]);
+}
+
+static uint16_t hammingEncode15113(uint16_t codeword)
+{
+	codeword &= 0xFFE0;
+
+	return (codeword | (hammingGetSyndrome(codeword) & 0x1E));
+}
+
+static uint16_t hammingEncode16114(uint16_t codeword)
+{
+	codeword &= 0xFFE0;
+
+	return (codeword | (hammingGetSyndrome(codeword) & 0x1F));
+}
+
+// Returns true only if a bit has been corrected
+static bool hammingDecode15113(uint16_t *codeword)
+{
+	uint16_t errorMask = HAMMING_15113_CORRECTION[(hammingGetSyndrome(*codeword) >> 1) & 0x0F];
+
+	if (errorMask != 0)
+	{
+		*codeword ^= errorMask;
+		return true;
+	}
+
+	return false;
+}
+
+// Returns true if the codeword is valid, or has been corrected
+static bool hammingDecode16114(uint16_t *codeword)
+{
+	uint8_t syndrome = hammingGetSyndrome(*codeword) & 0x1F;
+
+	if (syndrome == 0)
+	{
+		return true;
+	}
+
+	if (HAMMING_16114_CORRECTION[syndrome] != 0)
+	{
+		*codeword ^= HAMMING_16114_CORRECTION[syndrome];
+		return true;
+	}
+
+	return false;
+}
+
+void dmrFECEmbeddedDataEncode(const bool *lcBits, bool *rawBits)
+{
+	uint16_t rows[8]; // 8 rows of 16 columns, column 0 in bit 15
+	uint32_t crc = CRC_encodeFiveBit(lcBits);
+	uint32_t bitIndex = 0;
+
+	// 11 data bits in the first 2 rows, then 10 data bits and one CRC bit
+	for (int r = 0; r < 7; r++)
+	{
+		int width = ((r < 2) ? 11 : 10);
+		uint16_t row = 0;
+
+		for (int i = 0; i < width; i++)
+		{
+			row = (row << 1) | lcBits[bitIndex++];
+		}
+
+		row <<= (16 - width);
+
+		if (r >= 2)
+		{
+			row |= ((crc >> (6 - r)) & 0x01) << 5;
+		}
+
+		rows[r] = hammingEncode16114(row);
+	}
+
+	rows[7] = rows[0] ^ rows[1] ^ rows[2] ^ rows[3] ^ rows[4] ^ rows[5] ^ rows[6];
+
+	bitIndex = 0;
+	for (int i = 0; i < 128; i++)
+	{
+		rawBits[i] = (rows[bitIndex >> 4] >> (15 - (bitIndex & 15))) & 0x01;
+		bitIndex += 16;
+		if (bitIndex > 127)
+		{
+			bitIndex -= 127;
+		}
+	}
+}
+
+bool dmrFECEmbeddedDataDecode(const bool *rawBits, bool *lcBits)
+{
+	uint32_t crc = 0;
+	uint16_t rows[8] = { 0 }; // 8 rows of 16 columns, column 0 in bit 15
+	uint32_t bitIndex = 0;
+
+	for (int i = 0; i < 128; i++)
+	{
+		if (rawBits[i])
+		{
+			rows[bitIndex >> 4] |= (0x8000 >> (bitIndex & 15));
+		}
+		bitIndex += 16;
+		if (bitIndex > 127)
+		{
+			bitIndex -= 127;
+		}
+	}
+
+	for (int r = 0; r < 7; r++)
+	{
+		if (!hammingDecode16114(&rows[r]))
+		{
+			return false;
+		}
+	}
+
+	// Check parity
+	if ((rows[0] ^ rows[1] ^ rows[2] ^ rows[3] ^ rows[4] ^ rows[5] ^ rows[6] ^ rows[7]) != 0)
+	{
+		return false;
+	}
+
+	bitIndex = 0;
+
+	for (int r = 0; r < 7; r++)
+	{
+		int width = ((r < 2) ? 11 : 10);
+
+		for (int i = 0; i < width; i++)
+		{
+			lcBits[bitIndex++] = (rows[r] >> (15 - i)) & 0x01;
+		}
+
+		if (r >= 2)
+		{
+			crc = (crc << 1) | ((rows[r] >> 5) & 0x01);
+		}
+	}
+
+	return (crc == CRC_encodeFiveBit(lcBits));
+}
+
+static uint32_t CRC_encodeFiveBit(const bool *in)
+{
+	uint32_t total = 0;
+
+	for (int i = 0; i < 72; i += 8)
+	{
+		total += BooleanBitsArrayToByte(in + i);
+	}
+
+	total %= 31;
+
+	return total;
+}
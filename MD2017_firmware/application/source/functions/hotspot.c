@@ -40,6 +40,7 @@
 #include <ctype.h>
 
 #include "functions/calibration.h"
+#include "functions/dmrFEC.h"
 #include "functions/hotspot.h"
 #include "user_interface/menuSystem.h"
 #include "user_interface/uiUtilities.h"
@@ -64,19 +65,7 @@
 
 static void ReedSolomonDMREncode(const uint8_t *inputData, uint8_t *outputData);
 static uint8_t LUT_Mult(uint8_t a, uint8_t b);
-static void BPTCglobalsInit(void);
-static void BPTCdecode(const uint8_t *inputData, uint8_t *outputData);
-static void BPTCencode(const uint8_t *inputData, uint8_t *outputData);
 static void DMRLC2Bytes(const DMRLC_t *LC_DataInput, uint8_t *outputBytes);
-static uint8_t hammingGetBits(bool *inputOutputBooleanBitsArray, bool is16114);
-static void hammingEncode(bool *inputOutputBooleanBitsArray,bool is16114);
-static bool hammingDecodeType1(bool *inputOutputBooleanBitsArray);
-static bool hammingDecodeType2(bool *inputOutputBooleanBitsArray);
-static void embeddedDataDecodeEmbeddedData(void);
-static void embeddedDataEncodeEmbeddedData(void);
-static uint32_t CRC_encodeFiveBit(const bool *in);
-static void byteToBooleanBitsArray(uint8_t byteIn, bool *bitsOut);
-static uint8_t BooleanBitsArrayToByte(const bool *bitsIn);
 static uint8_t setFreq(const uint8_t *data, uint8_t length);
 static void sendNAK(uint8_t cmd, uint8_t err);
 static void sendACK(uint8_t cmd);
@@ -178,21 +167,19 @@ static const struct
 static const uint8_t VOICE_LC_HEADER_CRC_MASK[]    = {0x96, 0x96, 0x96};
 static const uint8_t TERMINATOR_WITH_LC_CRC_MASK[] = {0x99, 0x99, 0x99};
 
-static const int BPTC19696CopyRanges[][2] = {{4,11},{16,26},{31,41},{46,56},{61,71},{76,86},{91,101},{106,116},{121,131}};
-static const int embedddataCopyRanges[][2] = {{0,10},{16,26},{32,41},{48,57},{64,73},{80,89},{96,105}};
-
 static uint8_t hotspotTxLC[9];
 static bool startedEmbeddedSearch = false;
 
-// USB TX read/write positions and count
-static volatile uint16_t usbComSendBufWritePosition = 0;
-static volatile uint16_t usbComSendBufReadPosition = 0;
-static volatile uint16_t usbComSendBufCount = 0;
+// USB TX queue, in bytes, stored in usbComSendBuf
+#define USB_TX_QUEUE_SIZE              COM_BUFFER_SIZE // Needs to be a power of two
+#define USB_TX_QUEUE_WRAP_MARKER       0xFF
+static ringBuffer_t usbTxQueueRing = RING_BUFFER_INITIALISER(USB_TX_QUEUE_SIZE);
+static volatile uint32_t usbTxInFlightLength = 0; // queue bytes used by the USB transfer in progress
 
-// RF data read/write positions and count
-static volatile uint32_t rfFrameBufReadIdx = 0;
-static volatile uint32_t rfFrameBufWriteIdx = 0;
-static volatile uint32_t rfFrameBufCount = 0;
+// RF frames (filled by the HR-C6000 ISR) and network frames (emptied by the HR-C6000 ISR).
+// As the hotspot is half duplex, both are sharing the hotspotBuffer storage.
+static ringBuffer_t rfFrameRing = RING_BUFFER_INITIALISER(HOTSPOT_BUFFER_COUNT);
+static ringBuffer_t hotspotTxFrameRing = RING_BUFFER_INITIALISER(HOTSPOT_BUFFER_COUNT);
 
 static uint8_t lastRxState = HOTSPOT_RX_IDLE;
 static const int TX_BUFFERING_TIMEOUT = 360;
@@ -227,15 +214,6 @@ static bool	embeddedDataProcessed[72];
 static int	embeddedDataFLCO;
 static bool	embeddedDataIsValid;
 
-#if defined(PLATFORM_GD77) || defined(PLATFORM_GD77S) || defined(PLATFORM_DM1801) || defined(PLATFORM_DM1801A) || defined(PLATFORM_RD5R)
-#define BPTRAMLOCATION ".data.$RAM2"
-#else
-#define BPTRAMLOCATION ".ccmram"
-#endif
-
-__attribute__((section(BPTRAMLOCATION))) static bool BPTCRaw[196];
-__attribute__((section(BPTRAMLOCATION))) static bool BPTCDeInterleaved[196];
-
 static const uint32_t cwDOTDuration = 60; // 60ms per DOT
 static ticksTimer_t cwNextPeriodTimer = { 0, 0 };
 static uint8_t cwBuffer[64];
@@ -263,8 +241,7 @@ static bool voiceLCHeaderDecode(const uint8_t *data, uint8_t type, DMRLC_t *lc)
 {
 	uint8_t parityCheckArray[4];
 
-	BPTCglobalsInit();
-	BPTCdecode(data, lc->rawData);
+	dmrFECBPTCDecode(data, lc->rawData);
 
 	lc->rawData[9]  ^= VOICE_LC_HEADER_CRC_MASK[0];
 	lc->rawData[10] ^= VOICE_LC_HEADER_CRC_MASK[1];
@@ -311,8 +288,7 @@ bool DMRFullLC_encode(DMRLC_t *lc, uint8_t *data, uint8_t type)
 		lcData[11] = parity[0] ^ TERMINATOR_WITH_LC_CRC_MASK[2];
 	}
 
-	BPTCglobalsInit();
-	BPTCencode(lcData, data);
+	dmrFECBPTCEncode(lcData, data);
 
 	return true;
 }
@@ -356,10 +332,11 @@ static bool embeddedDataAddData(const uint8_t *data, uint8_t lcss)
 
 				embeddedDataSequenceState = LCS_0;
 
-				embeddedDataDecodeEmbeddedData();
-				if (embeddedDataIsValid)
+				if (dmrFECEmbeddedDataDecode(embeddedDataRaw, embeddedDataProcessed))
 				{
-					embeddedDataEncodeEmbeddedData();
+					embeddedDataIsValid = true;
+					embeddedDataFLCO = (int)(BooleanBitsArrayToByte(embeddedDataProcessed + 0) & 0x3F);
+					dmrFECEmbeddedDataEncode(embeddedDataProcessed, embeddedDataRaw);
 				}
 				return embeddedDataIsValid;
 			}
@@ -459,7 +436,7 @@ static void embeddedDataSetLC(const DMRLC_t *lc)
 
 	embeddedDataFLCO  = lc->FLCO;
 	embeddedDataIsValid = true;
-	embeddedDataEncodeEmbeddedData();
+	dmrFECEmbeddedDataEncode(embeddedDataProcessed, embeddedDataRaw);
 }
 
 static uint8_t LUT_Mult(uint8_t a, uint8_t b)
@@ -542,178 +519,6 @@ static void ReedSolomonDMREncode(const uint8_t *inputData, uint8_t *outputData)
 	}
 }
 
-static void BPTCglobalsInit(void)
-{
-	memset(BPTCRaw, 0, sizeof(BPTCRaw));
-	memset(BPTCDeInterleaved, 0, sizeof(BPTCDeInterleaved));
-}
-
-static void BPTCdecode(const uint8_t *inputData, uint8_t *outputData)
-{
-	// 0xFF means don't use this value
-	const uint8_t BITS_LOOKUP[16] = {0xFF, 9, 10, 6, 11, 3, 7, 1, 12, 0xFF, 4, 0xFF, 8, 5, 2, 0};
-	bool bitData[96];
-	bool tmpArray[13];
-	uint32_t bitDataIndex = 0;
-	bool stillProcessing;
-	uint8_t n;
-
-	for (int i = 0; i < 13; i++)
-	{
-		byteToBooleanBitsArray(inputData[i], BPTCRaw + (i << 3));
-	}
-
-	byteToBooleanBitsArray(inputData[20], tmpArray);
-	BPTCRaw[98] = tmpArray[6];
-	BPTCRaw[99] = tmpArray[7];
-
-	for (int i = 0; i < 13; i++)
-	{
-		byteToBooleanBitsArray(inputData[i + 21], BPTCRaw + (100 + (i << 3)));
-	}
-
-	for (int i = 0; i < 196; i++)
-	{
-		BPTCDeInterleaved[i] = BPTCRaw[(i * 181) % 196];// interleave
-	}
-
-	stillProcessing = true;// Need to initially set this to true to start the for loop
-
-	for (int i = 0; ((i < 5) && stillProcessing); i++)
-	{
-		stillProcessing = false;
-
-		for (int j = 0; j < 15; j++)
-		{
-			int pos = j + 1;
-			for (int k = 0; k < 13; k++)
-			{
-				tmpArray[k] = BPTCDeInterleaved[pos];
-				pos += 15;
-			}
-
-			bool hammingOK = false;
-
-			n  = ((tmpArray[0] ^ tmpArray[1] ^ tmpArray[3] ^ tmpArray[5] ^ tmpArray[6]) != tmpArray[9])  ? 0x01 : 0x00;
-			n |= ((tmpArray[0] ^ tmpArray[1] ^ tmpArray[2] ^ tmpArray[4] ^ tmpArray[6] ^ tmpArray[7]) != tmpArray[10]) ? 0x02 : 0x00;
-			n |= ((tmpArray[0] ^ tmpArray[1] ^ tmpArray[2] ^ tmpArray[3] ^ tmpArray[5] ^ tmpArray[7] ^ tmpArray[8]) != tmpArray[11]) ? 0x04 : 0x00;
-			n |= ((tmpArray[0] ^ tmpArray[2] ^ tmpArray[4] ^ tmpArray[5] ^ tmpArray[8]) != tmpArray[12]) ? 0x08 : 0x00;
-
-			if (n < 16)
-			{
-				uint8_t bitLocation = BITS_LOOKUP[n];
-				if (bitLocation != 0xFF)
-				{
-					tmpArray[bitLocation] = !tmpArray[bitLocation];
-					hammingOK = true;
-				}
-			}
-
-			if (hammingOK)
-			{
-				pos = j + 1;
-				for (int k = 0; k < 13; k++)
-				{
-					BPTCDeInterleaved[pos] = tmpArray[k];
-					pos += 15;
-				}
-				stillProcessing = true;
-			}
-		}
-
-		for (int j = 0; j < 9; j++)
-		{
-			uint32_t pos = (j * 15) + 1;
-			if (hammingDecodeType2(BPTCDeInterleaved + pos))
-			{
-				stillProcessing = true;
-			}
-		}
-	}
-
-	for (int range = 0; range < 9; range++)
-	{
-		for (uint32_t a = BPTC19696CopyRanges[range][0]; a <= BPTC19696CopyRanges[range][1]; a++, bitDataIndex++)
-		{
-			bitData[bitDataIndex] = BPTCDeInterleaved[a];
-		}
-	}
-
-	for (int i = 0; i < LC_DATA_LENGTH; i++)
-	{
-		outputData[i] = BooleanBitsArrayToByte(bitData + (i << 3));
-	}
-}
-
-static void BPTCencode(const uint8_t *inputData, uint8_t *outputData)
-{
-	uint8_t byteData;
-	uint32_t bitDataPosition = 0;
-	bool bitData[96];
-	bool hammingBits[13];
-
-	for (int i = 0; i < LC_DATA_LENGTH; i++)
-	{
-		byteToBooleanBitsArray(inputData[i], bitData + (i << 3));
-	}
-
-	memset(BPTCDeInterleaved, 0, 196 * sizeof(bool));
-
-	for (int range = 0; range < 9; range++)
-	{
-		for (uint32_t a = BPTC19696CopyRanges[range][0]; a <= BPTC19696CopyRanges[range][1]; a++, bitDataPosition++)
-		{
-			BPTCDeInterleaved[a] = bitData[bitDataPosition];
-		}
-	}
-
-	for (int i = 0; i < 9; i++)
-	{
-		hammingEncode(BPTCDeInterleaved + ((i * 15) + 1), false);
-	}
-
-	for (int i = 0; i < 15; i++)
-	{
-		int pos = i + 1;
-		for (int j = 0; j < 13; j++)
-		{
-			hammingBits[j] = BPTCDeInterleaved[pos];
-			pos += 15;
-		}
-
-		hammingBits[9]  = hammingBits[0] ^ hammingBits[1] ^ hammingBits[3] ^ hammingBits[5] ^ hammingBits[6];
-		hammingBits[10] = hammingBits[0] ^ hammingBits[1] ^ hammingBits[2] ^ hammingBits[4] ^ hammingBits[6] ^ hammingBits[7];
-		hammingBits[11] = hammingBits[0] ^ hammingBits[1] ^ hammingBits[2] ^ hammingBits[3] ^ hammingBits[5] ^ hammingBits[7] ^ hammingBits[8];
-		hammingBits[12] = hammingBits[0] ^ hammingBits[2] ^ hammingBits[4] ^ hammingBits[5] ^ hammingBits[8];
-
-		pos = i + 1;
-		for (int j = 0; j < 13; j++)
-		{
-			BPTCDeInterleaved[pos] = hammingBits[j];
-			pos += 15;
-		}
-	}
-
-	for (int i = 0; i < 196; i++)
-	{
-		BPTCRaw[(i * 181) % 196] = BPTCDeInterleaved[i];// interleave
-	}
-
-	for (int i = 0; i < LC_DATA_LENGTH; i++)
-	{
-		outputData[i] = BooleanBitsArrayToByte(BPTCRaw + (i << 3));
-	}
-
-	byteData = BooleanBitsArrayToByte(BPTCRaw + 96);
-	outputData[12] = (outputData[12] & 0x3F) | ((byteData >> 0) & 0xC0);
-	outputData[20] = (outputData[20] & 0xFC) | ((byteData >> 4) & 0x03);
-
-	for (int i = 0; i < 12; i++)
-	{
-		outputData[i + 21] = BooleanBitsArrayToByte(BPTCRaw + 100 + (i << 3));
-	}
-}
-
 static void DMRLC2Bytes(const DMRLC_t *LC_DataInput, uint8_t *outputBytes)
 {
 	outputBytes[0] = (uint8_t)LC_DataInput->FLCO;
@@ -740,237 +545,6 @@ static void DMRLC2Bytes(const DMRLC_t *LC_DataInput, uint8_t *outputBytes)
 	outputBytes[8] = (LC_DataInput->srcId  & 0xFF);
 }
 
-static bool hammingDecodeType2(bool *inputOutputBooleanBitsArray)
-{
-	const uint8_t BITS_LOOKUP[16] = {0xFF, 11, 12, 8, 13, 5, 9, 3, 14, 0, 6, 1, 10, 7, 4, 2};
-	uint8_t numBits = hammingGetBits(inputOutputBooleanBitsArray, false);
-
-	if (numBits < 16)
-	{
-		uint8_t bitLocation = BITS_LOOKUP[numBits];
-		if (bitLocation != 0xFF)
-		{
-			inputOutputBooleanBitsArray[bitLocation] = !inputOutputBooleanBitsArray[bitLocation];
-			return true;
-		}
-	}
-
-	return false;
-}
-
-static bool hammingDecodeType1(bool *inputOutputBooleanBitsArray)
-{
-	// 0xFF means don't use this value. Also Index 0 is never used, its only here to reduce the number of if's
-	const uint8_t BITS_LOOKUP[32] = { 0xFF, 11, 12, 0xFF, 13, 0xFF, 0xFF, 3, 14, 0xFF, 0xFF, 1, 0xFF, 7, 4, 0xFF, 15, 0xFF, 0xFF, 8, 0xFF, 5, 9, 0xFF, 0xFF, 0, 6, 0xFF, 10, 0xFF ,0xFF, 2};
-
-	uint8_t c = hammingGetBits(inputOutputBooleanBitsArray, true);
-	if (c == 0)
-	{
-		return true;
-	}
-
-	if (c < 32)
-	{
-		uint8_t bitLocation = BITS_LOOKUP[c];
-		if (bitLocation != 0xFF)
-		{
-			inputOutputBooleanBitsArray[bitLocation] = !inputOutputBooleanBitsArray[bitLocation];
-			return true;
-		}
-	}
-
-	return false;
-}
-
-static void hammingEncode(bool *inputOutputBooleanBitsArray,bool is16114)
-{
-	inputOutputBooleanBitsArray[11] = inputOutputBooleanBitsArray[0] ^ inputOutputBooleanBitsArray[1] ^ inputOutputBooleanBitsArray[2] ^ inputOutputBooleanBitsArray[3] ^ inputOutputBooleanBitsArray[5] ^ inputOutputBooleanBitsArray[7] ^ inputOutputBooleanBitsArray[8];
-	inputOutputBooleanBitsArray[12] = inputOutputBooleanBitsArray[1] ^ inputOutputBooleanBitsArray[2] ^ inputOutputBooleanBitsArray[3] ^ inputOutputBooleanBitsArray[4] ^ inputOutputBooleanBitsArray[6] ^ inputOutputBooleanBitsArray[8] ^ inputOutputBooleanBitsArray[9];
-	inputOutputBooleanBitsArray[13] = inputOutputBooleanBitsArray[2] ^ inputOutputBooleanBitsArray[3] ^ inputOutputBooleanBitsArray[4] ^ inputOutputBooleanBitsArray[5] ^ inputOutputBooleanBitsArray[7] ^ inputOutputBooleanBitsArray[9] ^ inputOutputBooleanBitsArray[10];
-	inputOutputBooleanBitsArray[14] = inputOutputBooleanBitsArray[0] ^ inputOutputBooleanBitsArray[1] ^ inputOutputBooleanBitsArray[2] ^ inputOutputBooleanBitsArray[4] ^ inputOutputBooleanBitsArray[6] ^ inputOutputBooleanBitsArray[7] ^ inputOutputBooleanBitsArray[10];
-
-	if (is16114)
-	{
-		inputOutputBooleanBitsArray[15] = inputOutputBooleanBitsArray[0] ^ inputOutputBooleanBitsArray[2] ^ inputOutputBooleanBitsArray[5] ^ inputOutputBooleanBitsArray[6] ^ inputOutputBooleanBitsArray[8] ^ inputOutputBooleanBitsArray[9] ^ inputOutputBooleanBitsArray[10];
-	}
-}
-
-static uint8_t hammingGetBits(bool *inputOutputBooleanBitsArray, bool is16114)
-{
-	uint8_t n;
-
-	n  = ((inputOutputBooleanBitsArray[0] ^ inputOutputBooleanBitsArray[1] ^ inputOutputBooleanBitsArray[2] ^ inputOutputBooleanBitsArray[3] ^ inputOutputBooleanBitsArray[5] ^ inputOutputBooleanBitsArray[7] ^ inputOutputBooleanBitsArray[8]) != inputOutputBooleanBitsArray[11]) ? 0x01 : 0x00;
-	n |= ((inputOutputBooleanBitsArray[1] ^ inputOutputBooleanBitsArray[2] ^ inputOutputBooleanBitsArray[3] ^ inputOutputBooleanBitsArray[4] ^ inputOutputBooleanBitsArray[6] ^ inputOutputBooleanBitsArray[8] ^ inputOutputBooleanBitsArray[9]) != inputOutputBooleanBitsArray[12]) ? 0x02 : 0x00;
-	n |= ((inputOutputBooleanBitsArray[2] ^ inputOutputBooleanBitsArray[3] ^ inputOutputBooleanBitsArray[4] ^ inputOutputBooleanBitsArray[5] ^ inputOutputBooleanBitsArray[7] ^ inputOutputBooleanBitsArray[9] ^ inputOutputBooleanBitsArray[10]) != inputOutputBooleanBitsArray[13]) ? 0x04 : 0x00;
-	n |= ((inputOutputBooleanBitsArray[0] ^ inputOutputBooleanBitsArray[1] ^ inputOutputBooleanBitsArray[2] ^ inputOutputBooleanBitsArray[4] ^ inputOutputBooleanBitsArray[6] ^ inputOutputBooleanBitsArray[7] ^ inputOutputBooleanBitsArray[10]) != inputOutputBooleanBitsArray[14]) ? 0x08 : 0x00;
-
-	if (is16114)
-	{
-		n |= ((inputOutputBooleanBitsArray[0] ^ inputOutputBooleanBitsArray[2] ^ inputOutputBooleanBitsArray[5] ^ inputOutputBooleanBitsArray[6] ^ inputOutputBooleanBitsArray[8] ^ inputOutputBooleanBitsArray[9] ^ inputOutputBooleanBitsArray[10]) != inputOutputBooleanBitsArray[15]) ? 0x10 : 0x00;
-	}
-
-	return n;
-}
-
-static void embeddedDataEncodeEmbeddedData(void)
-{
-	bool data[128];
-	uint32_t arrayIndex = 0;
-
-	uint32_t crc = CRC_encodeFiveBit(embeddedDataProcessed);
-
-	memset(data, 0, 128 * sizeof(bool));
-
-	data[106] = (crc & 0x01) == 0x01;
-	data[90]  = (crc & 0x02) == 0x02;
-	data[74]  = (crc & 0x04) == 0x04;
-	data[58]  = (crc & 0x08) == 0x08;
-	data[42]  = (crc & 0x10) == 0x10;
-
-	for (int range = 0; range < 7; range++)
-	{
-		for (uint32_t i = embedddataCopyRanges[range][0]; i <= embedddataCopyRanges[range][1]; i++, arrayIndex++)
-		{
-			data[i] = embeddedDataProcessed[arrayIndex];
-		}
-	}
-
-	for (int i = 0; i < 112; i += 16)
-	{
-		hammingEncode(data + i, true);
-	}
-
-	for (int i = 0; i < 16; i++)
-	{
-		data[i + 112] = data[i + 0] ^ data[i + 16] ^ data[i + 32] ^ data[i + 48] ^ data[i + 64] ^ data[i + 80] ^ data[i + 96];
-	}
-
-	arrayIndex = 0;
-	for (int i = 0; i < 128; i++)
-	{
-		embeddedDataRaw[i] = data[arrayIndex];
-		arrayIndex += 16;
-		if (arrayIndex > 127)
-		{
-			arrayIndex -= 127;
-		}
-	}
-}
-
-static void embeddedDataDecodeEmbeddedData(void)
-{
-	uint32_t crc = 0;
-	bool tmpBooleanBitsArray[128];
-	int bitArrayIndex = 0;
-
-	memset(tmpBooleanBitsArray, 0, 128 * sizeof(bool));
-
-	for (int i = 0; i < 128; i++)
-	{
-		tmpBooleanBitsArray[bitArrayIndex] = embeddedDataRaw[i];
-		bitArrayIndex += 16;
-		if (bitArrayIndex > 127)
-		{
-			bitArrayIndex -= 127;
-		}
-	}
-
-	for (int i = 0; i < 112; i += 16)
-	{
-		if (!hammingDecodeType1(tmpBooleanBitsArray + i))
-		{
-			return;
-		}
-	}
-
-	// Check parity
-	for (int i = 0; i < 16; i++)
-	{
-		bool parity = tmpBooleanBitsArray[i + 0] ^ tmpBooleanBitsArray[i + 16] ^ tmpBooleanBitsArray[i + 32] ^ tmpBooleanBitsArray[i + 48] ^ tmpBooleanBitsArray[i + 64] ^ tmpBooleanBitsArray[i + 80] ^ tmpBooleanBitsArray[i + 96] ^ tmpBooleanBitsArray[i + 112];
-		if (parity)
-		{
-			return;
-		}
-	}
-
-	bitArrayIndex = 0;
-
-	for (int range = 0; range < 7; range++)
-	{
-		for (uint32_t i = embedddataCopyRanges[range][0]; i <= embedddataCopyRanges[range][1]; i++, bitArrayIndex++)
-		{
-			embeddedDataProcessed[bitArrayIndex] = tmpBooleanBitsArray[i];
-		}
-	}
-
-	if (tmpBooleanBitsArray[42])
-	{
-		crc += 16;
-	}
-
-	if (tmpBooleanBitsArray[58])
-	{
-		crc += 8;
-	}
-
-	if (tmpBooleanBitsArray[74])
-	{
-		crc += 4;
-	}
-
-	if (tmpBooleanBitsArray[90])
-	{
-		crc += 2;
-	}
-
-	if (tmpBooleanBitsArray[106])
-	{
-		crc += 1;
-	}
-
-	if (crc != CRC_encodeFiveBit(embeddedDataProcessed))
-	{
-		return;
-	}
-
-	embeddedDataIsValid = true;
-
-	uint8_t flco = BooleanBitsArrayToByte(embeddedDataProcessed + 0);
-	embeddedDataFLCO = (int)(flco & 0x3F);
-}
-
-static uint32_t CRC_encodeFiveBit(const bool *in)
-{
-	uint32_t total = 0;
-
-	for (int i = 0; i < 72; i += 8)
-	{
-		total += BooleanBitsArrayToByte(in + i);
-	}
-
-	total %= 31;
-
-	return total;
-}
-
-static void byteToBooleanBitsArray(uint8_t byteIn, bool *bitsOut)
-{
-	for (int i = 0, shift = 7; i < 8; i++, shift--)
-	{
-		bitsOut[i] = (byteIn >> shift) & 0x01;
-	}
-}
-
-static uint8_t BooleanBitsArrayToByte(const bool *bitsIn)
-{
-	uint8_t out = 0;
-	for (int i = 0, shift = 7; i < 8; i++, shift--)
-	{
-		out  |= bitsIn[i] << shift;
-	}
-	return out;
-}
-
 void cwProcess(void)
 {
 	if (hotspotCwpoLen == 0)
@@ -1094,7 +668,7 @@ static void getStatus(void)
 	buf[6]  = 0; // No DSTAR space
 
 	buf[7]  = 10; // DMR Simplex
-	buf[8]  = (HOTSPOT_BUFFER_COUNT - wavbuffer_count); // DMR space
+	buf[8]  = ringBufferFree(&hotspotTxFrameRing); // DMR space
 
 	buf[9]  = 0; // No YSF space
 	buf[10] = 0; // No P25 space
@@ -1730,72 +1304,107 @@ void handleHotspotRequest(void)
 }
 
 
-// Queue system is a single byte header containing the length of the item, followed by the data
-// if the block won't fit in the space between the current write location and the end of the buffer,
-// a zero is written to the length for that block and the data and its length byte is put at the beginning of the buffer
+// The queue contains the MMDVM frames back to back, their length being in their second byte.
+// As the USB transfers are made straight from the queue, the data needs to be contiguous: if the frame won't fit in the space
+// between the current write location and the end of the queue, a wrap marker is written instead (frames always start with
+// MMDVM_FRAME_START), and the frame is put at the beginning of the queue. The marker and the frame are committed together.
+// If there is not enough room, the frame is dropped (and counted), never overwriting unsent data.
 void enqueueUSBData(uint8_t *data, uint8_t length)
 {
-	if ((usbComSendBufWritePosition + (length + 1)) > (COM_BUFFER_SIZE - 1))
+	uint32_t position = ringBufferWriteSlot(&usbTxQueueRing);
+	uint32_t padding = 0;
+
+	if (length < 3) // the shortest MMDVM frame length (3 = DMRLost)
+	{
+		return;
+	}
+
+	if ((position + length) > USB_TX_QUEUE_SIZE)
 	{
-		usbComSendBuf[usbComSendBufWritePosition] = 0xFF; // flag that the data block won't fit and will be put at the start of the buffer
-		usbComSendBufWritePosition = 0;
+		padding = (USB_TX_QUEUE_SIZE - position);
 	}
 
-	usbComSendBuf[usbComSendBufWritePosition] = length;
-	memcpy((uint8_t *)&usbComSendBuf[usbComSendBufWritePosition + 1], data, length);
-	usbComSendBufWritePosition += (length + 1);
-	usbComSendBufCount++;
+	if (ringBufferReserve(&usbTxQueueRing, (padding + length)) == false)
+	{
+		return;
+	}
 
-	if (length <= 1)
+	if (padding > 0)
 	{
-		// Blah
+		usbComSendBuf[position] = USB_TX_QUEUE_WRAP_MARKER; // flag that the frame won't fit and will be put at the start of the queue
+		position = 0;
 	}
 
+	memcpy((uint8_t *)&usbComSendBuf[position], data, length);
+	ringBufferCommitWrite(&usbTxQueueRing, (padding + length));
 }
 
-void processUSBDataQueue(void)
+// Sends all the contiguous pending frames (up to a USB packet, or the first frame if it's longer) in a single transfer.
+// It has to be called from the USB interrupt, or with it masked.
+static void usbTxStartTransfer(void)
 {
-	if (usbComSendBufCount > 0)
+	uint32_t count = ringBufferCount(&usbTxQueueRing);
+
+	if ((usbTxInFlightLength > 0) || (count == 0))
 	{
-		if (usbComSendBuf[usbComSendBufReadPosition] == 0xFF) // End marker
+		return;
+	}
+
+	uint32_t position = ringBufferReadSlot(&usbTxQueueRing);
+	uint32_t padding = 0;
+	uint32_t transferLength = 0;
+
+	if (usbComSendBuf[position] == USB_TX_QUEUE_WRAP_MARKER)
+	{
+		padding = (USB_TX_QUEUE_SIZE - position);
+		position = 0;
+	}
+
+	while ((padding + transferLength) < count)
+	{
+		uint32_t framePosition = (position + transferLength);
+
+		// The next frame is at the start of the queue, it will be part of the next transfer
+		if ((framePosition >= USB_TX_QUEUE_SIZE) || (usbComSendBuf[framePosition] == USB_TX_QUEUE_WRAP_MARKER))
 		{
-			usbComSendBuf[usbComSendBufReadPosition] = 0;
-			usbComSendBufReadPosition = 0;
+			break;
 		}
 
-		uint8_t len = usbComSendBuf[usbComSendBufReadPosition] + 1;
+		uint32_t frameLength = usbComSendBuf[framePosition + 1];
 
-		if (len < (3 + 1)) // the shortest MMDVM frame length (3 = DMRLost)
+		if ((transferLength > 0) && ((transferLength + frameLength) > CDC_DATA_FS_MAX_PACKET_SIZE))
 		{
-			usbComSendBufCount--;
+			break;
 		}
-		else
-		{
-#if defined(STM32F405xx)
-			uint8_t status = CDC_Transmit_FS((uint8_t *)&usbComSendBuf[usbComSendBufReadPosition + 1], usbComSendBuf[usbComSendBufReadPosition]);
-
-			if (status == USBD_OK)
-#else
-			usb_status_t status = USB_DeviceCdcAcmSend(s_cdcVcom.cdcAcmHandle, USB_CDC_VCOM_BULK_IN_ENDPOINT, &usbComSendBuf[usbComSendBufReadPosition + 1], usbComSendBuf[usbComSendBufReadPosition]);
 
-			if (status == kStatus_USB_Success)
-#endif
-			{
-				usbComSendBufReadPosition += len;
+		transferLength += frameLength;
+	}
 
-				if (usbComSendBufReadPosition >= (COM_BUFFER_SIZE - 1)) // reaching the end of the buffer
-				{
-					usbComSendBufReadPosition = 0;
-				}
+	// The data stays in the queue until the transfer is completed
+	if (CDC_TransmitDirect_FS((uint8_t *)&usbComSendBuf[position], transferLength) == USBD_OK)
+	{
+		usbTxInFlightLength = (padding + transferLength);
+	}
+}
 
-				usbComSendBufCount--;
-			}
-			else
-			{
-				// USB Send Fail
-			}
-		}
+// Called by the USB interrupt (CDC_TransmitCplt_FS()), chaining the next transfer.
+void hotspotUSBTransmitComplete(void)
+{
+	if (usbTxInFlightLength > 0)
+	{
+		ringBufferCommitRead(&usbTxQueueRing, usbTxInFlightLength);
+		usbTxInFlightLength = 0;
 	}
+
+	usbTxStartTransfer();
+}
+
+// Only starts a transfer if the USB queue was idle, as they are chained from the USB interrupt
+void processUSBDataQueue(void)
+{
+	taskENTER_CRITICAL();
+	usbTxStartTransfer();
+	taskEXIT_CRITICAL();
 }
 
 static void swapWithFakeTA(uint8_t *lc)
@@ -1929,9 +1538,30 @@ static void sendTerminator_LC_Frame(volatile const uint8_t *receivedDMRDataAndAu
 
 void hotspotRxFrameHandler(uint8_t* frameBuf) // It's called by and ISR in HRC-6000 code.
 {
-	memcpy((uint8_t *)&audioAndHotspotDataBuffer.hotspotBuffer[rfFrameBufWriteIdx], frameBuf, AMBE_AUDIO_LENGTH + LC_DATA_LENGTH + 2);// 27 audio + 0x0c header + 2 hotspot signalling bytes
-	rfFrameBufCount++;
-	rfFrameBufWriteIdx = ((rfFrameBufWriteIdx + 1) % HOTSPOT_BUFFER_COUNT);
+	// Drop the frame if the state machine is too late, rather than overwriting the oldest one
+	if (ringBufferReserve(&rfFrameRing, 1))
+	{
+		memcpy((uint8_t *)&audioAndHotspotDataBuffer.hotspotBuffer[ringBufferWriteSlot(&rfFrameRing)], frameBuf, AMBE_AUDIO_LENGTH + LC_DATA_LENGTH + 2);// 27 audio + 0x0c header + 2 hotspot signalling bytes
+		ringBufferCommitWrite(&rfFrameRing, 1);
+	}
+}
+
+// Called by the HR-C6000 ISR, the frame is kept in the buffer when remove is false (e.g. used again for the silence frames)
+bool hotspotGetTxFrame(uint8_t *frameBuf, bool remove)
+{
+	if (ringBufferCount(&hotspotTxFrameRing) == 0)
+	{
+		return false;
+	}
+
+	memcpy(frameBuf, (uint8_t *)&audioAndHotspotDataBuffer.hotspotBuffer[ringBufferReadSlot(&hotspotTxFrameRing)], AMBE_AUDIO_LENGTH + LC_DATA_LENGTH);
+
+	if (remove)
+	{
+		ringBufferCommitRead(&hotspotTxFrameRing, 1);
+	}
+
+	return true;
 }
 
 static bool getEmbeddedData(volatile const uint8_t *comBuffer)
@@ -2053,20 +1683,20 @@ static void storeNetFrame(volatile const uint8_t *comBuffer)
 		hotspotState == HOTSPOT_STATE_TX_SHUTDOWN  ||
 		hotspotState == HOTSPOT_STATE_TX_START_BUFFERING)
 	{
-		if (wavbuffer_count >= HOTSPOT_BUFFER_COUNT)
+		if (ringBufferReserve(&hotspotTxFrameRing, 1) == false)
 		{
-			// Buffer overflow
+			// Buffer overflow, MMDVMHost should have checked the DMR space
+			return;
 		}
 
-		taskENTER_CRITICAL();
-		memcpy((uint8_t *)&audioAndHotspotDataBuffer.hotspotBuffer[wavbuffer_write_idx][LC_DATA_LENGTH], (uint8_t *)comBuffer + 4, 13);//copy the first 13, whole bytes of audio
-		audioAndHotspotDataBuffer.hotspotBuffer[wavbuffer_write_idx][LC_DATA_LENGTH + 13] = (comBuffer[17] & 0xF0) | (comBuffer[23] & 0x0F);
-		memcpy((uint8_t *)&audioAndHotspotDataBuffer.hotspotBuffer[wavbuffer_write_idx][LC_DATA_LENGTH + 14], (uint8_t *)&comBuffer[24], 13);//copy the last 13, whole bytes of audio
+		uint32_t slot = ringBufferWriteSlot(&hotspotTxFrameRing);
+
+		memcpy((uint8_t *)&audioAndHotspotDataBuffer.hotspotBuffer[slot][LC_DATA_LENGTH], (uint8_t *)comBuffer + 4, 13);//copy the first 13, whole bytes of audio
+		audioAndHotspotDataBuffer.hotspotBuffer[slot][LC_DATA_LENGTH + 13] = (comBuffer[17] & 0xF0) | (comBuffer[23] & 0x0F);
+		memcpy((uint8_t *)&audioAndHotspotDataBuffer.hotspotBuffer[slot][LC_DATA_LENGTH + 14], (uint8_t *)&comBuffer[24], 13);//copy the last 13, whole bytes of audio
 
-		memcpy((uint8_t *)&audioAndHotspotDataBuffer.hotspotBuffer[wavbuffer_write_idx], hotspotTxLC, 9);// copy the current LC into the data (mainly for use with the embedded data);
-		wavbuffer_count++;
-		wavbuffer_write_idx = ((wavbuffer_write_idx + 1) % HOTSPOT_BUFFER_COUNT);
-		taskEXIT_CRITICAL();
+		memcpy((uint8_t *)&audioAndHotspotDataBuffer.hotspotBuffer[slot], hotspotTxLC, 9);// copy the current LC into the data (mainly for use with the embedded data);
+		ringBufferCommitWrite(&hotspotTxFrameRing, 1);
 	}
 }
 
@@ -2284,7 +1914,7 @@ void hotspotStateMachine(void)
 				trxDisableTransmission();
 			}
 
-			rfFrameBufCount = 0;
+			ringBufferFlush(&rfFrameRing);
 			if (hotspotMmdvmHostIsConnected)
 			{
 				hotspotState = HOTSPOT_STATE_INITIALISE;
@@ -2294,7 +1924,7 @@ void hotspotStateMachine(void)
 				if ((nonVolatileSettings.hotspotType == HOTSPOT_TYPE_MMDVM) &&
 						((ticksGetMillis() - mmdvmHostLastActiveTime) > MMDVMHOST_TIMEOUT))
 				{
-					wavbuffer_count = 0;
+					ringBufferReset(&hotspotTxFrameRing);
 
 					hotspotExit();
 					break;
@@ -2303,10 +1933,8 @@ void hotspotStateMachine(void)
 			break;
 
 		case HOTSPOT_STATE_INITIALISE:
-			wavbuffer_read_idx = 0;
-			wavbuffer_write_idx = 0;
-			wavbuffer_count = 0;
-			rfFrameBufCount = 0;
+			ringBufferReset(&hotspotTxFrameRing);
+			ringBufferFlush(&rfFrameRing);
 
 			overriddenLCAvailable = false;
 
@@ -2323,9 +1951,7 @@ void hotspotStateMachine(void)
 			}
 
 			rxLCFrameSent = false;
-			wavbuffer_read_idx = 0;
-			wavbuffer_write_idx = 0;
-			wavbuffer_count = 0;
+			ringBufferReset(&hotspotTxFrameRing);
 			rxFrameTime = ticksGetMillis();
 
 			hotspotState = HOTSPOT_STATE_RX_PROCESS;
@@ -2340,8 +1966,8 @@ void hotspotStateMachine(void)
 				{
 					hotspotMmdvmHostIsConnected = false;
 					hotspotState = HOTSPOT_STATE_NOT_CONNECTED;
-					rfFrameBufCount = 0;
-					wavbuffer_count = 0;
+					ringBufferFlush(&rfFrameRing);
+					ringBufferReset(&hotspotTxFrameRing);
 
 					hotspotExit();
 					break;
@@ -2350,8 +1976,8 @@ void hotspotStateMachine(void)
 			else
 			{
 				hotspotState = HOTSPOT_STATE_NOT_CONNECTED;
-				rfFrameBufCount = 0;
-				wavbuffer_count = 0;
+				ringBufferFlush(&rfFrameRing);
+				ringBufferReset(&hotspotTxFrameRing);
 
 				if (trxTransmissionEnabled)
 				{
@@ -2363,18 +1989,20 @@ void hotspotStateMachine(void)
 				break;
 			}
 
-			if (rfFrameBufCount > 0)
+			if (ringBufferCount(&rfFrameRing) > 0)
 			{
+				uint32_t slot = ringBufferReadSlot(&rfFrameRing);
+
 				// We have pending data in RF side, but don't process it when MMDVMHost
 				// set the hotspot in POCSAG mode. Just trash it.
 				if (hotspotModemState == STATE_POCSAG)
 				{
-					memset((void *)&audioAndHotspotDataBuffer.hotspotBuffer[rfFrameBufReadIdx], 0, HOTSPOT_BUFFER_SIZE);
+					memset((void *)&audioAndHotspotDataBuffer.hotspotBuffer[slot], 0, HOTSPOT_BUFFER_SIZE);
 				}
 
 				if (MMDVMHostRxState == MMDVMHOST_RX_READY)
 				{
-					uint8_t rx_command = audioAndHotspotDataBuffer.hotspotBuffer[rfFrameBufReadIdx][AMBE_AUDIO_LENGTH + LC_DATA_LENGTH];
+					uint8_t rx_command = audioAndHotspotDataBuffer.hotspotBuffer[slot][AMBE_AUDIO_LENGTH + LC_DATA_LENGTH];
 
 					switch(rx_command)
 					{
@@ -2382,7 +2010,7 @@ void hotspotStateMachine(void)
 							break;
 
 						case HOTSPOT_RX_START:
-							if (sendVoiceHeaderLC_Frame(audioAndHotspotDataBuffer.hotspotBuffer[rfFrameBufReadIdx]))
+							if (sendVoiceHeaderLC_Frame(audioAndHotspotDataBuffer.hotspotBuffer[slot]))
 							{
 								rxLCFrameSent = true;
 								uiHotspotUpdateScreen(rx_command);
@@ -2392,7 +2020,7 @@ void hotspotStateMachine(void)
 							break;
 
 						case HOTSPOT_RX_START_LATE:
-							if (sendVoiceHeaderLC_Frame(audioAndHotspotDataBuffer.hotspotBuffer[rfFrameBufReadIdx]))
+							if (sendVoiceHeaderLC_Frame(audioAndHotspotDataBuffer.hotspotBuffer[slot]))
 							{
 								rxLCFrameSent = true;
 								uiHotspotUpdateScreen(rx_command);
@@ -2404,7 +2032,7 @@ void hotspotStateMachine(void)
 						case HOTSPOT_RX_AUDIO_FRAME:
 							if (rxLCFrameSent)
 							{
-								if (hotspotSendVoiceFrame(audioAndHotspotDataBuffer.hotspotBuffer[rfFrameBufReadIdx]))
+								if (hotspotSendVoiceFrame(audioAndHotspotDataBuffer.hotspotBuffer[slot]))
 								{
 									lastRxState = HOTSPOT_RX_AUDIO_FRAME;
 									rxFrameTime = ticksGetMillis();
@@ -2414,7 +2042,7 @@ void hotspotStateMachine(void)
 							{
 								// Under some conditions, starting frames were missed, probably due to frequency instabilities.
 								// This will pick the LC data from this voice frame, and send a voice frame header to MMDVMHost.
-								if (sendVoiceHeaderLC_Frame(audioAndHotspotDataBuffer.hotspotBuffer[rfFrameBufReadIdx]))
+								if (sendVoiceHeaderLC_Frame(audioAndHotspotDataBuffer.hotspotBuffer[slot]))
 								{
 									rxLCFrameSent = true;
 									uiHotspotUpdateScreen(HOTSPOT_RX_START_LATE);
@@ -2428,7 +2056,7 @@ void hotspotStateMachine(void)
 							uiHotspotUpdateScreen(rx_command);
 							if (rxLCFrameSent)
 							{
-								sendTerminator_LC_Frame(audioAndHotspotDataBuffer.hotspotBuffer[rfFrameBufReadIdx]);
+								sendTerminator_LC_Frame(audioAndHotspotDataBuffer.hotspotBuffer[slot]);
 							}
 							lastRxState = HOTSPOT_RX_STOP;
 							hotspotState = HOTSPOT_STATE_RX_END;
@@ -2439,13 +2067,8 @@ void hotspotStateMachine(void)
 							break;
 					}
 
-					memset((void *)&audioAndHotspotDataBuffer.hotspotBuffer[rfFrameBufReadIdx], 0, HOTSPOT_BUFFER_SIZE);
-					rfFrameBufReadIdx = ((rfFrameBufReadIdx + 1) % HOTSPOT_BUFFER_COUNT);
-
-					if (rfFrameBufCount > 0)
-					{
-						rfFrameBufCount--;
-					}
+					memset((void *)&audioAndHotspotDataBuffer.hotspotBuffer[slot], 0, HOTSPOT_BUFFER_SIZE);
+					ringBufferCommitRead(&rfFrameRing, 1);
 				}
 				else
 				{
@@ -2463,7 +2086,7 @@ void hotspotStateMachine(void)
 					uiHotspotUpdateScreen(HOTSPOT_RX_IDLE);
 					lastRxState = HOTSPOT_RX_STOP;
 					hotspotState = HOTSPOT_STATE_RX_END;
-					rfFrameBufCount = 0;
+					ringBufferFlush(&rfFrameRing);
 					return;
 				}
 			}
@@ -2479,10 +2102,7 @@ void hotspotStateMachine(void)
 			if (hotspotModemState == STATE_IDLE)
 			{
 				//modemState = STATE_DMR;
-				//wavbuffer_read_idx = 0;
-				//wavbuffer_write_idx = 0;
-				//wavbuffer_count = 0;
-				rfFrameBufCount = 0;
+				ringBufferFlush(&rfFrameRing);
 				lastRxState = HOTSPOT_RX_IDLE;
 				hotspotState = HOTSPOT_STATE_TX_SHUTDOWN;
 				hotspotMmdvmHostIsConnected = false;
@@ -2492,7 +2112,7 @@ void hotspotStateMachine(void)
 			}
 			else
 			{
-				if (wavbuffer_count > TX_BUFFER_MIN_BEFORE_TRANSMISSION)
+				if (ringBufferCount(&hotspotTxFrameRing) > TX_BUFFER_MIN_BEFORE_TRANSMISSION)
 				{
 					if (hotspotCwKeying == false)
 					{
@@ -2518,7 +2138,7 @@ void hotspotStateMachine(void)
 
 		case HOTSPOT_STATE_TRANSMITTING:
 			// Stop transmitting when there is no data in the buffer or if MMDVMHost sends the idle command
-			if (((wavbuffer_count == 0) && (--netRXDataTimer <= 0)) || (hotspotModemState == STATE_IDLE))
+			if (((ringBufferCount(&hotspotTxFrameRing) == 0) && (--netRXDataTimer <= 0)) || (hotspotModemState == STATE_IDLE))
 			{
 				hotspotState = HOTSPOT_STATE_TX_SHUTDOWN;
 				txStopDelay = ((hotspotModemState == STATE_IDLE) ? TX_BUFFERING_TIMEOUT : (TX_BUFFERING_TIMEOUT * 2));
@@ -2532,7 +2152,7 @@ void hotspotStateMachine(void)
 				txStopDelay--;
 
 				// Some data appeared in the buffer while shutting down, restart buffering.
-				if (wavbuffer_count > 0)
+				if (ringBufferCount(&hotspotTxFrameRing) > 0)
 				{
 					// restart
 					timeoutCounter = TX_BUFFERING_TIMEOUT;
@@ -2630,12 +2250,12 @@ static uint8_t setFreq(const uint8_t *data, uint8_t length)
 
 static bool hasRXOverflow(void)
 {
-	return ((HOTSPOT_BUFFER_SIZE - rfFrameBufCount) <= 0);
+	return (ringBufferFree(&rfFrameRing) == 0);
 }
 
 static bool hasTXOverflow(void)
 {
-	return ((HOTSPOT_BUFFER_COUNT - wavbuffer_count) <= 0);
+	return (ringBufferFree(&hotspotTxFrameRing) == 0);
 }
 
 void hotspotInit(void)
@@ -2656,18 +2276,18 @@ void hotspotInit(void)
 	rxLCFrameSent = false;
 
 	// Clear RF buffers
-	rfFrameBufCount = 0;
-	rfFrameBufReadIdx = 0;
-	rfFrameBufWriteIdx = 0;
+	ringBufferReset(&rfFrameRing);
+	ringBufferReset(&hotspotTxFrameRing);
 	for (uint8_t i = 0; i < HOTSPOT_BUFFER_COUNT; i++)
 	{
 		memset((void *)&audioAndHotspotDataBuffer.hotspotBuffer[i], 0, HOTSPOT_BUFFER_SIZE);
 	}
 
 	// Clear USB TX buffers
-	usbComSendBufWritePosition = 0;
-	usbComSendBufReadPosition = 0;
-	usbComSendBufCount = 0;
+	taskENTER_CRITICAL();
+	ringBufferReset(&usbTxQueueRing);
+	usbTxInFlightLength = 0;
+	taskEXIT_CRITICAL();
 	memset((uint8_t *)&usbComSendBuf, 0, sizeof(usbComSendBuf));
 
 	trxSetModeAndBandwidth(RADIO_MODE_DIGITAL, false);// hotspot mode is for DMR i.e Digital mode
@@ -314,6 +314,7 @@ void trxSetModeAndBandwidth(int mode, bool bandwidthIs25kHz)
 	{
 		currentRadioDevice->currentMode = mode;
 
+		radioBeginRegisterBatch();
 		taskENTER_CRITICAL();
 		switch(mode)
 		{
@@ -343,6 +344,7 @@ void trxSetModeAndBandwidth(int mode, bool bandwidthIs25kHz)
 				break;
 		}
 		taskEXIT_CRITICAL();
+		radioEndRegisterBatch();
 	}
 	else
 	{
@@ -457,23 +459,20 @@ void trxReadRSSIAndNoise(bool force)
 	}
 }
 
-bool trxCarrierDetected(RadioDevice_t deviceId)
+static bool trxNoiseIsUnderSquelch(TRXDevice_t *radioDevice, int mode, struct_codeplugChannel_t *channel)
 {
-	TRXDevice_t *radioDevice = &radioDevices[deviceId];// Get pointer to device to make code below more efficient
 	uint8_t squelch = 0;
 
-	trxReadRSSIAndNoise(true); // We need to get the RSSI and noise now.
-
-	switch(radioDevice->currentMode)
+	switch(mode)
 	{
 		case RADIO_MODE_NONE:
 			return false;
 			break;
 
 		case RADIO_MODE_ANALOG:
-			if (currentChannelData->sql != 0)
+			if (channel->sql != 0)
 			{
-				squelch = TRX_SQUELCH_MAX - ((currentChannelData->sql - 1) * TRX_SQUELCH_INC);
+				squelch = TRX_SQUELCH_MAX - ((channel->sql - 1) * TRX_SQUELCH_INC);
 			}
 			else
 			{
@@ -489,6 +488,21 @@ bool trxCarrierDetected(RadioDevice_t deviceId)
 	return (radioDevice->trxRxNoise < squelch);
 }
 
+bool trxCarrierDetected(RadioDevice_t deviceId)
+{
+	TRXDevice_t *radioDevice = &radioDevices[deviceId];// Get pointer to device to make code below more efficient
+
+	trxReadRSSIAndNoise(true); // We need to get the RSSI and noise now.
+
+	return trxNoiseIsUnderSquelch(radioDevice, radioDevice->currentMode, currentChannelData);
+}
+
+// Uses the last RSSI and noise reading, against the squelch level of the channel the device has been tuned to.
+bool trxCarrierDetectedOnChannel(RadioDevice_t deviceId, struct_codeplugChannel_t *channel)
+{
+	return trxNoiseIsUnderSquelch(&radioDevices[deviceId], channel->chMode, channel);
+}
+
 bool trxCheckDigitalSquelch(RadioDevice_t deviceId)
 {
 	TRXDevice_t *radioDevice = &radioDevices[deviceId];// Get pointer to device to make code below more efficient
@@ -762,6 +776,7 @@ void trxSetFrequency(uint32_t fRx, uint32_t fTx, int dmrMode)
 			rxPowerSavingSetState(ECOPHASE_POWERSAVE_INACTIVE);
 		}
 
+		radioBeginRegisterBatch();
 		taskENTER_CRITICAL();
 		currentRadioDevice->trxCurrentBand[TRX_RX_FREQ_BAND] = trxGetBandFromFrequency(fRx);
 
@@ -791,6 +806,7 @@ void trxSetFrequency(uint32_t fRx, uint32_t fTx, int dmrMode)
 			ticksTimerStart((ticksTimer_t *)&trxNextSquelchCheckingTimer, RSSI_NOISE_SAMPLE_PERIOD_PIT);
 		}
 		taskEXIT_CRITICAL();
+		radioEndRegisterBatch();
 	}
 }
 
@@ -817,7 +833,7 @@ void trxConfigurePA_DAC_ForFrequencyBand(void)
 	if (currentRadioDeviceId == RADIO_DEVICE_PRIMARY)
 	{
 		currentRadioDevice->trxCurrentBand[TRX_TX_FREQ_BAND] = trxGetBandFromFrequency(currentRadioDevice->currentTxFrequency);
-		calibrationGetPowerForFrequency(currentRadioDevice->currentTxFrequency, &trxPowerSettings);
+		trxPowerSettings = calibrationGetSnapshotForFrequency(currentRadioDevice->currentTxFrequency)->powerSettings;
 		currentRadioDevice->lastSetTxFrequency = currentRadioDevice->currentTxFrequency;
 		currentRadioDevice->lastSetTxPowerLevel = currentRadioDevice->txPowerLevel;
 
@@ -999,10 +1015,12 @@ static void trxUpdateRadioCalibration(void)
 {
 	if (currentRadioDeviceId == RADIO_DEVICE_PRIMARY)
 	{
-		analogIGain = calibrationGetAnalogIGainForFrequency(currentRadioDevice->currentTxFrequency);
-		analogQGain = calibrationGetAnalogQGainForFrequency(currentRadioDevice->currentTxFrequency);
-		digitalIGain = calibrationGetDigitalIGainForFrequency(currentRadioDevice->currentTxFrequency);
-		digitalQGain = calibrationGetDigitalQGainForFrequency(currentRadioDevice->currentTxFrequency);
+		const calibrationSnapshot_t *snapshot = calibrationGetSnapshotForFrequency(currentRadioDevice->currentTxFrequency);
+
+		analogIGain = snapshot->analogIGain;
+		analogQGain = snapshot->analogQGain;
+		digitalIGain = snapshot->digitalIGain;
+		digitalQGain = snapshot->digitalQGain;
 		Mod2Offset = calibrationGetMod2Offset(currentRadioDevice->trxCurrentBand[trxTransmissionEnabled ? TRX_TX_FREQ_BAND : TRX_RX_FREQ_BAND]);
 	}
 }
@@ -32,6 +32,8 @@
 #include "user_interface/uiLocalisation.h"
 #include "functions/rxPowerSaving.h"
 #include "hardware/radioHardwareInterface.h"
+#include "hardware/SPI_Flash.h"
+#include "functions/ringBuffer.h"
 
 const uint32_t VOICE_PROMPTS_DATA_MAGIC = 0x5056;//'VP'
 const uint32_t VOICE_PROMPTS_DATA_VERSION =
@@ -53,17 +55,39 @@ typedef struct
 const uint32_t VOICE_PROMPTS_FLASH_HEADER_ADDRESS     = 0x8F400 + FLASH_ADDRESS_OFFSET;
 const uint32_t VOICE_PROMPTS_FLASH_OLD_HEADER_ADDRESS = 0xE0000 + FLASH_ADDRESS_OFFSET;
 static uint32_t voicePromptsFlashDataAddress;// = VOICE_PROMPTS_FLASH_HEADER_ADDRESS + sizeof(VoicePromptsDataHeader_t) + sizeof(uint32_t)*VOICE_PROMPTS_TOC_SIZE ;
-// 76 x 27 byte ambe frames
-#define AMBE_DATA_BUFFER_SIZE  2052
 bool voicePromptDataIsLoaded = false;
 static volatile bool voicePromptIsActive = false; // used within ISR
-static int promptDataPosition = -1;
-static int currentPromptLength = -1;
 
 #define PROMPT_TAIL  30
 static volatile uint32_t promptTail = 0; // used within ISR
 
-static __attribute__((section(".ccmram"))) uint8_t ambeData[AMBE_DATA_BUFFER_SIZE];
+// The prompts are streamed from the Flash into a small ring of 27 byte ambe frames (3 x 20ms blocks).
+// The whole sequence is fetched as a single stream, hence the next prompt is already buffered when the current one ends.
+#define VOICE_PROMPTS_FRAME_RING_SIZE      16 // Needs to be a power of two
+#define VOICE_PROMPTS_FETCH_MAX_FRAMES      8
+
+typedef enum
+{
+	VOICE_PROMPTS_FETCH_IDLE = 0,
+	VOICE_PROMPTS_FETCH_PENDING,
+	VOICE_PROMPTS_FETCH_DONE,
+	VOICE_PROMPTS_FETCH_FAILED
+} voicePromptsFetchState_t;
+
+typedef struct
+{
+	uint32_t                          sequencePos;      // prompt being fetched
+	uint32_t                          promptOffset;     // of the next frame to fetch, in the prompts data
+	uint32_t                          promptFramesLeft;
+	bool                              sequenceFetched;
+	uint32_t                          requestFrames;
+	bool                              discardRequest;   // the stream has been restarted while the request was in progress
+	volatile voicePromptsFetchState_t state;            // set by the SPI Flash callback
+} voicePromptsFetch_t;
+
+static uint8_t ambeFrames[VOICE_PROMPTS_FRAME_RING_SIZE][AMBE_AUDIO_LENGTH]; // Not in CCM RAM, so it can be filled by DMA
+static ringBuffer_t ambeFramesRing = RING_BUFFER_INITIALISER(VOICE_PROMPTS_FRAME_RING_SIZE);
+static voicePromptsFetch_t voicePromptsFetch = { .state = VOICE_PROMPTS_FETCH_IDLE };
 
 #define VOICE_PROMPTS_SEQUENCE_BUFFER_SIZE 128
 
@@ -128,11 +152,88 @@ bool voicePromptsCheckMagicAndVersion(uint32_t *bufferAddress)
 	return ((header->magic == VOICE_PROMPTS_DATA_MAGIC) && (header->version == VOICE_PROMPTS_DATA_VERSION));
 }
 
-static void getAmbeData(int offset, int length)
+static void voicePromptsFetchCallback(bool success, void *userData)
+{
+	voicePromptsFetch.state = (success ? VOICE_PROMPTS_FETCH_DONE : VOICE_PROMPTS_FETCH_FAILED);
+}
+
+static void voicePromptsFetchSelectPrompt(uint32_t sequencePos)
+{
+	int promptNumber = voicePromptsCurrentSequence.Buffer[sequencePos];
+
+	if ((tableOfContents[promptNumber + 1] == 0) || (tableOfContents[promptNumber] == 0))
+	{
+		promptNumber = PROMPT_SILENCE;
+	}
+
+	voicePromptsFetch.sequencePos = sequencePos;
+	voicePromptsFetch.promptOffset = tableOfContents[promptNumber];
+	voicePromptsFetch.promptFramesLeft = (tableOfContents[promptNumber + 1] - tableOfContents[promptNumber]) / AMBE_AUDIO_LENGTH;
+}
+
+// Restarts the stream from the beginning of the sequence
+static void voicePromptsFetchStart(void)
 {
-	if (length <= AMBE_DATA_BUFFER_SIZE)
+	voicePromptsFetch.discardRequest = (voicePromptsFetch.state != VOICE_PROMPTS_FETCH_IDLE);
+	voicePromptsFetch.sequenceFetched = false;
+	ringBufferReset(&ambeFramesRing);
+	voicePromptsFetchSelectPrompt(0);
+}
+
+// Collects the completed Flash read, then requests the next frames, as many as can be put contiguously in the ring.
+static void voicePromptsFetchTick(void)
+{
+	voicePromptsFetchState_t state = voicePromptsFetch.state;
+
+	if ((state == VOICE_PROMPTS_FETCH_DONE) || (state == VOICE_PROMPTS_FETCH_FAILED))
+	{
+		if (voicePromptsFetch.discardRequest == false)
+		{
+			// On failure, the frames are skipped
+			if (state == VOICE_PROMPTS_FETCH_DONE)
+			{
+				ringBufferCommitWrite(&ambeFramesRing, voicePromptsFetch.requestFrames);
+			}
+
+			voicePromptsFetch.promptOffset += (voicePromptsFetch.requestFrames * AMBE_AUDIO_LENGTH);
+			voicePromptsFetch.promptFramesLeft -= voicePromptsFetch.requestFrames;
+		}
+
+		voicePromptsFetch.discardRequest = false;
+		voicePromptsFetch.state = VOICE_PROMPTS_FETCH_IDLE;
+	}
+
+	if ((voicePromptsFetch.state != VOICE_PROMPTS_FETCH_IDLE) || (voicePromptIsActive == false) || voicePromptsFetch.sequenceFetched)
+	{
+		return;
+	}
+
+	while (voicePromptsFetch.promptFramesLeft == 0)
 	{
-		SPI_Flash_read(voicePromptsFlashDataAddress + offset, (uint8_t *)&ambeData, length);
+		if ((voicePromptsFetch.sequencePos + 1) >= voicePromptsCurrentSequence.Length)
+		{
+			voicePromptsFetch.sequenceFetched = true;
+			return;
+		}
+
+		voicePromptsFetchSelectPrompt(voicePromptsFetch.sequencePos + 1);
+	}
+
+	uint32_t slot = ringBufferWriteSlot(&ambeFramesRing);
+	uint32_t frames = SAFE_MIN(ringBufferFree(&ambeFramesRing), (VOICE_PROMPTS_FRAME_RING_SIZE - slot));
+
+	frames = SAFE_MIN(frames, SAFE_MIN(voicePromptsFetch.promptFramesLeft, VOICE_PROMPTS_FETCH_MAX_FRAMES));
+
+	if (frames > 0)
+	{
+		voicePromptsFetch.requestFrames = frames;
+		voicePromptsFetch.state = VOICE_PROMPTS_FETCH_PENDING;
+
+		if (SPI_Flash_readAsync((voicePromptsFlashDataAddress + voicePromptsFetch.promptOffset), ambeFrames[slot], (frames * AMBE_AUDIO_LENGTH),
+				voicePromptsFetchCallback, NULL) == false)
+		{
+			voicePromptsFetch.state = VOICE_PROMPTS_FETCH_IDLE; // Request queue is full, retry on next tick
+		}
 	}
 }
 
@@ -156,45 +257,30 @@ static void voicePromptsTerminateOptionalTail(bool withTail)
 
 void voicePromptsTick(void)
 {
+	voicePromptsFetchTick();
+
 	if (voicePromptIsActive)
 	{
-		if (promptDataPosition < currentPromptLength)
+		if (ringBufferCount(&ambeFramesRing) > 0)
 		{
-			taskENTER_CRITICAL();
-			if (wavbuffer_count <= WAV_BUFFER_AMBE_PREBUFFERING_COUNT)
+			// The HR-C6000 doesn't decode while a prompt is playing, and the wave buffer ring is lock free.
+			if (ringBufferCount(&wavbufferRing) <= WAV_BUFFER_AMBE_PREBUFFERING_COUNT)
 			{
-				codecDecode((uint8_t *)&ambeData[promptDataPosition], 3);
-				promptDataPosition += AMBE_AUDIO_LENGTH;
+				codecDecode(ambeFrames[ringBufferReadSlot(&ambeFramesRing)], 3);
+				ringBufferCommitRead(&ambeFramesRing, 1);
 			}
 
+			taskENTER_CRITICAL();
 			soundTickRXBuffer();
 			taskEXIT_CRITICAL();
 		}
-		else
+		else if (voicePromptsFetch.sequenceFetched)
 		{
-			if (voicePromptsCurrentSequence.Pos < (voicePromptsCurrentSequence.Length - 1))
-			{
-				voicePromptsCurrentSequence.Pos++;
-				promptDataPosition = 0;
+			// wait for wave buffer to empty when prompt has finished playing
 
-				int promptNumber = voicePromptsCurrentSequence.Buffer[voicePromptsCurrentSequence.Pos];
-
-				if ((tableOfContents[promptNumber + 1] == 0) || (tableOfContents[promptNumber] == 0))
-				{
-					promptNumber = PROMPT_SILENCE;
-				}
-
-				currentPromptLength = tableOfContents[promptNumber + 1] - tableOfContents[promptNumber];
-				getAmbeData(tableOfContents[promptNumber], currentPromptLength);
-			}
-			else
+			if (ringBufferCount(&wavbufferRing) == 0)
 			{
-				// wait for wave buffer to empty when prompt has finished playing
-
-				if (wavbuffer_count == 0)
-				{
-					voicePromptsTerminateOptionalTail(true);
-				}
+				voicePromptsTerminateOptionalTail(true);
 			}
 		}
 	}
@@ -375,26 +461,18 @@ void voicePromptsPlay(void)
 			soundStopMelody();
 		}
 
-		int promptNumber = voicePromptsCurrentSequence.Buffer[0];
-
 		voicePromptsCurrentSequence.Pos = 0;
-
-		if ((tableOfContents[promptNumber + 1] == 0) || (tableOfContents[promptNumber] == 0))
-		{
-			promptNumber = PROMPT_SILENCE;
-		}
-
-		currentPromptLength = tableOfContents[promptNumber + 1] - tableOfContents[promptNumber];
-		getAmbeData(tableOfContents[promptNumber], currentPromptLength);
+		voicePromptsFetchStart();
 
 		radioSetAudioPath(false);			// set the audio path to HR-C6000 -> audio amp (Actually this is always on, this call just disables the FM audio)
 		enableAudioAmp(AUDIO_AMP_MODE_PROMPT);
 
 		codecInit(true);
-		promptDataPosition = 0;
 		promptTail = 0;
 
 		taskEXIT_CRITICAL();
+
+		voicePromptsFetchTick(); // Starts fetching the first frames now
 	}
 }
 
@@ -70,6 +70,28 @@ static uint8_t currentRegisterBank[RADIO_DEVICE_MAX] = { 0, 0 }; // offset in ca
 
 static const uint16_t AT1846S_I2C_ADDRSSES[RADIO_DEVICE_MAX] = { 0x5CU, 0xE2U };
 
+// Register writes made inside a batch are only diffed against the cache and queued, then sent, once the batch ends,
+// by a chain of interrupt driven I2C transfers, so the callers don't have to keep the interrupts disabled while the bus is busy.
+#define AT1846S_WRITE_QUEUE_SIZE     64 // Enough for a full mode, bandwidth and frequency change
+#define AT1846S_WRITE_QUEUE_RETRIES  3
+
+typedef struct
+{
+	uint8_t deviceId;
+	uint8_t bank;
+	uint8_t data[AT1846_BYTES_PER_COMMAND]; // reg, high byte, low byte. reg 0xFF is a delay
+} AT1846sQueuedWrite_t;
+
+static struct
+{
+	AT1846sQueuedWrite_t writes[AT1846S_WRITE_QUEUE_SIZE];
+	volatile uint8_t     head;
+	volatile uint8_t     count;
+	volatile bool        sending;    // A chain of I2C transfers is in progress, the bus can't be used
+	uint8_t              retries;
+	int                  batchDepth;
+} AT1846sWriteQueue;
+
 //
 // NOTE: register 0xFF is used for osDelay, values are concatenated for the delay value (in ms).
 //       use AT_DELAY(ms) macro to add an osDelay() call in the middle of a sequence
@@ -284,10 +306,180 @@ void AT1846sSetBandWidth(bool Is25K)
 	taskEXIT_CRITICAL();
 }
 
+// Writes are queued while a batch is open, or while the queue is being sent, to keep them in order.
+static inline bool AT1846sWriteQueueInUse(void)
+{
+	return ((AT1846sWriteQueue.batchDepth > 0) || (AT1846sWriteQueue.count > 0) || AT1846sWriteQueue.sending);
+}
+
+static bool AT1846sWriteQueueAppend(uint8_t reg, uint8_t val1, uint8_t val2)
+{
+	bool ret = false;
+
+	taskENTER_CRITICAL();
+	if (AT1846sWriteQueue.count < AT1846S_WRITE_QUEUE_SIZE)
+	{
+		AT1846sQueuedWrite_t *write = &AT1846sWriteQueue.writes[(AT1846sWriteQueue.head + AT1846sWriteQueue.count) % AT1846S_WRITE_QUEUE_SIZE];
+
+		write->deviceId = currentRadioDeviceId;
+		write->bank = currentRegisterBank[currentRadioDeviceId];
+		write->data[0] = reg;
+		write->data[1] = val1;
+		write->data[2] = val2;
+		AT1846sWriteQueue.count++;
+		ret = true;
+	}
+	taskEXIT_CRITICAL();
+
+	return ret;
+}
+
+// Starts sending the write at the head of the queue. Called from the task ending the batch, or from the I2C ISR.
+// Returns false if no transfer has been started.
+static bool AT1846sWriteQueueSendHead(void)
+{
+	AT1846sQueuedWrite_t *write = &AT1846sWriteQueue.writes[AT1846sWriteQueue.head];
+
+	// Delays can only be handled by the task ending the batch
+	if ((AT1846sWriteQueue.count == 0) || (write->data[0] == 0xFF) ||
+			(HAL_I2C_Master_Transmit_IT(I2C_DEVICE_HANDLE_POINTER, AT1846S_I2C_ADDRSSES[write->deviceId], write->data, AT1846_BYTES_PER_COMMAND) != HAL_OK))
+	{
+		AT1846sWriteQueue.sending = false;
+		return false;
+	}
+
+	return true;
+}
+
+static void AT1846sWriteQueuePopHead(void)
+{
+	AT1846sWriteQueue.head = ((AT1846sWriteQueue.head + 1) % AT1846S_WRITE_QUEUE_SIZE);
+	AT1846sWriteQueue.count--;
+	AT1846sWriteQueue.retries = 0;
+}
+
+// Counts a failed attempt at sending the head of the queue, giving up on it after AT1846S_WRITE_QUEUE_RETRIES
+static void AT1846sWriteQueueHeadFailed(void)
+{
+	if (AT1846sWriteQueue.retries < AT1846S_WRITE_QUEUE_RETRIES)
+	{
+		AT1846sWriteQueue.retries++;
+	}
+	else
+	{
+		AT1846sQueuedWrite_t *write = &AT1846sWriteQueue.writes[AT1846sWriteQueue.head];
+
+		// Give up on this one, the cache must not pretend it has been written
+		if (write->data[0] < 0x7F)
+		{
+			registerCache[write->deviceId][write->data[0]].cached[write->bank] = false;
+		}
+		AT1846sWriteQueuePopHead();
+	}
+}
+
+void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+	if ((hi2c == I2C_DEVICE_HANDLE_POINTER) && AT1846sWriteQueue.sending)
+	{
+		AT1846sWriteQueuePopHead();
+		AT1846sWriteQueueSendHead();
+	}
+}
+
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
+{
+	if ((hi2c == I2C_DEVICE_HANDLE_POINTER) && AT1846sWriteQueue.sending)
+	{
+		AT1846sWriteQueueHeadFailed();
+		AT1846sWriteQueueSendHead();
+	}
+}
+
+void AT1846sBeginBatch(void)
+{
+	taskENTER_CRITICAL();
+	AT1846sWriteQueue.batchDepth++;
+	taskEXIT_CRITICAL();
+}
+
+// Must be called outside of any critical section. Returns once all the queued writes have been sent.
+void AT1846sEndBatch(void)
+{
+	bool isLast;
+
+	taskENTER_CRITICAL();
+	AT1846sWriteQueue.batchDepth--;
+	isLast = (AT1846sWriteQueue.batchDepth == 0);
+	taskEXIT_CRITICAL();
+
+	if (isLast == false)
+	{
+		return;
+	}
+
+	while (true)
+	{
+		uint32_t delay = 0;
+		bool start = false;
+
+		taskENTER_CRITICAL();
+		if ((AT1846sWriteQueue.count == 0) && (AT1846sWriteQueue.sending == false))
+		{
+			taskEXIT_CRITICAL();
+			break;
+		}
+
+		if (AT1846sWriteQueue.sending == false)
+		{
+			AT1846sQueuedWrite_t *write = &AT1846sWriteQueue.writes[AT1846sWriteQueue.head];
+
+			if (write->data[0] == 0xFF)
+			{
+				delay = ((uint32_t)(write->data[1] << 8 | write->data[2]));
+				AT1846sWriteQueuePopHead();
+			}
+			else
+			{
+				AT1846sWriteQueue.sending = true;
+				start = true;
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		if (delay > 0)
+		{
+			osDelay(delay);
+		}
+		else if (start)
+		{
+			// The bus is still used by a blocking transfer, or stuck. Try again later, a limited number of times,
+			// as the old blocking writes did, so the caller can't hang here.
+			if (AT1846sWriteQueueSendHead() == false)
+			{
+				taskENTER_CRITICAL();
+				AT1846sWriteQueueHeadFailed();
+				taskEXIT_CRITICAL();
+
+				osDelay(1U);
+			}
+		}
+		else
+		{
+			osThreadYield();
+		}
+	}
+}
+
 bool radioWriteReg2byte(uint8_t reg, uint8_t val1, uint8_t val2)
 {
 	if (reg == 0xFF)
 	{
+		if (AT1846sWriteQueueInUse())
+		{
+			return AT1846sWriteQueueAppend(reg, val1, val2);
+		}
+
 		osDelay(((uint32_t)(val1 << 8 | val2)));
 		return true;
 	}
@@ -305,6 +497,24 @@ bool radioWriteReg2byte(uint8_t reg, uint8_t val1, uint8_t val2)
 		}
 	}
 
+	if (AT1846sWriteQueueInUse())
+	{
+		if (AT1846sWriteQueueAppend(reg, val1, val2) == false)
+		{
+			return false;
+		}
+
+		// The cache already holds what the register will contain, once the queue has been sent
+		if (reg != 0x7F)
+		{
+			registerCache[currentRadioDeviceId][reg].cached[currentRegisterBank[currentRadioDeviceId]] = true;
+			registerCache[currentRadioDeviceId][reg].highByte[currentRegisterBank[currentRadioDeviceId]] = val1;
+			registerCache[currentRadioDeviceId][reg].lowByte[currentRegisterBank[currentRadioDeviceId]] = val2;
+		}
+
+		return true;
+	}
+
 	uint8_t data[] = { reg, val1, val2 };
 	int8_t retries = 3;
 	bool ret = false;
@@ -338,6 +548,12 @@ bool radioReadReg2byte(uint8_t reg, uint8_t *val1, uint8_t *val2)
 	int8_t retries = 3;
 	bool ret = false;
 
+	// The bus is busy sending the queued writes
+	if (AT1846sWriteQueue.sending)
+	{
+		return false;
+	}
+
 	do
 	{
 		ret = (HAL_I2C_Master_Transmit(I2C_DEVICE_HANDLE_POINTER, AT1846S_I2C_ADDRSSES[currentRadioDeviceId], data, 1, HAL_MAX_DELAY) == HAL_OK);
@@ -600,6 +816,12 @@ bool AT1846sWriteTone1Reg(uint16_t toneFreqVal)
 	int8_t retries = 3;
 	bool ret = false;
 
+	// Not cached, as the tone register is constantly rewritten
+	if (AT1846sWriteQueueInUse())
+	{
+		return AT1846sWriteQueueAppend(reg, val1, val2);
+	}
+
 	do
 	{
 		ret = (HAL_I2C_Master_Transmit(I2C_DEVICE_HANDLE_POINTER, AT1846S_I2C_ADDRSSES[currentRadioDeviceId], data, 3, HAL_MAX_DELAY) == HAL_OK);
@@ -24,12 +24,15 @@
  * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  *
  */
+#include <string.h>
+#include <stddef.h>
 #include "hardware/EEPROM.h"
 #if defined(USING_EXTERNAL_DEBUGGER)
 #include "../../../SeggerRTT/RTT/SEGGER_RTT.h"
 #endif
 #include "hardware/SPI_Flash.h"
 #include "functions/codeplug.h"
+#include "utils.h"
 
 #define MDUV380_EMULATED_EEPROM_ADDRESS_OFFSET  0x000000
 
@@ -37,12 +40,530 @@ const uint8_t EEPROM_ADDRESS 	= 0x50;
 const uint8_t EEPROM_PAGE_SIZE 	= 128;
 // 15M section of the Flash
 
+/*
+ * Write journal
+ *
+ * The emulated EEPROM is a 64k image at the start of the Flash, which is also read/written as is by the CPS.
+ * Rewriting it in place costs a whole sector erase and 16 pages program for every single byte changed,
+ * always on the same few sectors (settings, last used channel in zone, VFOs, etc).
+ *
+ * Instead, writes are appended as records into a ring of Flash sectors (the journal), and an index of the
+ * live records is kept in RAM. Reads get the base image, overlaid by the journal records (oldest first).
+ *
+ * When the journal (or its index) is full, all the records are folded into the base image, then the used
+ * journal sectors are erased, and recording restarts on the next sector of the ring.
+ *
+ * Folding a base image sector erases it, so it is first programmed into a fold copy sector, then logged
+ * as pending in the fold log. If the power goes while the base sector is rewritten, EEPROM_Init() finds
+ * the pending log entry and copies the sector again. The log entries are appended, so the log sector only
+ * gets erased once all its entries have been used, and the copy sectors are used in turn.
+ *
+ * Flash layout (0x18000 - 0x1FFFF): 4 journal sectors, the fold log sector, 3 fold copy sectors.
+ *
+ * Journal sector layout:
+ *   - eepromJournalSectorHeader_t
+ *   - eepromJournalRecordHeader_t + data, repeated until the unprogrammed (0xFF) area.
+ */
+#define EEPROM_SECTOR_SIZE                 4096
+#define EEPROM_JOURNAL_ADDRESS             0x18000 // unused area between the local calibration copy and the codeplug Flash section
+#define EEPROM_JOURNAL_NUM_SECTORS         4
+#define EEPROM_JOURNAL_MAGIC               0x4C4A4545 // "EEJL"
+#define EEPROM_JOURNAL_RECORD_MAX_DATA     (256 - sizeof(eepromJournalRecordHeader_t))
+#define EEPROM_JOURNAL_INDEX_SIZE          128
+#define EEPROM_JOURNAL_BYPASS_SIZE         1024 // bigger writes go straight to the base image
+#define EEPROM_JOURNAL_SECTOR_ADDRESS(s)   (EEPROM_JOURNAL_ADDRESS + ((s) * EEPROM_SECTOR_SIZE))
+#define EEPROM_JOURNAL_NEXT_SECTOR(s)      (((s) + 1) % EEPROM_JOURNAL_NUM_SECTORS)
+#define EEPROM_FOLD_LOG_ADDRESS            EEPROM_JOURNAL_SECTOR_ADDRESS(EEPROM_JOURNAL_NUM_SECTORS) // the sectors after the journal
+#define EEPROM_FOLD_COPY_NUM_SECTORS       3 // each base sector rewrite erases one, they take turns
+#define EEPROM_FOLD_COPY_ADDRESS(e)        (EEPROM_FOLD_LOG_ADDRESS + ((1 + ((e) % EEPROM_FOLD_COPY_NUM_SECTORS)) * EEPROM_SECTOR_SIZE)) // copy sector of log entry e
+#define EEPROM_FOLD_MAGIC                  0x42464545 // "EEFB", no 0xFF byte: the magic is programmed last, a torn entry can't match it
+#define EEPROM_FOLD_LOG_NUM_ENTRIES        (EEPROM_SECTOR_SIZE / sizeof(eepromFoldLogEntry_t))
+
+typedef struct
+{
+	uint32_t magic;
+	uint32_t sequence;
+} eepromJournalSectorHeader_t;
+
+typedef struct
+{
+	uint16_t address;
+	uint8_t  length;
+	uint8_t  checksum;
+} eepromJournalRecordHeader_t;
+
+typedef struct
+{
+	uint16_t address;
+	uint16_t length;
+	uint32_t flashAddress; // where the record data lives
+} eepromJournalIndexEntry_t;
+
+typedef struct
+{
+	uint8_t  sector; // base image sector in the fold copy sector
+	uint8_t  done; // 0xFF while the base sector is rewritten, then programmed to 0x00
+	uint16_t reserved;
+	uint32_t magic;
+} eepromFoldLogEntry_t;
+
+typedef struct
+{
+	bool                      initialised;
+	uint8_t                   firstSector;
+	uint8_t                   currentSector;
+	uint8_t                   erasedSectors; // bitfield of journal sectors known to be blank
+	uint32_t                  sequence; // sequence of the current sector
+	uint32_t                  writeOffset; // within the current sector
+	uint32_t                  foldLogEntry; // next free fold log entry
+	uint8_t                   foldCopyErasedSectors; // bitfield of fold copy sectors known to be blank
+	int                       numEntries;
+	eepromJournalIndexEntry_t index[EEPROM_JOURNAL_INDEX_SIZE];
+} eepromJournal_t;
+
+static eepromJournal_t journal;
+
+static uint8_t eepromJournalChecksum(eepromJournalRecordHeader_t *header, uint8_t *data)
+{
+	uint8_t sum = (header->address & 0xFF) + (header->address >> 8) + header->length;
+
+	for (int i = 0; i < header->length; i++)
+	{
+		sum += data[i];
+	}
+
+	return ~sum;
+}
+
+static void eepromJournalIndexAdd(uint16_t address, uint16_t length, uint32_t flashAddress)
+{
+	int i = 0;
+
+	// Drop the entries which are completely overwritten by the new one
+	while (i < journal.numEntries)
+	{
+		if ((journal.index[i].address >= address) && ((journal.index[i].address + journal.index[i].length) <= (address + length)))
+		{
+			memmove(&journal.index[i], &journal.index[i + 1], ((journal.numEntries - 1) - i) * sizeof(eepromJournalIndexEntry_t));
+			journal.numEntries--;
+		}
+		else
+		{
+			i++;
+		}
+	}
+
+	journal.index[journal.numEntries].address = address;
+	journal.index[journal.numEntries].length = length;
+	journal.index[journal.numEntries].flashAddress = flashAddress;
+	journal.numEntries++;
+}
+
+// Copy the journaled data overlapping [address .. address + size[ into buf, oldest record first.
+static bool eepromJournalOverlay(int address, uint8_t *buf, int size)
+{
+	for (int i = 0; i < journal.numEntries; i++)
+	{
+		eepromJournalIndexEntry_t *entry = &journal.index[i];
+		int start = SAFE_MAX(address, (int)entry->address);
+		int end = SAFE_MIN((address + size), (int)(entry->address + entry->length));
+
+		if (start < end)
+		{
+			if (SPI_Flash_read(entry->flashAddress + (start - entry->address), buf + (start - address), (end - start)) == false)
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+static bool eepromJournalStartSector(uint8_t sector, uint32_t sequence)
+{
+	eepromJournalSectorHeader_t header = { .magic = EEPROM_JOURNAL_MAGIC, .sequence = sequence };
+
+	if ((journal.erasedSectors & (1 << sector)) == 0)
+	{
+		if (SPI_Flash_eraseSector(EEPROM_JOURNAL_SECTOR_ADDRESS(sector)) == false)
+		{
+			return false;
+		}
+	}
+
+	journal.erasedSectors &= ~(1 << sector);
+
+	if (SPI_Flash_programBytes(EEPROM_JOURNAL_SECTOR_ADDRESS(sector), (uint8_t *)&header, sizeof(eepromJournalSectorHeader_t)) == false)
+	{
+		return false;
+	}
+
+	journal.currentSector = sector;
+	journal.sequence = sequence;
+	journal.writeOffset = sizeof(eepromJournalSectorHeader_t);
+
+	return true;
+}
+
+static bool eepromFoldProgramSector(uint32_t address, uint8_t *buf)
+{
+	for (int i = 0; i < (EEPROM_SECTOR_SIZE / 256); i++)
+	{
+		if (SPI_Flash_writePage(address + (i * 256), buf + (i * 256)) == false)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Rewrites a base image sector with the content of SPI_Flash_sectorbuffer, through the fold copy sector.
+static bool eepromFoldRewriteSector(uint8_t sector)
+{
+	eepromFoldLogEntry_t entry = { .sector = sector, .done = 0xFF, .reserved = 0xFFFF, .magic = EEPROM_FOLD_MAGIC };
+	uint32_t entryAddress;
+	uint32_t copyAddress;
+	uint8_t copySector;
+	uint8_t done = 0x00;
+
+	if (journal.foldLogEntry >= EEPROM_FOLD_LOG_NUM_ENTRIES)
+	{
+		if (SPI_Flash_eraseSector(EEPROM_FOLD_LOG_ADDRESS) == false)
+		{
+			return false;
+		}
+		journal.foldLogEntry = 0;
+	}
+
+	entryAddress = EEPROM_FOLD_LOG_ADDRESS + (journal.foldLogEntry * sizeof(eepromFoldLogEntry_t));
+	copyAddress = EEPROM_FOLD_COPY_ADDRESS(journal.foldLogEntry);
+	copySector = (journal.foldLogEntry % EEPROM_FOLD_COPY_NUM_SECTORS);
+	journal.foldLogEntry++;
+
+	if (((journal.foldCopyErasedSectors & (1 << copySector)) == 0) && (SPI_Flash_eraseSector(copyAddress) == false))
+	{
+		return false;
+	}
+	journal.foldCopyErasedSectors &= ~(1 << copySector);
+
+	// The base sector is only erased once its copy is complete, and logged as pending
+	return (eepromFoldProgramSector(copyAddress, SPI_Flash_sectorbuffer) &&
+			SPI_Flash_programBytes(entryAddress, (uint8_t *)&entry, sizeof(eepromFoldLogEntry_t)) &&
+			SPI_Flash_eraseSector((sector * EEPROM_SECTOR_SIZE) + MDUV380_EMULATED_EEPROM_ADDRESS_OFFSET) &&
+			eepromFoldProgramSector((sector * EEPROM_SECTOR_SIZE) + MDUV380_EMULATED_EEPROM_ADDRESS_OFFSET, SPI_Flash_sectorbuffer) &&
+			SPI_Flash_programBytes(entryAddress + offsetof(eepromFoldLogEntry_t, done), &done, 1));
+}
+
+// Finds the next free fold log entry, and completes the base sector rewrite which was interrupted, if any.
+static bool eepromFoldRecover(void)
+{
+	eepromFoldLogEntry_t entry = { 0 };
+	int lastEntry = -1;
+
+	if (SPI_Flash_read(EEPROM_FOLD_LOG_ADDRESS, SPI_Flash_sectorbuffer, EEPROM_SECTOR_SIZE) == false)
+	{
+		return false;
+	}
+
+	for (int i = 0; i < (int)EEPROM_FOLD_LOG_NUM_ENTRIES; i++)
+	{
+		eepromFoldLogEntry_t *logEntry = (eepromFoldLogEntry_t *)(SPI_Flash_sectorbuffer + (i * sizeof(eepromFoldLogEntry_t)));
+
+		// Anything programmed, even torn, uses the entry
+		if ((logEntry->sector != 0xFF) || (logEntry->done != 0xFF) || (logEntry->reserved != 0xFFFF) || (logEntry->magic != 0xFFFFFFFF))
+		{
+			lastEntry = i;
+			entry = *logEntry;
+		}
+	}
+
+	journal.foldLogEntry = (lastEntry + 1);
+	journal.foldCopyErasedSectors = 0;
+
+	// Only the last entry can be pending, the copy sectors have been reused since the previous ones
+	if ((lastEntry >= 0) && (entry.magic == EEPROM_FOLD_MAGIC) && (entry.done == 0xFF) && (entry.reserved == 0xFFFF) &&
+			(entry.sector < (EMULATED_EEPROM_SIZE / EEPROM_SECTOR_SIZE)))
+	{
+		uint32_t sectorAddress = (entry.sector * EEPROM_SECTOR_SIZE) + MDUV380_EMULATED_EEPROM_ADDRESS_OFFSET;
+		uint8_t done = 0x00;
+
+		return (SPI_Flash_read(EEPROM_FOLD_COPY_ADDRESS(lastEntry), SPI_Flash_sectorbuffer, EEPROM_SECTOR_SIZE) &&
+				SPI_Flash_eraseSector(sectorAddress) &&
+				eepromFoldProgramSector(sectorAddress, SPI_Flash_sectorbuffer) &&
+				SPI_Flash_programBytes(EEPROM_FOLD_LOG_ADDRESS + (lastEntry * sizeof(eepromFoldLogEntry_t)) + offsetof(eepromFoldLogEntry_t, done), &done, 1));
+	}
+
+	return true;
+}
+
+// Writes all the journaled data back into the base image, then clear the journal.
+static bool eepromJournalFold(void)
+{
+	if (journal.numEntries > 0)
+	{
+		for (int sector = 0; sector < (EMULATED_EEPROM_SIZE / EEPROM_SECTOR_SIZE); sector++)
+		{
+			uint32_t sectorAddress = (sector * EEPROM_SECTOR_SIZE);
+			bool sectorIsDirty = false;
+
+			for (int i = 0; i < journal.numEntries; i++)
+			{
+				if ((journal.index[i].address < (sectorAddress + EEPROM_SECTOR_SIZE)) && ((journal.index[i].address + journal.index[i].length) > sectorAddress))
+				{
+					sectorIsDirty = true;
+					break;
+				}
+			}
+
+			if (sectorIsDirty)
+			{
+				if ((SPI_Flash_read(sectorAddress + MDUV380_EMULATED_EEPROM_ADDRESS_OFFSET, SPI_Flash_sectorbuffer, EEPROM_SECTOR_SIZE) &&
+						eepromJournalOverlay(sectorAddress, SPI_Flash_sectorbuffer, EEPROM_SECTOR_SIZE) &&
+						eepromFoldRewriteSector(sector)) == false)
+				{
+					return false;
+				}
+			}
+		}
+
+		journal.numEntries = 0;
+	}
+
+	// Nothing has been recorded in the current sector yet, keep on using it
+	if ((journal.firstSector == journal.currentSector) && (journal.writeOffset == sizeof(eepromJournalSectorHeader_t)))
+	{
+		return true;
+	}
+
+	uint8_t sector = journal.firstSector;
+	do
+	{
+		if (SPI_Flash_eraseSector(EEPROM_JOURNAL_SECTOR_ADDRESS(sector)) == false)
+		{
+			return false;
+		}
+		journal.erasedSectors |= (1 << sector);
+
+		if (sector == journal.currentSector)
+		{
+			break;
+		}
+
+		sector = EEPROM_JOURNAL_NEXT_SECTOR(sector);
+	} while (true);
+
+	// Rotate, the next recording starts on the following sector
+	journal.firstSector = EEPROM_JOURNAL_NEXT_SECTOR(journal.currentSector);
+
+	return eepromJournalStartSector(journal.firstSector, (journal.sequence + 1));
+}
+
+static bool eepromJournalAppend(int address, uint8_t *buf, int size)
+{
+	eepromJournalRecordHeader_t header = { .address = address, .length = size };
+	uint8_t record[256];
+
+	if (journal.numEntries >= EEPROM_JOURNAL_INDEX_SIZE)
+	{
+		if (eepromJournalFold() == false)
+		{
+			return false;
+		}
+	}
+
+	if ((journal.writeOffset + sizeof(eepromJournalRecordHeader_t) + size) > EEPROM_SECTOR_SIZE)
+	{
+		uint8_t nextSector = EEPROM_JOURNAL_NEXT_SECTOR(journal.currentSector);
+
+		if (nextSector == journal.firstSector)
+		{
+			// Journal is full
+			if (eepromJournalFold() == false)
+			{
+				return false;
+			}
+		}
+		else if (eepromJournalStartSector(nextSector, (journal.sequence + 1)) == false)
+		{
+			return false;
+		}
+	}
+
+	header.checksum = eepromJournalChecksum(&header, buf);
+	memcpy(record, &header, sizeof(eepromJournalRecordHeader_t));
+	memcpy(record + sizeof(eepromJournalRecordHeader_t), buf, size);
+
+	uint32_t recordAddress = EEPROM_JOURNAL_SECTOR_ADDRESS(journal.currentSector) + journal.writeOffset;
+
+	// Skip the record, even if it failed, as its area could have been partially programmed
+	journal.writeOffset += (sizeof(eepromJournalRecordHeader_t) + size);
+
+	if (SPI_Flash_programBytes(recordAddress, record, (sizeof(eepromJournalRecordHeader_t) + size)) == false)
+	{
+		return false;
+	}
+
+	eepromJournalIndexAdd(address, size, (recordAddress + sizeof(eepromJournalRecordHeader_t)));
+
+	return true;
+}
+
+// Replay the records of a journal sector into the index. Returns the offset of the first free byte in the sector.
+static uint32_t eepromJournalReplaySector(uint8_t sector)
+{
+	uint32_t offset = sizeof(eepromJournalSectorHeader_t);
+	uint8_t data[EEPROM_JOURNAL_RECORD_MAX_DATA];
+
+	while ((offset + sizeof(eepromJournalRecordHeader_t)) <= EEPROM_SECTOR_SIZE)
+	{
+		eepromJournalRecordHeader_t header;
+		uint32_t recordAddress = EEPROM_JOURNAL_SECTOR_ADDRESS(sector) + offset;
+
+		if (SPI_Flash_read(recordAddress, (uint8_t *)&header, sizeof(eepromJournalRecordHeader_t)) == false)
+		{
+			break;
+		}
+
+		// Unprogrammed area, or garbage: this is the end of the recording
+		if ((header.length == 0xFF) || (header.length == 0) || (header.length > EEPROM_JOURNAL_RECORD_MAX_DATA) ||
+				((header.address + header.length) > EMULATED_EEPROM_SIZE) ||
+				((offset + sizeof(eepromJournalRecordHeader_t) + header.length) > EEPROM_SECTOR_SIZE))
+		{
+			if ((header.address == 0xFFFF) && (header.length == 0xFF))
+			{
+				return offset;
+			}
+
+			break;
+		}
+
+		if (SPI_Flash_read(recordAddress + sizeof(eepromJournalRecordHeader_t), data, header.length) &&
+				(eepromJournalChecksum(&header, data) == header.checksum) &&
+				(journal.numEntries < EEPROM_JOURNAL_INDEX_SIZE))
+		{
+			eepromJournalIndexAdd(header.address, header.length, (recordAddress + sizeof(eepromJournalRecordHeader_t)));
+		}
+
+		// A torn record (power loss while programming) is skipped
+		offset += (sizeof(eepromJournalRecordHeader_t) + header.length);
+	}
+
+	// Don't append anything in a sector we don't understand anymore
+	return EEPROM_SECTOR_SIZE;
+}
+
+bool EEPROM_Init(void)
+{
+	eepromJournalSectorHeader_t headers[EEPROM_JOURNAL_NUM_SECTORS];
+	int firstSector = -1;
+
+	memset(&journal, 0, sizeof(eepromJournal_t));
+
+	if (eepromFoldRecover() == false)
+	{
+		return false;
+	}
+
+	for (int i = 0; i < EEPROM_JOURNAL_NUM_SECTORS; i++)
+	{
+		if (SPI_Flash_read(EEPROM_JOURNAL_SECTOR_ADDRESS(i), (uint8_t *)&headers[i], sizeof(eepromJournalSectorHeader_t)) == false)
+		{
+			return false;
+		}
+
+		if ((headers[i].magic == EEPROM_JOURNAL_MAGIC) &&
+				((firstSector == -1) || (headers[i].sequence < headers[firstSector].sequence)))
+		{
+			firstSector = i;
+		}
+	}
+
+	if (firstSector == -1)
+	{
+		// Blank (or foreign) journal area
+		if (eepromJournalStartSector(0, 0) == false)
+		{
+			return false;
+		}
+	}
+	else
+	{
+		uint8_t sector = firstSector;
+
+		journal.firstSector = firstSector;
+
+		// Sectors are chained by consecutive sequence numbers
+		while (true)
+		{
+			journal.currentSector = sector;
+			journal.sequence = headers[sector].sequence;
+			journal.writeOffset = eepromJournalReplaySector(sector);
+
+			uint8_t nextSector = EEPROM_JOURNAL_NEXT_SECTOR(sector);
+
+			if ((nextSector == journal.firstSector) ||
+					(headers[nextSector].magic != EEPROM_JOURNAL_MAGIC) || (headers[nextSector].sequence != (headers[sector].sequence + 1)))
+			{
+				break;
+			}
+
+			sector = nextSector;
+		}
+	}
+
+	journal.initialised = true;
+
+	return true;
+}
+
+// Folds the journal into the base image, needed before the base image is accessed directly (CPS).
+bool EEPROM_Sync(void)
+{
+	if (journal.initialised)
+	{
+		return eepromJournalFold();
+	}
+
+	return true;
+}
+
 bool EEPROM_Write(int address, uint8_t *buf, int size)
 {
-	return SPI_Flash_write(address + MDUV380_EMULATED_EEPROM_ADDRESS_OFFSET, buf, size);
+	if ((journal.initialised == false) || ((address + size) > EMULATED_EEPROM_SIZE) || (size >= EEPROM_JOURNAL_BYPASS_SIZE))
+	{
+		return (EEPROM_Sync() && SPI_Flash_write(address + MDUV380_EMULATED_EEPROM_ADDRESS_OFFSET, buf, size));
+	}
+
+	while (size > 0)
+	{
+		uint8_t current[EEPROM_JOURNAL_RECORD_MAX_DATA];
+		int len = SAFE_MIN(size, (int)EEPROM_JOURNAL_RECORD_MAX_DATA);
+
+		// Only record what has really changed
+		if ((EEPROM_Read(address, current, len) == false) || (memcmp(current, buf, len) != 0))
+		{
+			if (eepromJournalAppend(address, buf, len) == false)
+			{
+				return false;
+			}
+		}
+
+		address += len;
+		buf += len;
+		size -= len;
+	}
+
+	return true;
 }
 
 bool EEPROM_Read(int address, uint8_t *buf, int size)
 {
-	return SPI_Flash_read(address + MDUV380_EMULATED_EEPROM_ADDRESS_OFFSET, buf, size);
+	if (SPI_Flash_read(address + MDUV380_EMULATED_EEPROM_ADDRESS_OFFSET, buf, size) == false)
+	{
+		return false;
+	}
+
+	return ((journal.initialised == false) || eepromJournalOverlay(address, buf, size));
 }
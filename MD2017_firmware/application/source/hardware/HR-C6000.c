@@ -2290,7 +2290,7 @@ static void hrc6000Tick(void)
 				{
 					hrc.hotspotPostponedFrameHandling = (HS_NUM_OF_SILENCE_SEQ_ON_STARTUP * 6);
 					// LC and Frame data will be uplodaded in hrc6000TimeslotInterruptHandler(), DMR_STATE_TX_2 case.
-					memcpy((uint8_t *)deferredUpdateBuffer, (uint8_t *)&audioAndHotspotDataBuffer.hotspotBuffer[wavbuffer_read_idx], AMBE_AUDIO_LENGTH + LC_DATA_LENGTH);
+					hotspotGetTxFrame((uint8_t *)deferredUpdateBuffer, false);
 					// Note:
 					//       We don't increment the buffer indexes, because this is also the first frame of audio and we need
 					// it later, and LC data are needed for the silent frames
@@ -2446,13 +2446,9 @@ static void hrc6000Tick(void)
 			// normal operation. Not waking the repeater
 			if (settingsUsbMode == USB_MODE_HOTSPOT)
 			{
-				if ((hrc.hotspotPostponedFrameHandling == 0) && (hrc.hotspotDMRTxFrameBufferEmpty == true) && (wavbuffer_count > 0))
+				if ((hrc.hotspotPostponedFrameHandling == 0) && (hrc.hotspotDMRTxFrameBufferEmpty == true) &&
+						hotspotGetTxFrame((uint8_t *)deferredUpdateBuffer, true))
 				{
-					memcpy((uint8_t *)deferredUpdateBuffer, (uint8_t *)&audioAndHotspotDataBuffer.hotspotBuffer[wavbuffer_read_idx], AMBE_AUDIO_LENGTH + LC_DATA_LENGTH);
-
-					wavbuffer_read_idx = ((wavbuffer_read_idx + 1) % HOTSPOT_BUFFER_COUNT);
-
-					wavbuffer_count--;
 					hrc.hotspotDMRTxFrameBufferEmpty = false;
 				}
 			}
@@ -2461,7 +2457,7 @@ static void hrc6000Tick(void)
 				// Once there are 2 buffers available they can be encoded into one AMBE block
 				// The will happen  prior to the data being needed in the TS ISR, so that by the time tick_codec_encode encodes complete,
 				// the data is ready to be used in the TS ISR
-				if (wavbuffer_count >= 2)
+				if (ringBufferCount(&wavbufferRing) >= 2)
 				{
 					codecEncodeBlock((uint8_t *)hrc.deferredUpdateBufferInPtr);
 
@@ -2542,7 +2538,7 @@ static void hrc6000Tick(void)
 				// voice prompts take priority over incoming DMR audio
 				if ((voicePromptsIsPlaying() == false) && (soundMelodyIsPlaying() == false))
 				{
-					if ((WAV_BUFFER_COUNT - wavbuffer_count) < 3) // If we're running low on audio decoding storage
+					if (ringBufferFree(&wavbufferRing) < 3) // If we're running low on audio decoding storage
 					{
 						hrc.bufferLimitReachedCount = 6; // cancels decoding of the next 6 buffers.
 					}
@@ -38,6 +38,7 @@
 #include "functions/settings.h"
 #include "user_interface/uiLocalisation.h"
 #include "user_interface/menuSystem.h"
+#include "io/keyboard.h"
 #include "utils.h"
 #include "stm32f4xx_hal.h"
 
@@ -67,6 +68,23 @@ static uint16_t backgroundColour = 0xFFFFU;
 
 static uint16_t screenBufData[DISPLAY_SIZE_X * DISPLAY_SIZE_Y];
 uint16_t *screenBuf = screenBufData;
+
+// Bounding box of the screenBuf area modified since the last render, x1 and y1 excluded.
+// Empty when x0 >= x1.
+static struct
+{
+	int16_t x0;
+	int16_t y0;
+	int16_t x1;
+	int16_t y1;
+} dirtyRegion = { 0, 0, DISPLAY_SIZE_X, DISPLAY_SIZE_Y };
+
+// Two adjacent pixels, written with a single store
+typedef uint32_t __attribute__((__may_alias__)) displayPixelPair_t;
+
+#if defined(DISPLAY_BENCHMARK)
+static displayFillStatistics_t displayFillStatistics;
+#endif
 //#define DISPLAY_CHECK_BOUNDS
 
 #ifdef DISPLAY_CHECK_BOUNDS
@@ -78,6 +96,99 @@ DayTime_t themeDaytime = DAY;
 uint16_t themeItems[NIGHT + 1][THEME_ITEM_MAX]; // Theme storage
 #endif
 
+static void displayMarkDirty(int16_t x, int16_t y, int16_t width, int16_t height)
+{
+	int16_t x1 = SAFE_MIN((x + width), DISPLAY_SIZE_X);
+	int16_t y1 = SAFE_MIN((y + height), DISPLAY_SIZE_Y);
+
+	x = SAFE_MAX(x, 0);
+	y = SAFE_MAX(y, 0);
+
+	if ((x >= x1) || (y >= y1))
+	{
+		return;
+	}
+
+	if (dirtyRegion.x0 >= dirtyRegion.x1)
+	{
+		dirtyRegion.x0 = x;
+		dirtyRegion.y0 = y;
+		dirtyRegion.x1 = x1;
+		dirtyRegion.y1 = y1;
+	}
+	else
+	{
+		dirtyRegion.x0 = SAFE_MIN(dirtyRegion.x0, x);
+		dirtyRegion.y0 = SAFE_MIN(dirtyRegion.y0, y);
+		dirtyRegion.x1 = SAFE_MAX(dirtyRegion.x1, x1);
+		dirtyRegion.y1 = SAFE_MAX(dirtyRegion.y1, y1);
+	}
+}
+
+// The whole buffer may have been changed (or swapped) outside of the drawing functions
+static void displayMarkAllDirty(void)
+{
+	dirtyRegion.x0 = 0;
+	dirtyRegion.y0 = 0;
+	dirtyRegion.x1 = DISPLAY_SIZE_X;
+	dirtyRegion.y1 = DISPLAY_SIZE_Y;
+}
+
+// Sets count pixels from dest, using word stores for all but the unaligned first and last pixels.
+// The DMA is not used here, as its stream is owned by the display transfer, and the CPU can't draw over the
+// filled area before the fill has completed anyway.
+static void displayFillPixels(uint16_t *dest, int32_t count, uint16_t colour)
+{
+#if defined(DISPLAY_BENCHMARK)
+	uint32_t startCycles = DWT->CYCCNT;
+#endif
+
+	if (count <= 0)
+	{
+		return;
+	}
+
+#if defined(DISPLAY_BENCHMARK)
+	displayFillStatistics.fills++;
+	displayFillStatistics.pixels += count;
+#endif
+
+	if (((uintptr_t)dest) & 0x03)
+	{
+		*dest++ = colour;
+		count--;
+	}
+
+	uint32_t colourPair = (((uint32_t)colour << 16) | colour);
+	displayPixelPair_t *pairs = (displayPixelPair_t *)dest;
+	int32_t numPairs = (count >> 1);
+
+	while (numPairs >= 4)
+	{
+		pairs[0] = colourPair;
+		pairs[1] = colourPair;
+		pairs[2] = colourPair;
+		pairs[3] = colourPair;
+		pairs += 4;
+		numPairs -= 4;
+	}
+
+	while (numPairs > 0)
+	{
+		*pairs++ = colourPair;
+		numPairs--;
+	}
+
+	if (count & 0x01)
+	{
+		*((uint16_t *)pairs) = colour;
+	}
+
+#if defined(DISPLAY_BENCHMARK)
+	displayFillStatistics.cycles += (DWT->CYCCNT - startCycles);
+#endif
+}
+
 int16_t displaySetPixel(int16_t x, int16_t y, bool isInverted)
 {
 	int16_t i = (y * DISPLAY_SIZE_X) + x;
@@ -88,6 +199,8 @@ int16_t displaySetPixel(int16_t x, int16_t y, bool isInverted)
 	}
 
 	screenBuf[i] = isInverted ? foregroundColour : backgroundColour;
+	// x may be out of the screen, and the pixel then lands on the previous or next line
+	displayMarkDirty((i % DISPLAY_SIZE_X), (i / DISPLAY_SIZE_X), 1, 1);
 
 	return 0;
 }
@@ -169,19 +282,105 @@ static uint8_t *getUncompressedChar(uint8_t *dest, uint8_t *currentFont, uint8_t
 }
 #endif
 
+#if ! defined(PLATFORM_GD77S)
+// Decoded glyphs are kept as one bit mask per pixel line (bit 0 is the leftmost column), so they don't have to be
+// decompressed (and transposed from the font column format) again each time the same character is printed.
+// The colour is applied by the blitter, hence it is not part of the cache key.
+#define DISPLAY_GLYPH_CACHE_SIZE  16 // Must be a power of 2
+#define DISPLAY_GLYPH_MAX_WIDTH   16
+#define DISPLAY_GLYPH_MAX_HEIGHT  32
+
+typedef struct
+{
+	uint16_t tag; // ((fontSize << 8) | charOffset) + 1, 0 when the entry is empty
+	uint16_t lines[DISPLAY_GLYPH_MAX_HEIGHT];
+} displayGlyph_t;
+
+static displayGlyph_t displayGlyphCache[DISPLAY_GLYPH_CACHE_SIZE];
+
+static const uint16_t *displayGetGlyph(const uint8_t *currentFont, ucFont_t fontSize, uint32_t charOffset)
+{
+	uint16_t tag = ((fontSize << 8) | charOffset) + 1;
+	displayGlyph_t *glyph = &displayGlyphCache[(charOffset + (fontSize * 5)) & (DISPLAY_GLYPH_CACHE_SIZE - 1)];
+
+	if (glyph->tag != tag)
+	{
+		uint8_t uncompressChar[64];
+		uint8_t *charData;
+		int16_t charWidthPixels = currentFont[4];
+		int16_t charHeightPixels = currentFont[5];
+
+		if (currentFont[0] & 0x01) // compressed font
+		{
+			charData = getUncompressedChar(&uncompressChar[0], (uint8_t *)currentFont, charOffset);
+		}
+		else
+		{
+			charData = (uint8_t *)&currentFont[8 + (charOffset * currentFont[7])];
+		}
+
+		memset(glyph->lines, 0, sizeof(glyph->lines));
+
+		// Fonts are stored as columns of 8 pixels high pages
+		for (int16_t y = 0; y < charHeightPixels; y += 8)
+		{
+			for (int16_t x = 0; x < charWidthPixels; x++)
+			{
+				uint8_t columnData = charData[x + ((y / 8) * charWidthPixels)];
+
+				for (int16_t r = 0; columnData != 0; r++, columnData >>= 1)
+				{
+					if (columnData & 0x01)
+					{
+						glyph->lines[y + r] |= (1U << x);
+					}
+				}
+			}
+		}
+
+		glyph->tag = tag;
+	}
+
+	return glyph->lines;
+}
+
+// Sets the pixels of a glyph line, using a single store for each pair of adjacent and aligned pixels.
+static inline void displayBlitGlyphLine(uint16_t *dest, uint32_t line, uint16_t colour, uint32_t colourPair)
+{
+	while (line)
+	{
+		if ((line & 0x01) == 0)
+		{
+			uint32_t skip = __builtin_ctz(line);
+
+			line >>= skip;
+			dest += skip;
+		}
+		else if (((line & 0x03) == 0x03) && ((((uintptr_t)dest) & 0x03) == 0))
+		{
+			*((displayPixelPair_t *)dest) = colourPair;
+			line >>= 2;
+			dest += 2;
+		}
+		else
+		{
+			*dest = colour;
+			line >>= 1;
+			dest++;
+		}
+	}
+}
+#endif
+
 int displayPrintCore(int16_t xPos, int16_t yPos, const char *szMsg, ucFont_t fontSize, ucTextAlign_t alignment, bool isInverted)
 {
 #if ! defined(PLATFORM_GD77S)
 	int16_t sLen;
-	uint8_t *currentCharData;
 	int16_t charWidthPixels;
 	int16_t charHeightPixels;
-	int16_t bytesPerChar;
 	int16_t startCode;
 	int16_t endCode;
 	uint8_t *currentFont;
-	bool fontIsCompressed = false;
-	uint8_t uncompressChar[64];
 
 	sLen = strlen(szMsg);
 
@@ -225,12 +424,10 @@ int displayPrintCore(int16_t xPos, int16_t yPos, const char *szMsg, ucFont_t fon
 			break;
 	}
 
-	fontIsCompressed	= (currentFont[0] & 0x01); // does the current font is compressed ?
 	startCode   		= currentFont[2];  // get first defined character
 	endCode 	  		= currentFont[3];  // get last defined character
 	charWidthPixels   	= currentFont[4];  // width in pixel of one char
 	charHeightPixels  	= currentFont[5];  // page count per char
-	bytesPerChar 		= currentFont[7];  // bytes per char
 
 	if ((charWidthPixels * sLen) + xPos > DISPLAY_SIZE_X)
 	{
@@ -255,6 +452,14 @@ int displayPrintCore(int16_t xPos, int16_t yPos, const char *szMsg, ucFont_t fon
 			break;
 	}
 
+	displayMarkDirty(xPos, yPos, (charWidthPixels * sLen), charHeightPixels);
+
+	uint16_t colour = (isInverted ? backgroundColour : foregroundColour);
+	uint32_t colourPair = (((uint32_t)colour << 16) | colour);
+	// Only the lines inside the screen are drawn
+	int16_t firstLine = SAFE_MAX(0, -yPos);
+	int16_t endLine = SAFE_MIN(charHeightPixels, (DISPLAY_SIZE_Y - yPos));
+
 	for (int16_t i = 0; i < sLen; i++)
 	{
 		// Skip space character as it's empty (and no more part of the fonts).
@@ -271,32 +476,13 @@ int displayPrintCore(int16_t xPos, int16_t yPos, const char *szMsg, ucFont_t fon
 			charOffset = ('?' - startCode); // Substitute unsupported ASCII code by a question mark
 		}
 
-		if (fontIsCompressed)
-		{
-			currentCharData = getUncompressedChar(&uncompressChar[0], currentFont, charOffset);
-		}
-		else
-		{
-			currentCharData = (uint8_t *)&currentFont[8 + (charOffset * bytesPerChar)];
-		}
-
-		uint32_t charPixelOffset = (i * charWidthPixels);
+		const uint16_t *glyphLines = displayGetGlyph(currentFont, fontSize, charOffset);
+		uint16_t *dest = &screenBuf[((yPos + firstLine) * DISPLAY_SIZE_X) + xPos + (i * charWidthPixels)];
 
-		for(int x = 0; x <  charWidthPixels; x++)
+		for (int16_t y = firstLine; y < endLine; y++)
 		{
-			int xp = x + xPos;
-
-			for(int y =  0; y < charHeightPixels; y++)
-			{
-				uint8_t rowData = currentCharData[x + ((y / 8) * charWidthPixels)];
-				int32_t bOffset = xp + ((yPos + y) * DISPLAY_SIZE_X) + charPixelOffset;
-
-				if ((rowData >> (y % 8) & 0x01) && (bOffset < (DISPLAY_SIZE_X * DISPLAY_SIZE_Y)))
-				{
-					screenBuf[xp + ((yPos + y) * DISPLAY_SIZE_X) + charPixelOffset] =  isInverted ? backgroundColour : foregroundColour;
-				}
-
-			}
+			displayBlitGlyphLine(dest, glyphLines[y], colour, colourPair);
+			dest += DISPLAY_SIZE_X;
 		}
 	}
 #endif // ! PLATFORM_GD77S
@@ -305,11 +491,9 @@ int displayPrintCore(int16_t xPos, int16_t yPos, const char *szMsg, ucFont_t fon
 
 void displayClearBuf(void)
 {
-	// may be able to do this using DMA
-	for(int i = 0; i < DISPLAY_SIZE_X * DISPLAY_SIZE_Y; i++)
-	{
-		screenBuf[i] = backgroundColour;
-	}
+	displayFillPixels(screenBuf, (DISPLAY_SIZE_X * DISPLAY_SIZE_Y), backgroundColour);
+
+	displayMarkAllDirty();
 }
 
 void displayClearRows(int16_t startRow, int16_t endRow, bool isInverted)
@@ -325,16 +509,12 @@ void displayClearRows(int16_t startRow, int16_t endRow, bool isInverted)
 		SAFE_SWAP(startRow, endRow);
 	}
 
+	displayMarkDirty(0, (startRow * 8), DISPLAY_SIZE_X, ((endRow - startRow) * 8));
+
 	startRow *= (8 * DISPLAY_SIZE_X);
 	endRow *= (8 * DISPLAY_SIZE_X);
 
-	uint16_t fillColour = (isInverted ? foregroundColour : backgroundColour);
-
-	for(int i = startRow; i < endRow; i++)
-	{
-		screenBuf[i] = fillColour;
-	}
-
+	displayFillPixels(&screenBuf[startRow], (endRow - startRow), (isInverted ? foregroundColour : backgroundColour));
 }
 
 void displayPrintCentered(uint16_t y, const char *text, ucFont_t fontSize)
@@ -1020,15 +1200,20 @@ void displayDrawRect(int16_t x, int16_t y, int16_t w, int16_t h, bool isInverted
  */
 void displayFillRect(int16_t x, int16_t y, int16_t width, int16_t height, bool isInverted)
 {
-	uint32_t lineStartOffset;
+	uint16_t fillColour = (isInverted ? backgroundColour : foregroundColour);
+
+	displayMarkDirty(x, y, width, height);
+
+	if (width == DISPLAY_SIZE_X)
+	{
+		// Full width lines are contiguous
+		displayFillPixels(&screenBuf[y * DISPLAY_SIZE_X], (width * height), fillColour);
+		return;
+	}
 
 	for(int yp = 0; yp < height; yp++)
 	{
-		lineStartOffset = (y + yp) * DISPLAY_SIZE_X;
-		for(int xp = 0; xp < width; xp++)
-		{
-			screenBuf[lineStartOffset + x + xp] = isInverted ? backgroundColour : foregroundColour;
-		}
+		displayFillPixels(&screenBuf[((y + yp) * DISPLAY_SIZE_X) + x], width, fillColour);
 	}
 }
 
@@ -1196,50 +1381,137 @@ void displayDrawChoice(ucChoice_t choice, bool clearRegion)
 	displayThemeResetToDefault();
 }
 
+// Direct accesses to the buffers aren't tracked, hence everything has to be sent on the next render
 uint16_t *displayGetScreenBuffer(void)
 {
+	displayMarkAllDirty();
 	return screenBuf;
 }
 
 void displayRestorePrimaryScreenBuffer(void)
 {
 	screenBuf = screenBufData;
+	displayMarkAllDirty();
 }
 
 uint16_t *displayGetPrimaryScreenBuffer(void)
 {
+	displayMarkAllDirty();
 	return &screenBufData[0];
 }
 
 void displayOverrideScreenBuffer(uint16_t *buffer)
 {
 	screenBuf = buffer;
+	displayMarkAllDirty();
 }
 
 static bool isAwake = true;
 
-#if 0
-static void dmaCompleteCallback(DMA_HandleTypeDef *hdma)
+// The dirty window is copied, band by band, into one of two small buffers, while the other one is being sent by DMA.
+// This lets the UI carry on drawing into screenBuf as soon as the render has been started, without the display
+// ever receiving a half drawn band, and also packs partial width windows so each band is sent in a single DMA transfer.
+#define DISPLAY_TRANSFER_BAND_SIZE (DISPLAY_SIZE_X * sizeof(uint16_t) * 8)
+
+static uint8_t displayTransferBands[2][DISPLAY_TRANSFER_BAND_SIZE] __attribute__((aligned(4)));// Must not be in the CCM RAM, as the DMA can't access it
+
+static struct
+{
+	volatile bool     busy;
+	const uint8_t    *source;         // Next screenBuf line, not copied into a band yet
+	int16_t           linesRemaining; // Number of lines not copied into a band yet
+	uint16_t          lineLength;     // In bytes
+	uint16_t          linesPerBand;
+	uint8_t           currentBand;    // Band being sent by the DMA
+	uint32_t          bandLength[2];  // 0 when there is nothing left to send
+} displayTransfer;
+
+static uint32_t displayTransferFillBand(uint8_t band)
+{
+	uint8_t *dest = displayTransferBands[band];
+	int16_t lines = SAFE_MIN(displayTransfer.linesRemaining, (int16_t)displayTransfer.linesPerBand);
+
+	for (int16_t l = 0; l < lines; l++)
+	{
+		memcpy(dest, displayTransfer.source, displayTransfer.lineLength);
+		dest += displayTransfer.lineLength;
+		displayTransfer.source += (DISPLAY_SIZE_X * sizeof(uint16_t));
+	}
+
+	displayTransfer.linesRemaining -= lines;
+
+	return (lines * displayTransfer.lineLength);
+}
+
+static void displayTransferEnd(void)
 {
 	HAL_GPIO_WritePin(LCD_CS_GPIO_Port, LCD_CS_Pin, GPIO_PIN_SET);
 
 	*((volatile uint8_t*) LCD_FSMC_ADDR_DATA) = 0;// write 0 to the display pins , to pull them all low, so keyboard reads don't need to
+
+	displayTransfer.busy = false;
+	keyboardScanResume();
 }
-#endif
 
+static bool displayTransferStartBand(uint8_t band)
+{
+	displayTransfer.currentBand = band;
 
-void displayRenderRows(int16_t startRow, int16_t endRow)
+	if (HAL_DMA_Start_IT(&hdma_memtomem_dma2_stream0, (uint32_t)displayTransferBands[band], LCD_FSMC_ADDR_DATA, displayTransfer.bandLength[band]) != HAL_OK)
+	{
+		displayTransferEnd();
+		return false;
+	}
+
+	return true;
+}
+
+// Called from the DMA2_Stream0 ISR
+static void displayTransferCompleteCallback(DMA_HandleTypeDef *hdma)
 {
-    if (settingsUsbModeDebugHaltRenderingKeypad)
-    {
-    	return;
-    }
+	uint8_t sentBand = displayTransfer.currentBand;
+	uint8_t nextBand = (sentBand ^ 1);
 
+	if (displayTransfer.bandLength[nextBand] > 0)
+	{
+		if (displayTransferStartBand(nextBand))
+		{
+			// Prepare the following band while the next one is on its way
+			displayTransfer.bandLength[sentBand] = displayTransferFillBand(sentBand);
+		}
+	}
+	else
+	{
+		displayTransferEnd();
+	}
+}
+
+static void displayTransferErrorCallback(DMA_HandleTypeDef *hdma)
+{
+	displayTransferEnd();
+}
+
+bool displayIsTransferring(void)
+{
+	return displayTransfer.busy;
+}
+
+void displayWaitForTransfer(void)
+{
+	while (displayTransfer.busy)
+	{
+		// A full screen only takes a few ms to be sent, no need to give the CPU back to the RTOS
+	}
+}
+
+// Starts sending the screenBuf window (x0, y0)..(x1, y1), x1 and y1 excluded, to the display.
+// CS is released, and the pins handed back to the keypad, by the DMA complete ISR.
+static void displayTransferWindow(int16_t x0, int16_t y0, int16_t x1, int16_t y1)
+{
 	GPIO_InitTypeDef GPIO_InitStruct = {0};
 
-	// GD77 display controller has 8 lines per row.
-	startRow *= 8;
-	endRow *= 8;
+	displayWaitForTransfer();
+	keyboardScanSuspend();
 
 	// Display shares its pins with the keypad, so the pind need to be put into alternate mode to work with the FSMC
 	GPIO_InitStruct.Mode = GPIO_MODE_AF_PP;
@@ -1255,39 +1527,72 @@ void displayRenderRows(int16_t startRow, int16_t endRow)
 
 	HAL_GPIO_WritePin(LCD_CS_GPIO_Port, LCD_CS_Pin, GPIO_PIN_RESET);
 
-	// Set start and end rows of the transfer
+	// Set start and end (included) columns and rows of the transfer
+	{
+		uint8_t opts[] = { 0x00, x0, 0x00, (x1 - 1) };
+		displayWriteCmds(HX8583_CMD_CASET, sizeof(opts), opts);
+	}
+
 	{
-		uint8_t opts[] = { 0x00, startRow, 0x00, endRow };
+		uint8_t opts[] = { 0x00, y0, 0x00, (y1 - 1) };
 		displayWriteCmds(HX8583_CMD_RASET, sizeof(opts), opts);
 	}
 
 	displayWriteCmd(HX8583_CMD_RAMWR);
 
-	uint8_t *framePtr = (uint8_t *)screenBuf + (DISPLAY_SIZE_X * startRow * sizeof(uint16_t));
+	displayTransfer.source = (uint8_t *)screenBuf + (((DISPLAY_SIZE_X * y0) + x0) * sizeof(uint16_t));
+	displayTransfer.linesRemaining = (y1 - y0);
+	displayTransfer.lineLength = (x1 - x0) * sizeof(uint16_t);
+	displayTransfer.linesPerBand = DISPLAY_TRANSFER_BAND_SIZE / displayTransfer.lineLength;
+	displayTransfer.bandLength[0] = displayTransferFillBand(0);
+	displayTransfer.bandLength[1] = displayTransferFillBand(1);
+
+	hdma_memtomem_dma2_stream0.XferCpltCallback = displayTransferCompleteCallback;
+	hdma_memtomem_dma2_stream0.XferErrorCallback = displayTransferErrorCallback;
+
+	// From now on, only the DMA complete ISR touches the transfer state
+	displayTransfer.busy = true;
+	displayTransferStartBand(0);
+}
+
+// Only the part of the rows that changed since it was last rendered is sent to the display.
+void displayRenderRows(int16_t startRow, int16_t endRow)
+{
+    if (settingsUsbModeDebugHaltRenderingKeypad)
+    {
+    	return;
+    }
+
+	// GD77 display controller has 8 lines per row.
+	int16_t y0 = SAFE_MAX((startRow * 8), dirtyRegion.y0);
+	int16_t y1 = SAFE_MIN((endRow * 8), dirtyRegion.y1);
 
-	//if (HAL_DMA_RegisterCallback(&hdma_memtomem_dma2_stream0, HAL_DMA_XFER_CPLT_CB_ID, dmaCompleteCallback)== HAL_OK)
+	if ((dirtyRegion.x0 >= dirtyRegion.x1) || (y0 >= y1))
 	{
-		HAL_StatusTypeDef status = HAL_DMA_Start(&hdma_memtomem_dma2_stream0, (uint32_t)framePtr, LCD_FSMC_ADDR_DATA, (endRow - startRow) * DISPLAY_SIZE_X * sizeof(uint16_t));
-		if (status == HAL_OK)
-		{
-			HAL_DMA_PollForTransfer(&hdma_memtomem_dma2_stream0, HAL_DMA_FULL_TRANSFER, HAL_MAX_DELAY);
-			// need to wait for completion otherwise we CS gets disabled immediately.
-			// This could be done using a transfer complete callback
-		}
+		return;// Nothing changed in these rows, no need to steal the pins from the keypad.
 	}
 
+	int16_t x0 = dirtyRegion.x0;
+	int16_t x1 = dirtyRegion.x1;
 
-#if false
-	// fallback
-	for(int y = 0; y < (endRow - startRow) * DISPLAY_SIZE_X * sizeof(uint16_t); y++)
+	// Shrink the dirty region, when the rendered rows are at its top or bottom.
+	// This is done before the transfer starts, as the UI could draw again before it completes.
+	if (y0 == dirtyRegion.y0)
 	{
-		*((volatile uint8_t*) LCD_FSMC_ADDR_DATA) = *framePtr++;
+		dirtyRegion.y0 = y1;
+	}
+	else if (y1 == dirtyRegion.y1)
+	{
+		dirtyRegion.y1 = y0;
 	}
-#endif
 
-	HAL_GPIO_WritePin(LCD_CS_GPIO_Port, LCD_CS_Pin, GPIO_PIN_SET);
+	if (dirtyRegion.y0 >= dirtyRegion.y1)
+	{
+		dirtyRegion.x0 = dirtyRegion.x1 = 0;
+		dirtyRegion.y0 = dirtyRegion.y1 = 0;
+	}
 
-	*((volatile uint8_t*) LCD_FSMC_ADDR_DATA) = 0;// write 0 to the display pins , to pull them all low, so keyboard reads don't need to
+	displayTransferWindow(x0, y0, x1, y1);
 }
 
 void displaySetInverseVideo(bool isInverted)
@@ -1319,6 +1624,21 @@ void displaySetDisplayPowerMode(bool wake)
 	isAwake = wake;
 }
 
+#if defined(DISPLAY_BENCHMARK)
+void displayGetFillStatistics(displayFillStatistics_t *statistics)
+{
+	*statistics = displayFillStatistics;
+}
+
+void displayResetFillStatistics(void)
+{
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	memset(&displayFillStatistics, 0, sizeof(displayFillStatistics));
+}
+#endif
+
 void displayConvertGD77ImageData(uint8_t *dataBuf)
 {
 	const uint32_t startOffset = (32 * DISPLAY_SIZE_X) + (DISPLAY_SIZE_X - 128) / 2;
@@ -1335,6 +1655,8 @@ void displayConvertGD77ImageData(uint8_t *dataBuf)
 		}
 	}
 
+	displayMarkAllDirty();
+
 	// clear beginning of display buff used to store the image read from flash
 	for(int i = 0; i < (128 * 64 / 8 / 2); i++)
 	{
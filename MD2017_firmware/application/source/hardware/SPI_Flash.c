@@ -29,8 +29,67 @@
 #include "interfaces/gpio.h"
 #include <string.h>
 #include "main.h"
+#include "utils.h"
+#include "functions/ticks.h"
+
+typedef enum
+{
+	SPI_FLASH_REQUEST_READ = 0,    // Command (opcode, address, dummy bytes) followed by a data read
+	SPI_FLASH_REQUEST_PROGRAM,     // Split on page boundaries, no erase
+	SPI_FLASH_REQUEST_ERASE_SECTOR
+} spiFlashRequestType_t;
+
+typedef struct
+{
+	spiFlashRequestType_t      type;
+	uint8_t                    command[5];
+	uint8_t                    commandLength;
+	uint32_t                   address;
+	uint8_t                   *dataBuf;
+	int                        size;
+	spiFlashRequestCallback_t  callback;
+	void                      *userData;
+} spiFlashRequest_t;
+
+typedef enum
+{
+	SPI_FLASH_START_FAILED = 0,
+	SPI_FLASH_START_PENDING,       // Completion will be handled by the engine task, once notified
+	SPI_FLASH_START_DONE           // Completed immediately (polled transfer)
+} spiFlashStartResult_t;
+
+typedef struct
+{
+	uint32_t  sectorAddress;
+	bool      valid;
+	bool      dirty;
+	uint32_t  lastAccess;     // Used for flush delay and LRU eviction
+	uint8_t  *buffer;
+} spiFlashCachedSector_t;
 
 // private functions
+static bool spi_flash_runRequest(spiFlashRequest_t *request);
+static bool spi_flash_queueRequest(const spiFlashRequest_t *request);
+static void spi_flash_startNextRequest(void);
+static spiFlashStartResult_t spi_flash_startRequest(spiFlashRequest_t *request);
+static spiFlashStartResult_t spi_flash_startProgramChunk(spiFlashRequest_t *request);
+static void spi_flash_finishRequest(bool success);
+static void spi_flash_completeRequest(bool success);
+static void spi_flash_pollDevice(void);
+static void spi_flash_notifyEngine(void);
+static void spi_flash_engineTaskFunction(void *argument);
+static bool spi_flash_canUseDMA(uint8_t *dataBuf, int size);
+static bool spi_flash_readRaw(uint32_t addr, uint8_t *dataBuf, int size);
+static void spi_flash_setReadRequest(spiFlashRequest_t *request, uint32_t addr, uint8_t *dataBuf, int size);
+static void spi_flash_setHighSpeedClock(bool highSpeed);
+static void spi_flash_cacheOverlay(uint32_t addr, uint8_t *dataBuf, int size);
+static void spi_flash_readAheadCallback(bool success, void *userData);
+static void spi_flash_readAheadFetch(spiFlashReadAhead_t *readAhead, int block, uint32_t address);
+static spiFlashCachedSector_t *spi_flash_cacheFind(uint32_t sectorAddress);
+static spiFlashCachedSector_t *spi_flash_cacheAllocate(uint32_t sectorAddress, bool loadFromFlash);
+static bool spi_flash_cacheFlush(spiFlashCachedSector_t *cachedSector);
+static bool spi_flash_cacheInvalidate(uint32_t addr, int size, bool flushDirty);
+static void spi_flash_muxPinOverride(bool enable);
 static bool spi_flash_busy(void);
 
 static void spi_flash_setWriteEnable(bool cmd);
@@ -80,6 +139,67 @@ __attribute__((section(".ccmram"))) uint8_t SPI_Flash_sectorbuffer[4096];
 
 #define WINBOND_MANUF   0xef
 
+#define SPI_FLASH_REQUEST_QUEUE_SIZE       8
+#define SPI_FLASH_DMA_MIN_TRANSFER_SIZE    16  // Below that, the DMA setup costs more than a polled transfer
+#define SPI_FLASH_PROGRAM_TIMEOUT_MS       5   // Worst case is something like 3mS
+#define SPI_FLASH_ERASE_TIMEOUT_MS         500 // erase can take up to 500 mS
+#define SPI_FLASH_CCMRAM_START             0x10000000
+#define SPI_FLASH_CCMRAM_END               0x10010000 // CCM RAM is not reachable by the DMA controllers
+
+#define SPI_FLASH_SECTOR_SIZE              4096
+#define SPI_FLASH_WRITE_CACHE_NUM_SECTORS  2
+#define SPI_FLASH_WRITE_CACHE_FLUSH_DELAY  1000 // mS since the last write to a sector, before it gets written back
+#define SPI_FLASH_COMPARE_CHUNK_SIZE       128
+
+// SPI1 is clocked from APB2 (72MHz), /2 gives 36MHz, within the 50MHz limit of READ_DATA and the 104MHz of FAST_READ.
+#define SPI_FLASH_HIGH_SPEED_PRESCALER     SPI_BAUDRATEPRESCALER_2
+#define SPI_FLASH_READ_MODE_CHECK_ADDRESS  0x20000 // Start of the codeplug
+#define SPI_FLASH_READ_MODE_CHECK_SIZE     64
+
+typedef enum
+{
+	SPI_FLASH_ENGINE_IDLE = 0,
+	SPI_FLASH_ENGINE_STARTING,     // A request is waiting to be set up by the engine task
+	SPI_FLASH_ENGINE_TRANSFER,     // DMA transfer in progress, ended by the SPI DMA interrupt
+	SPI_FLASH_ENGINE_TRANSFER_END, // DMA transfer has ended, the engine task completes the request
+	SPI_FLASH_ENGINE_WAIT_DEVICE   // Program/erase in progress, busy flag polled every 1ms by the engine task
+} spiFlashEngineState_t;
+
+typedef struct
+{
+	spiFlashRequest_t                queue[SPI_FLASH_REQUEST_QUEUE_SIZE];
+	volatile uint8_t                 head;
+	volatile uint8_t                 count;
+	volatile spiFlashEngineState_t   state;
+	volatile int                     waitCounter;
+	int                              offset;       // Progress of the current program request
+	int                              chunkLength;  // Length of the page chunk being programmed
+	volatile bool                    transferSuccess;
+	bool                             restoreMuxPin;
+	TaskHandle_t                     taskHandle;
+} spiFlashEngine_t;
+
+typedef struct
+{
+	volatile bool done;
+	volatile bool success;
+	TaskHandle_t  waitingTask;
+} spiFlashSyncResult_t;
+
+static spiFlashEngine_t spiFlashEngine;
+static spiFlashReadMode_t spiFlashReadMode = SPI_FLASH_READ_MODE_NORMAL;
+#if defined(SPI_FLASH_BENCHMARK)
+static spiFlashStatistics_t spiFlashStatistics;
+#endif
+
+// Write back cache, in main RAM so the sectors can be written using DMA
+static uint8_t spiFlashWriteCacheBuffers[SPI_FLASH_WRITE_CACHE_NUM_SECTORS][SPI_FLASH_SECTOR_SIZE];
+static spiFlashCachedSector_t spiFlashWriteCache[SPI_FLASH_WRITE_CACHE_NUM_SECTORS];
+
+// The engine task is statically allocated, as all the Flash accesses would block forever if it couldn't be created
+#define SPI_FLASH_TASK_STACK_SIZE  (1000L / sizeof(StackType_t))
+static StackType_t spiFlashTaskStack[SPI_FLASH_TASK_STACK_SIZE];
+static StaticTask_t spiFlashTaskBuffer;
 
 uint32_t flashChipPartNumber;
 
@@ -87,225 +207,1011 @@ bool SPI_Flash_init(void)
 {
 	HAL_GPIO_WritePin(SPI_Flash_CS_GPIO_Port, SPI_Flash_CS_Pin, GPIO_PIN_SET); // Disable
 
+	// All the requests are run by this task, so neither the polled transfers, the busy polling nor the
+	// completion callbacks ever run in interrupt context.
+	spiFlashEngine.taskHandle = xTaskCreateStatic(spi_flash_engineTaskFunction,    /* pointer to the task */
+			"spiFlashTask",                      /* task name for kernel awareness debugging */
+			SPI_FLASH_TASK_STACK_SIZE,           /* task stack size */
+			NULL,                                /* optional task startup argument */
+			(UBaseType_t)osPriorityHigh,         /* initial priority */
+			spiFlashTaskStack,                   /* task stack */
+			&spiFlashTaskBuffer                  /* task control block */
+	);
+
+    for (int i = 0; i < SPI_FLASH_WRITE_CACHE_NUM_SECTORS; i++)
+    {
+    	spiFlashWriteCache[i].valid = false;
+    	spiFlashWriteCache[i].dirty = false;
+    	spiFlashWriteCache[i].buffer = spiFlashWriteCacheBuffers[i];
+    }
+
     flashChipPartNumber = SPI_Flash_readPartID();
 
     // 4014 25Q80 8M bits 1M bytes, used in the GD-77
     // 4015 25Q16 16M bits 2M bytes, used in the Baofeng DM-1801 ?
     // 4017 25Q64 64M bits. Used in Roger's special GD-77 radios modified on the TYT production line
     // 4018 25Q128 128M bits. MD9600 / MDUV380 / MD380 etc
-    return (flashChipPartNumber == 0x4018);
+    if (flashChipPartNumber != 0x4018)
+    {
+    	return false;
+    }
+
+    // Switch to the fast read mode, only if it reads back the same ID and data as the normal one.
+    uint8_t normalData[SPI_FLASH_READ_MODE_CHECK_SIZE];
+    uint8_t fastData[SPI_FLASH_READ_MODE_CHECK_SIZE];
+
+    spi_flash_readRaw(SPI_FLASH_READ_MODE_CHECK_ADDRESS, normalData, SPI_FLASH_READ_MODE_CHECK_SIZE);
+    SPI_Flash_setReadMode(SPI_FLASH_READ_MODE_FAST);
+    spi_flash_readRaw(SPI_FLASH_READ_MODE_CHECK_ADDRESS, fastData, SPI_FLASH_READ_MODE_CHECK_SIZE);
+
+    if ((SPI_Flash_readPartID() != flashChipPartNumber) || (memcmp(normalData, fastData, SPI_FLASH_READ_MODE_CHECK_SIZE) != 0))
+    {
+    	SPI_Flash_setReadMode(SPI_FLASH_READ_MODE_NORMAL);
+    }
+
+    return true;
+}
+
+void SPI_Flash_setReadMode(spiFlashReadMode_t mode)
+{
+	spiFlashReadMode = mode;
+}
+
+spiFlashReadMode_t SPI_Flash_getReadMode(void)
+{
+	return spiFlashReadMode;
 }
 
 // Returns false for failed
 // Note. There is no error checking that the device is not initially busy.
+// Sectors held by the write cache are served (or overlaid) from RAM.
 bool SPI_Flash_read(uint32_t addr, uint8_t *dataBuf, int size)
 {
-  uint8_t commandBuf[4]= { READ_DATA, addr >> 16, addr >> 8, addr };// command
+	uint32_t sectorAddress = (addr & ~(SPI_FLASH_SECTOR_SIZE - 1));
+	spiFlashCachedSector_t *cachedSector = spi_flash_cacheFind(sectorAddress);
+
+	if ((cachedSector != NULL) && ((addr + size) <= (sectorAddress + SPI_FLASH_SECTOR_SIZE)))
+	{
+		memcpy(dataBuf, cachedSector->buffer + (addr - sectorAddress), size);
+		return true;
+	}
+
+	if (spi_flash_readRaw(addr, dataBuf, size) == false)
+	{
+		return false;
+	}
+
+	spi_flash_cacheOverlay(addr, dataBuf, size);
+
+	return true;
+}
+
+bool SPI_Flash_readAsync(uint32_t addr, uint8_t *dataBuf, int size, spiFlashRequestCallback_t callback, void *userData)
+{
+	spiFlashRequest_t request;
 
-  spi_flash_enable();
-  HAL_SPI_Transmit(&HANDLE_SPI, commandBuf, 4, HAL_MAX_DELAY);
-  HAL_SPI_Receive(&HANDLE_SPI, dataBuf, size, HAL_MAX_DELAY);
-  spi_flash_disable();
+	spi_flash_setReadRequest(&request, addr, dataBuf, size);
+	request.callback = callback;
+	request.userData = userData;
 
-  return true;
+	return spi_flash_queueRequest(&request);
 }
 
-bool SPI_Flash_write(uint32_t addr, uint8_t *dataBuf, int size)
+// Sequential reader, the next block is prefetched in the background while the current one is consumed.
+void SPI_Flash_readAheadInit(spiFlashReadAhead_t *readAhead, uint32_t address)
 {
-	bool retVal = true;
-	int flashWritePos = addr;
-	int flashSector;
-	int flashEndSector;
-	int bytesToWriteInCurrentSector = size;
+	readAhead->blockAddress[0] = readAhead->blockAddress[1] = 0xFFFFFFFF;
+	readAhead->blockState[0] = readAhead->blockState[1] = SPI_FLASH_READ_AHEAD_BLOCK_EMPTY;
 
-	flashSector	= flashWritePos / 4096;
-	flashEndSector = (flashWritePos + size) / 4096;
+	spi_flash_readAheadFetch(readAhead, 0, (address & ~(SPI_FLASH_READ_AHEAD_BLOCK_SIZE - 1)));
+}
+
+bool SPI_Flash_readAheadRead(spiFlashReadAhead_t *readAhead, uint32_t address, uint8_t *dataBuf, int size)
+{
+	uint32_t addr = address;
+	uint8_t *buf = dataBuf;
+	int remaining = size;
 
-	if (flashSector != flashEndSector)
+	while (remaining > 0)
 	{
-		bytesToWriteInCurrentSector = (flashEndSector * 4096) - flashWritePos;
+		uint32_t blockAddress = (addr & ~(SPI_FLASH_READ_AHEAD_BLOCK_SIZE - 1));
+		int block;
+
+		if (readAhead->blockAddress[0] == blockAddress)
+		{
+			block = 0;
+		}
+		else if (readAhead->blockAddress[1] == blockAddress)
+		{
+			block = 1;
+		}
+		else
+		{
+			// Not sequential, restart from there
+			block = ((readAhead->blockState[0] == SPI_FLASH_READ_AHEAD_BLOCK_PENDING) ? 1 : 0);
+
+			while (readAhead->blockState[block] == SPI_FLASH_READ_AHEAD_BLOCK_PENDING)
+			{
+				osDelay(1);
+			}
+
+			spi_flash_readAheadFetch(readAhead, block, blockAddress);
+		}
+
+		// Start prefetching the following block in the other buffer
+		if ((readAhead->blockAddress[block ^ 1] != (blockAddress + SPI_FLASH_READ_AHEAD_BLOCK_SIZE)) &&
+				(readAhead->blockState[block ^ 1] != SPI_FLASH_READ_AHEAD_BLOCK_PENDING))
+		{
+			spi_flash_readAheadFetch(readAhead, (block ^ 1), (blockAddress + SPI_FLASH_READ_AHEAD_BLOCK_SIZE));
+		}
+
+		while (readAhead->blockState[block] == SPI_FLASH_READ_AHEAD_BLOCK_PENDING)
+		{
+			// Spin only while the transfer runs, the engine could be waiting on a program or erase
+			if (SPI_Flash_isTransferring() == false)
+			{
+				osDelay(1);
+			}
+		}
+
+		if (readAhead->blockState[block] != SPI_FLASH_READ_AHEAD_BLOCK_READY)
+		{
+			return false;
+		}
+
+		int len = SAFE_MIN(remaining, (int)(SPI_FLASH_READ_AHEAD_BLOCK_SIZE - (addr - blockAddress)));
+
+		memcpy(buf, &readAhead->block[block][addr - blockAddress], len);
+
+		addr += len;
+		buf += len;
+		remaining -= len;
 	}
 
-	if (bytesToWriteInCurrentSector != 4096)
+	// Asynchronous reads bypass the write cache
+	spi_flash_cacheOverlay(address, dataBuf, size);
+
+	return true;
+}
+
+// Waits for the pending prefetch, as the read ahead buffers are going out of scope.
+void SPI_Flash_readAheadEnd(spiFlashReadAhead_t *readAhead)
+{
+	while ((readAhead->blockState[0] == SPI_FLASH_READ_AHEAD_BLOCK_PENDING) || (readAhead->blockState[1] == SPI_FLASH_READ_AHEAD_BLOCK_PENDING))
 	{
-		SPI_Flash_read(flashSector * 4096, SPI_Flash_sectorbuffer, 4096);
+		osDelay(1);
 	}
-	uint8_t *writePos = SPI_Flash_sectorbuffer + flashWritePos - (flashSector * 4096);
-	memcpy(writePos, dataBuf, bytesToWriteInCurrentSector);
+}
+
+#if defined(SPI_FLASH_BENCHMARK)
+// Reads the given amount of data, in the specified mode, and returns the throughput in bytes per second.
+uint32_t SPI_Flash_benchmarkReadMode(spiFlashReadMode_t mode, uint32_t address, int size)
+{
+	uint8_t buf[SPI_FLASH_READ_AHEAD_BLOCK_SIZE];
+	spiFlashReadMode_t previousMode = spiFlashReadMode;
+	uint32_t startCycles;
+	uint32_t elapsedCycles;
+
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
 
-	retVal = SPI_Flash_eraseSector(flashSector * 4096);
-	if (!retVal)
+	SPI_Flash_setReadMode(mode);
+
+	startCycles = DWT->CYCCNT;
+	for (int offset = 0; offset < size; offset += SPI_FLASH_READ_AHEAD_BLOCK_SIZE)
 	{
-		return false;
+		spi_flash_readRaw(address + offset, buf, SAFE_MIN((size - offset), (int)SPI_FLASH_READ_AHEAD_BLOCK_SIZE));
 	}
+	elapsedCycles = DWT->CYCCNT - startCycles;
+
+	SPI_Flash_setReadMode(previousMode);
 
-	for (int i = 0; i < 16; i++)
+	if (elapsedCycles == 0)
 	{
-		retVal = SPI_Flash_writePage(flashSector * 4096 + i * 256, SPI_Flash_sectorbuffer + i * 256);
-		if (!retVal)
-		{
-			return false;
-		}
+		return 0;
 	}
 
-	if (flashSector != flashEndSector)
-	{
-		uint8_t *bufPusOffset = (uint8_t *) dataBuf + bytesToWriteInCurrentSector;
-		bytesToWriteInCurrentSector = size - bytesToWriteInCurrentSector;
+	return (uint32_t)(((uint64_t)size * SystemCoreClock) / elapsedCycles);
+}
+
+void SPI_Flash_getStatistics(spiFlashStatistics_t *statistics)
+{
+	uint32_t primask = __get_PRIMASK();
 
-		SPI_Flash_read(flashEndSector * 4096, SPI_Flash_sectorbuffer, 4096);
-		memcpy(SPI_Flash_sectorbuffer, (uint8_t *) bufPusOffset, bytesToWriteInCurrentSector);
+	__disable_irq();
+	memcpy(statistics, &spiFlashStatistics, sizeof(spiFlashStatistics_t));
+	__set_PRIMASK(primask);
+}
 
-		retVal = SPI_Flash_eraseSector(flashEndSector * 4096);
+void SPI_Flash_resetStatistics(void)
+{
+	uint32_t primask = __get_PRIMASK();
 
-		if (!retVal)
-		{
-			return false;
-		}
+	__disable_irq();
+	memset(&spiFlashStatistics, 0, sizeof(spiFlashStatistics_t));
+	__set_PRIMASK(primask);
+}
+#endif
+
+bool SPI_Flash_programAsync(uint32_t addr, uint8_t *dataBuf, int size, spiFlashRequestCallback_t callback, void *userData)
+{
+	spiFlashRequest_t request = { .type = SPI_FLASH_REQUEST_PROGRAM, .address = addr, .dataBuf = dataBuf, .size = size,
+			.callback = callback, .userData = userData };
+
+	return spi_flash_queueRequest(&request);
+}
+
+bool SPI_Flash_eraseSectorAsync(uint32_t addr, spiFlashRequestCallback_t callback, void *userData)
+{
+	spiFlashRequest_t request = { .type = SPI_FLASH_REQUEST_ERASE_SECTOR, .address = (addr & ~0xFFFU), .callback = callback, .userData = userData };
+
+	return spi_flash_queueRequest(&request);
+}
+
+bool SPI_Flash_isIdle(void)
+{
+	return (spiFlashEngine.state == SPI_FLASH_ENGINE_IDLE);
+}
+
+bool SPI_Flash_isTransferring(void)
+{
+	return (spiFlashEngine.state == SPI_FLASH_ENGINE_TRANSFER);
+}
 
-		for (int i = 0; i < 16; i++)
+// Writes are merged into the sector write cache, and written back on SPI_Flash_sync(),
+// SPI_Flash_syncIfNeeded() (timed) or when a sector has to be evicted.
+bool SPI_Flash_write(uint32_t addr, uint8_t *dataBuf, int size)
+{
+	while (size > 0)
+	{
+		uint32_t sectorAddress = (addr & ~(SPI_FLASH_SECTOR_SIZE - 1));
+		int len = SAFE_MIN(size, (int)(SPI_FLASH_SECTOR_SIZE - (addr - sectorAddress)));
+		spiFlashCachedSector_t *cachedSector = spi_flash_cacheFind(sectorAddress);
+
+		if (cachedSector == NULL)
 		{
-			retVal = SPI_Flash_writePage(flashEndSector * 4096 + i * 256, SPI_Flash_sectorbuffer + i * 256);
+			// No need to read the sector content if it's entirely overwritten
+			cachedSector = spi_flash_cacheAllocate(sectorAddress, (len != SPI_FLASH_SECTOR_SIZE));
 
-			if (!retVal)
+			if (cachedSector == NULL)
 			{
 				return false;
 			}
 		}
+
+		memcpy(cachedSector->buffer + (addr - sectorAddress), dataBuf, len);
+		cachedSector->dirty = true;
+		cachedSector->lastAccess = ticksGetMillis();
+
+		addr += len;
+		dataBuf += len;
+		size -= len;
 	}
 
 	return true;
 }
 
+// Writes back all the dirty sectors of the write cache.
+bool SPI_Flash_sync(void)
+{
+	bool retVal = true;
+
+	for (int i = 0; i < SPI_FLASH_WRITE_CACHE_NUM_SECTORS; i++)
+	{
+		if (spiFlashWriteCache[i].valid && spiFlashWriteCache[i].dirty)
+		{
+			retVal = spi_flash_cacheFlush(&spiFlashWriteCache[i]) && retVal;
+		}
+	}
+
+	return retVal;
+}
+
+// Called from the main loop, writes back the sectors that haven't been modified for a while.
+void SPI_Flash_syncIfNeeded(void)
+{
+	for (int i = 0; i < SPI_FLASH_WRITE_CACHE_NUM_SECTORS; i++)
+	{
+		if (spiFlashWriteCache[i].valid && spiFlashWriteCache[i].dirty &&
+				((ticksGetMillis() - spiFlashWriteCache[i].lastAccess) > SPI_FLASH_WRITE_CACHE_FLUSH_DELAY))
+		{
+			spi_flash_cacheFlush(&spiFlashWriteCache[i]);
+		}
+	}
+}
+
 uint32_t SPI_Flash_readStatusRegisters(void)
 {
-	uint8_t cmdVal = R_SR1;
 	uint8_t r1 = 0x0, r2 = 0x0, r3 = 0x0;
+	spiFlashRequest_t request = { .type = SPI_FLASH_REQUEST_READ, .command = { R_SR1 }, .commandLength = 1, .dataBuf = &r1, .size = 1 };
 
-	spi_flash_enable();
-	HAL_SPI_Transmit(&HANDLE_SPI, &cmdVal, 1, HAL_MAX_DELAY);
-	HAL_SPI_Receive(&HANDLE_SPI, &r1, 1, HAL_MAX_DELAY);
-	spi_flash_disable();
+	spi_flash_runRequest(&request);
 
-	cmdVal = R_SR2;
-	spi_flash_enable();
-	HAL_SPI_Transmit(&HANDLE_SPI, &cmdVal, 1, HAL_MAX_DELAY);
-	HAL_SPI_Receive(&HANDLE_SPI, &r2, 1, HAL_MAX_DELAY);
-	spi_flash_disable();
+	request.command[0] = R_SR2;
+	request.dataBuf = &r2;
+	spi_flash_runRequest(&request);
 
-	cmdVal = R_SR3;
-	spi_flash_enable();
-	HAL_SPI_Transmit(&HANDLE_SPI, &cmdVal, 1, HAL_MAX_DELAY);
-	HAL_SPI_Receive(&HANDLE_SPI, &r3, 1, HAL_MAX_DELAY);
-	spi_flash_disable();
+	request.command[0] = R_SR3;
+	request.dataBuf = &r3;
+	spi_flash_runRequest(&request);
 
 	return (r3 << 16) | (r2 << 8) | r1;
 }
 
 uint8_t SPI_Flash_readManufacturer(void)
 {
-	uint8_t commandBuf[4] = { R_JEDEC_ID, 0x00, 0x00, 0x00 };
-	uint8_t recBuf[4];
+	uint8_t recBuf[3];
+	spiFlashRequest_t request = { .type = SPI_FLASH_REQUEST_READ, .command = { R_JEDEC_ID }, .commandLength = 1, .dataBuf = recBuf, .size = 3 };
 
-	spi_flash_enable();
-	HAL_SPI_TransmitReceive(&HANDLE_SPI, commandBuf, recBuf, 4, HAL_MAX_DELAY);
-	spi_flash_disable();
+	spi_flash_runRequest(&request);
 
-	return recBuf[1];
+	return recBuf[0];
 }
 
 uint32_t SPI_Flash_readPartID(void)
 {
-	uint8_t commandBuf[4] = { R_JEDEC_ID, 0x00, 0x00, 0x00 };
-	uint8_t recBuf[4];
+	uint8_t recBuf[3];
+	spiFlashRequest_t request = { .type = SPI_FLASH_REQUEST_READ, .command = { R_JEDEC_ID }, .commandLength = 1, .dataBuf = recBuf, .size = 3 };
 
-	spi_flash_enable();
-	HAL_SPI_TransmitReceive(&HANDLE_SPI, commandBuf, recBuf, 4, HAL_MAX_DELAY);
-	spi_flash_disable();
+	spi_flash_runRequest(&request);
 
-	return (recBuf[2] << 8) | recBuf[3];
+	return (recBuf[1] << 8) | recBuf[2];
 }
 
 bool SPI_Flash_writePage(uint32_t addr_start,uint8_t *dataBuf)
 {
-	bool isBusy;
-	int waitCounter = 5;// Worst case is something like 3mS
-	uint8_t commandBuf[4]= { PAGE_PGM, addr_start >> 16, addr_start >> 8, 0x00 } ;
-#if defined(PLATFORM_MD2017)
-	bool restoreMuxPin = (HAL_GPIO_ReadPin(SPK_MUX_GPIO_Port, SPK_MUX_Pin) == GPIO_PIN_RESET);
+	return SPI_Flash_programBytes((addr_start & ~0xFFU), dataBuf, 0x100);
+}
+
+// Programs (without erasing) any number of bytes, split on page boundaries.
+// Target area has to be in erased state (0xFF), as programming can only clear bits.
+bool SPI_Flash_programBytes(uint32_t addr, uint8_t *dataBuf, int size)
+{
+	spiFlashRequest_t request = { .type = SPI_FLASH_REQUEST_PROGRAM, .address = addr, .dataBuf = dataBuf, .size = size };
 
-	muxPinOverrideLocked = true;
-	if (restoreMuxPin)
+	// Pending cached writes have to land first, as programming can only clear bits
+	if (spi_flash_cacheInvalidate(addr, size, true) == false)
 	{
-		// Not sure why. But if the audio amp is set to the internal speaker it affects the saving to Flash
-		HAL_GPIO_WritePin(SPK_MUX_GPIO_Port, SPK_MUX_Pin, GPIO_PIN_SET);
+		return false;
 	}
-#endif
 
-	spi_flash_setWriteEnable(true);
+	return spi_flash_runRequest(&request);
+}
 
-	spi_flash_enable();
+// Returns true if erased and false if failed.
+bool SPI_Flash_eraseSector(uint32_t addr_start)
+{
+	spiFlashRequest_t request = { .type = SPI_FLASH_REQUEST_ERASE_SECTOR, .address = (addr_start & ~0xFFFU) };
 
-	HAL_SPI_Transmit(&HANDLE_SPI, commandBuf, 4, HAL_MAX_DELAY);
-	HAL_SPI_Transmit(&HANDLE_SPI, dataBuf, 0x100, HAL_MAX_DELAY);
+	// The erase supersedes any cached content of that sector
+	spi_flash_cacheInvalidate(request.address, SPI_FLASH_SECTOR_SIZE, false);
 
-	spi_flash_disable();
+	return spi_flash_runRequest(&request);
+}
+
+static void spi_flash_engineTaskFunction(void *argument)
+{
+	while (true)
+	{
+		// While a program or erase is in progress, the busy flag is polled every 1ms
+		bool notified = (ulTaskNotifyTake(pdTRUE, ((spiFlashEngine.state == SPI_FLASH_ENGINE_WAIT_DEVICE) ? (1 / portTICK_PERIOD_MS) : portMAX_DELAY)) != 0);
+
+		switch (spiFlashEngine.state)
+		{
+			case SPI_FLASH_ENGINE_STARTING:
+				spi_flash_startNextRequest();
+				break;
+
+			case SPI_FLASH_ENGINE_TRANSFER_END:
+				spi_flash_completeRequest(spiFlashEngine.transferSuccess);
+				break;
+
+			case SPI_FLASH_ENGINE_WAIT_DEVICE:
+				if (notified == false)
+				{
+					spi_flash_pollDevice();
+				}
+				break;
+
+			default:
+				break;
+		}
+	}
+}
+
+// Wakes up the engine task, from a task or an interrupt
+static void spi_flash_notifyEngine(void)
+{
+	if (__get_IPSR() != 0)
+	{
+		BaseType_t higherPriorityTaskWoken = pdFALSE;
+
+		vTaskNotifyGiveFromISR(spiFlashEngine.taskHandle, &higherPriorityTaskWoken);
+		portYIELD_FROM_ISR(higherPriorityTaskWoken);
+	}
+	else
+	{
+		xTaskNotifyGive(spiFlashEngine.taskHandle);
+	}
+}
+
+// Polls the busy flag while a program or erase is in progress.
+static void spi_flash_pollDevice(void)
+{
+	if (spi_flash_busy())
+	{
+		if (--spiFlashEngine.waitCounter <= 0)
+		{
+			spi_flash_completeRequest(false);
+		}
+		return;
+	}
+
+	spiFlashRequest_t *request = &spiFlashEngine.queue[spiFlashEngine.head];
+
+	if (request->type == SPI_FLASH_REQUEST_PROGRAM)
+	{
+		spiFlashEngine.offset += spiFlashEngine.chunkLength;
+
+		if (spiFlashEngine.offset < request->size)
+		{
+			spiFlashEngine.state = SPI_FLASH_ENGINE_STARTING;
+
+			if (spi_flash_startProgramChunk(request) == SPI_FLASH_START_FAILED)
+			{
+				spi_flash_completeRequest(false);
+			}
+			return;
+		}
+	}
+
+	spi_flash_completeRequest(true);
+}
+
+void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi)
+{
+	if ((hspi == &HANDLE_SPI) && (spiFlashEngine.state == SPI_FLASH_ENGINE_TRANSFER))
+	{
+		// Page data has been sent, the device is now programming it
+		spi_flash_disable();
+		spiFlashEngine.waitCounter = SPI_FLASH_PROGRAM_TIMEOUT_MS;
+		spiFlashEngine.state = SPI_FLASH_ENGINE_WAIT_DEVICE;
+		spi_flash_notifyEngine();
+	}
+}
+
+void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef *hspi)
+{
+	if ((hspi == &HANDLE_SPI) && (spiFlashEngine.state == SPI_FLASH_ENGINE_TRANSFER))
+	{
+		spi_flash_disable();
+		spiFlashEngine.transferSuccess = true;
+		spiFlashEngine.state = SPI_FLASH_ENGINE_TRANSFER_END;
+		spi_flash_notifyEngine();
+	}
+}
+
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef *hspi)
+{
+	if ((hspi == &HANDLE_SPI) && (spiFlashEngine.state == SPI_FLASH_ENGINE_TRANSFER))
+	{
+		spi_flash_disable();
+		spiFlashEngine.transferSuccess = false;
+		spiFlashEngine.state = SPI_FLASH_ENGINE_TRANSFER_END;
+		spi_flash_notifyEngine();
+	}
+}
+
+static void spi_flash_syncCallback(bool success, void *userData)
+{
+	spiFlashSyncResult_t *result = (spiFlashSyncResult_t *)userData;
+
+	result->success = success;
+	result->done = true;
+	xTaskNotifyGive(result->waitingTask);
+}
+
+// Queues the request and waits for its completion. Must be called from a task.
+static bool spi_flash_runRequest(spiFlashRequest_t *request)
+{
+	spiFlashSyncResult_t result = { .done = false, .success = false, .waitingTask = xTaskGetCurrentTaskHandle() };
+
+	request->callback = spi_flash_syncCallback;
+	request->userData = &result;
 
-	do
+	while (spi_flash_queueRequest(request) == false)
 	{
 		osDelay(1);
-		isBusy = spi_flash_busy();
-	} while ((waitCounter-- > 0) && isBusy);
+	}
 
-#if defined(PLATFORM_MD2017)
-	if (restoreMuxPin) // Restore Mux Pin state
+	while (result.done == false)
 	{
-		HAL_GPIO_WritePin(SPK_MUX_GPIO_Port, SPK_MUX_Pin, GPIO_PIN_RESET);
+		ulTaskNotifyTake(pdTRUE, (1 / portTICK_PERIOD_MS));
 	}
-	muxPinOverrideLocked = false;
-#endif
 
-	return !isBusy;
+	return result.success;
 }
 
-// Returns true if erased and false if failed.
-bool SPI_Flash_eraseSector(uint32_t addr_start)
+static bool spi_flash_queueRequest(const spiFlashRequest_t *request)
 {
-	int waitCounter = 500;// erase can take up to 500 mS
-	bool isBusy;
-	uint8_t commandBuf[4] = { SECTOR_E, addr_start >> 16, addr_start >> 8, 0x00 };
-#if defined(PLATFORM_MD2017)
-	bool restoreMuxPin = (HAL_GPIO_ReadPin(SPK_MUX_GPIO_Port, SPK_MUX_Pin) == GPIO_PIN_RESET);
+	bool notifyEngine = false;
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	if (spiFlashEngine.count >= SPI_FLASH_REQUEST_QUEUE_SIZE)
+	{
+		__set_PRIMASK(primask);
+		return false;
+	}
+
+	spiFlashEngine.queue[(spiFlashEngine.head + spiFlashEngine.count) % SPI_FLASH_REQUEST_QUEUE_SIZE] = *request;
+	spiFlashEngine.count++;
 
-	muxPinOverrideLocked = true;
-	if (restoreMuxPin)
+	if (spiFlashEngine.state == SPI_FLASH_ENGINE_IDLE)
 	{
-		// Not sure why. But if the audio amp is set to the internal speaker it affects the saving to Flash
-		HAL_GPIO_WritePin(SPK_MUX_GPIO_Port, SPK_MUX_Pin, GPIO_PIN_SET);
+		spiFlashEngine.state = SPI_FLASH_ENGINE_STARTING;
+		notifyEngine = true;
 	}
-#endif
+	__set_PRIMASK(primask);
+
+	if (notifyEngine)
+	{
+		spi_flash_notifyEngine();
+	}
+
+	return true;
+}
+
+// Starts the request at the head of the queue, the engine state has to be SPI_FLASH_ENGINE_STARTING.
+// Only called by the engine task.
+static void spi_flash_startNextRequest(void)
+{
+	while (true)
+	{
+		uint32_t primask = __get_PRIMASK();
+		spiFlashStartResult_t result;
+
+		__disable_irq();
+		if (spiFlashEngine.count == 0)
+		{
+			spiFlashEngine.state = SPI_FLASH_ENGINE_IDLE;
+			__set_PRIMASK(primask);
+			return;
+		}
+		__set_PRIMASK(primask);
+
+		result = spi_flash_startRequest(&spiFlashEngine.queue[spiFlashEngine.head]);
+
+		if (result == SPI_FLASH_START_PENDING)
+		{
+			return;
+		}
+
+		spi_flash_finishRequest(result == SPI_FLASH_START_DONE);
+	}
+}
+
+static spiFlashStartResult_t spi_flash_startRequest(spiFlashRequest_t *request)
+{
+	spiFlashEngine.offset = 0;
+	spiFlashEngine.chunkLength = 0;
+
+	spi_flash_setHighSpeedClock((request->type == SPI_FLASH_REQUEST_READ) && (spiFlashReadMode == SPI_FLASH_READ_MODE_FAST));
+
+	switch (request->type)
+	{
+		case SPI_FLASH_REQUEST_READ:
+			spi_flash_enable();
+			HAL_SPI_Transmit(&HANDLE_SPI, request->command, request->commandLength, HAL_MAX_DELAY);
+
+			if (spi_flash_canUseDMA(request->dataBuf, request->size))
+			{
+				HAL_StatusTypeDef status;
+				uint32_t primask = __get_PRIMASK();
+
+				// Interrupts are masked so the completion can't run before the HAL has released the handle
+				__disable_irq();
+				spiFlashEngine.state = SPI_FLASH_ENGINE_TRANSFER;
+				// The buffer is also sent out while receiving, the device ignores MOSI at that stage
+				status = HAL_SPI_TransmitReceive_DMA(&HANDLE_SPI, request->dataBuf, request->dataBuf, request->size);
+				__set_PRIMASK(primask);
+
+				if (status != HAL_OK)
+				{
+					spi_flash_disable();
+					return SPI_FLASH_START_FAILED;
+				}
+
+				return SPI_FLASH_START_PENDING;
+			}
+
+			HAL_SPI_Receive(&HANDLE_SPI, request->dataBuf, request->size, HAL_MAX_DELAY);
+			spi_flash_disable();
+			return SPI_FLASH_START_DONE;
+
+		case SPI_FLASH_REQUEST_PROGRAM:
+			if (request->size <= 0)
+			{
+				return SPI_FLASH_START_DONE;
+			}
+
+			spi_flash_muxPinOverride(true);
+			return spi_flash_startProgramChunk(request);
+
+		case SPI_FLASH_REQUEST_ERASE_SECTOR:
+			{
+				uint8_t commandBuf[4] = { SECTOR_E, request->address >> 16, request->address >> 8, 0x00 };
+
+				spi_flash_muxPinOverride(true);
+
+				spi_flash_setWriteEnable(true); // it calls spi_flash_{enable/disable}() by itself
+
+				spi_flash_enable();
+				HAL_SPI_Transmit(&HANDLE_SPI, commandBuf, 4, HAL_MAX_DELAY);
+				spi_flash_disable();
+
+				spiFlashEngine.waitCounter = SPI_FLASH_ERASE_TIMEOUT_MS;
+				spiFlashEngine.state = SPI_FLASH_ENGINE_WAIT_DEVICE;
+			}
+			return SPI_FLASH_START_PENDING;
+	}
+
+	return SPI_FLASH_START_FAILED;
+}
+
+// Program up to 256 bytes from the current request offset, without crossing a page boundary.
+static spiFlashStartResult_t spi_flash_startProgramChunk(spiFlashRequest_t *request)
+{
+	uint32_t addr = request->address + spiFlashEngine.offset;
+	uint8_t *dataBuf = request->dataBuf + spiFlashEngine.offset;
+	uint8_t commandBuf[4]= { PAGE_PGM, addr >> 16, addr >> 8, addr } ;
 
-	spi_flash_setWriteEnable(true); // it calls spi_flash_{enable/disable}() by itself
+	spiFlashEngine.chunkLength = SAFE_MIN((request->size - spiFlashEngine.offset), (int)(0x100 - (addr & 0xFF)));
+
+	spi_flash_setWriteEnable(true);
 
 	spi_flash_enable();
 	HAL_SPI_Transmit(&HANDLE_SPI, commandBuf, 4, HAL_MAX_DELAY);
-	spi_flash_disable();
 
-	do
+	if (spi_flash_canUseDMA(dataBuf, spiFlashEngine.chunkLength))
 	{
-		osDelay(1);
-		isBusy = spi_flash_busy();
-	} while ((waitCounter-- > 0) && isBusy);
+		HAL_StatusTypeDef status;
+		uint32_t primask = __get_PRIMASK();
 
-#if defined(PLATFORM_MD2017)
-	if (restoreMuxPin) // Restore Mux Pin state
+		__disable_irq();
+		spiFlashEngine.state = SPI_FLASH_ENGINE_TRANSFER;
+		status = HAL_SPI_Transmit_DMA(&HANDLE_SPI, dataBuf, spiFlashEngine.chunkLength);
+		__set_PRIMASK(primask);
+
+		if (status != HAL_OK)
+		{
+			spi_flash_disable();
+			return SPI_FLASH_START_FAILED;
+		}
+	}
+	else
+	{
+		HAL_SPI_Transmit(&HANDLE_SPI, dataBuf, spiFlashEngine.chunkLength, HAL_MAX_DELAY);
+		spi_flash_disable();
+
+		spiFlashEngine.waitCounter = SPI_FLASH_PROGRAM_TIMEOUT_MS;
+		spiFlashEngine.state = SPI_FLASH_ENGINE_WAIT_DEVICE;
+	}
+
+	return SPI_FLASH_START_PENDING;
+}
+
+// Removes the head request from the queue and notifies its owner.
+static void spi_flash_finishRequest(bool success)
+{
+	spiFlashRequest_t *request = &spiFlashEngine.queue[spiFlashEngine.head];
+	spiFlashRequestCallback_t callback = request->callback;
+	void *userData = request->userData;
+	uint32_t primask;
+
+	if (request->type != SPI_FLASH_REQUEST_READ)
+	{
+		spi_flash_muxPinOverride(false);
+	}
+
+#if defined(SPI_FLASH_BENCHMARK)
+	if (success)
 	{
-		HAL_GPIO_WritePin(SPK_MUX_GPIO_Port, SPK_MUX_Pin, GPIO_PIN_RESET);
+		switch (request->type)
+		{
+			case SPI_FLASH_REQUEST_READ:
+				spiFlashStatistics.reads++;
+				spiFlashStatistics.readBytes += request->size;
+				break;
+			case SPI_FLASH_REQUEST_PROGRAM:
+				spiFlashStatistics.programs++;
+				spiFlashStatistics.programBytes += request->size;
+				break;
+			case SPI_FLASH_REQUEST_ERASE_SECTOR:
+				spiFlashStatistics.erases++;
+				spiFlashStatistics.blockErases[(request->address >> 16) % SPI_FLASH_STATISTICS_NUM_BLOCKS]++;
+				break;
+		}
 	}
-	muxPinOverrideLocked = false;
 #endif
 
-	return !isBusy;// If still busy after
+	spiFlashEngine.state = SPI_FLASH_ENGINE_STARTING;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	spiFlashEngine.head = (spiFlashEngine.head + 1) % SPI_FLASH_REQUEST_QUEUE_SIZE;
+	spiFlashEngine.count--;
+	__set_PRIMASK(primask);
+
+	if (callback != NULL)
+	{
+		callback(success, userData);
+	}
+}
+
+// Used by the engine task, when the current request has ended.
+static void spi_flash_completeRequest(bool success)
+{
+	spi_flash_finishRequest(success);
+	spi_flash_startNextRequest();
+}
+
+static bool spi_flash_readRaw(uint32_t addr, uint8_t *dataBuf, int size)
+{
+	spiFlashRequest_t request;
+
+	spi_flash_setReadRequest(&request, addr, dataBuf, size);
+
+	return spi_flash_runRequest(&request);
+}
+
+static void spi_flash_setReadRequest(spiFlashRequest_t *request, uint32_t addr, uint8_t *dataBuf, int size)
+{
+	memset(request, 0, sizeof(spiFlashRequest_t));
+
+	request->type = SPI_FLASH_REQUEST_READ;
+	request->address = addr;
+	request->dataBuf = dataBuf;
+	request->size = size;
+
+	request->command[1] = (addr >> 16);
+	request->command[2] = (addr >> 8);
+	request->command[3] = addr;
+
+	if (spiFlashReadMode == SPI_FLASH_READ_MODE_FAST)
+	{
+		request->command[0] = FAST_READ;
+		request->command[4] = 0x00; // dummy byte
+		request->commandLength = 5;
+	}
+	else
+	{
+		request->command[0] = READ_DATA;
+		request->commandLength = 4;
+	}
+}
+
+// Only called by the engine, between transfers.
+static void spi_flash_setHighSpeedClock(bool highSpeed)
+{
+	uint32_t prescaler = (highSpeed ? SPI_FLASH_HIGH_SPEED_PRESCALER : HANDLE_SPI.Init.BaudRatePrescaler);
+
+	if ((HANDLE_SPI.Instance->CR1 & SPI_CR1_BR) != prescaler)
+	{
+		__HAL_SPI_DISABLE(&HANDLE_SPI); // re-enabled by the HAL on the next transfer
+		MODIFY_REG(HANDLE_SPI.Instance->CR1, SPI_CR1_BR, prescaler);
+	}
+}
+
+// Applies the pending cached writes over data read from the Flash.
+static void spi_flash_cacheOverlay(uint32_t addr, uint8_t *dataBuf, int size)
+{
+	for (int i = 0; i < SPI_FLASH_WRITE_CACHE_NUM_SECTORS; i++)
+	{
+		spiFlashCachedSector_t *cachedSector = &spiFlashWriteCache[i];
+
+		if (cachedSector->valid && cachedSector->dirty &&
+				(cachedSector->sectorAddress < (addr + size)) && ((cachedSector->sectorAddress + SPI_FLASH_SECTOR_SIZE) > addr))
+		{
+			uint32_t start = SAFE_MAX(addr, cachedSector->sectorAddress);
+			uint32_t end = SAFE_MIN((addr + size), (cachedSector->sectorAddress + SPI_FLASH_SECTOR_SIZE));
+
+			memcpy(dataBuf + (start - addr), cachedSector->buffer + (start - cachedSector->sectorAddress), (end - start));
+		}
+	}
+}
+
+static void spi_flash_readAheadCallback(bool success, void *userData)
+{
+	volatile spiFlashReadAheadBlockState_t *blockState = (volatile spiFlashReadAheadBlockState_t *)userData;
+
+	*blockState = (success ? SPI_FLASH_READ_AHEAD_BLOCK_READY : SPI_FLASH_READ_AHEAD_BLOCK_FAILED);
+}
+
+static void spi_flash_readAheadFetch(spiFlashReadAhead_t *readAhead, int block, uint32_t address)
+{
+	readAhead->blockAddress[block] = address;
+	readAhead->blockState[block] = SPI_FLASH_READ_AHEAD_BLOCK_PENDING;
+
+	if (SPI_Flash_readAsync(address, readAhead->block[block], SPI_FLASH_READ_AHEAD_BLOCK_SIZE,
+			spi_flash_readAheadCallback, (void *)&readAhead->blockState[block]) == false)
+	{
+		// Queue is full, read it in the foreground
+		readAhead->blockState[block] = (spi_flash_readRaw(address, readAhead->block[block], SPI_FLASH_READ_AHEAD_BLOCK_SIZE) ?
+				SPI_FLASH_READ_AHEAD_BLOCK_READY : SPI_FLASH_READ_AHEAD_BLOCK_FAILED);
+	}
+}
+
+static spiFlashCachedSector_t *spi_flash_cacheFind(uint32_t sectorAddress)
+{
+	for (int i = 0; i < SPI_FLASH_WRITE_CACHE_NUM_SECTORS; i++)
+	{
+		if (spiFlashWriteCache[i].valid && (spiFlashWriteCache[i].sectorAddress == sectorAddress))
+		{
+			return &spiFlashWriteCache[i];
+		}
+	}
+
+	return NULL;
+}
+
+// Picks an unused (or clean, or the least recently written) cache slot, the latter being written back first.
+static spiFlashCachedSector_t *spi_flash_cacheAllocate(uint32_t sectorAddress, bool loadFromFlash)
+{
+	spiFlashCachedSector_t *cachedSector = NULL;
+
+	for (int i = 0; i < SPI_FLASH_WRITE_CACHE_NUM_SECTORS; i++)
+	{
+		spiFlashCachedSector_t *candidate = &spiFlashWriteCache[i];
+
+		if (candidate->valid == false)
+		{
+			cachedSector = candidate;
+			break;
+		}
+
+		if ((cachedSector == NULL) ||
+				(cachedSector->dirty && (candidate->dirty == false)) ||
+				((cachedSector->dirty == candidate->dirty) && ((int32_t)(candidate->lastAccess - cachedSector->lastAccess) < 0)))
+		{
+			cachedSector = candidate;
+		}
+	}
+
+	if (cachedSector->valid && cachedSector->dirty)
+	{
+		if (spi_flash_cacheFlush(cachedSector) == false)
+		{
+			return NULL;
+		}
+	}
+
+	cachedSector->valid = false;
+	cachedSector->dirty = false;
+
+	if (loadFromFlash && (spi_flash_readRaw(sectorAddress, cachedSector->buffer, SPI_FLASH_SECTOR_SIZE) == false))
+	{
+		return NULL;
+	}
+
+	cachedSector->sectorAddress = sectorAddress;
+	cachedSector->lastAccess = ticksGetMillis();
+	cachedSector->valid = true;
+
+	return cachedSector;
+}
+
+// Writes a cached sector back. The Flash content is compared first, so the erase is skipped
+// if the sector is unchanged, or if the changes only clear bits (programming is then enough).
+static bool spi_flash_cacheFlush(spiFlashCachedSector_t *cachedSector)
+{
+	uint8_t flashData[SPI_FLASH_COMPARE_CHUNK_SIZE];
+	bool needsErase = false;
+	bool needsProgram = false;
+
+	for (int offset = 0; (offset < SPI_FLASH_SECTOR_SIZE) && (needsErase == false); offset += SPI_FLASH_COMPARE_CHUNK_SIZE)
+	{
+		uint8_t *cachedData = cachedSector->buffer + offset;
+
+		if (spi_flash_readRaw(cachedSector->sectorAddress + offset, flashData, SPI_FLASH_COMPARE_CHUNK_SIZE) == false)
+		{
+			return false;
+		}
+
+		for (int i = 0; i < SPI_FLASH_COMPARE_CHUNK_SIZE; i++)
+		{
+			if (flashData[i] != cachedData[i])
+			{
+				needsProgram = true;
+
+				if ((flashData[i] & cachedData[i]) != cachedData[i])
+				{
+					needsErase = true;
+					break;
+				}
+			}
+		}
+	}
+
+	if (needsErase)
+	{
+		spiFlashRequest_t request = { .type = SPI_FLASH_REQUEST_ERASE_SECTOR, .address = cachedSector->sectorAddress };
+
+		if (spi_flash_runRequest(&request) == false)
+		{
+			return false;
+		}
+	}
+
+	if (needsProgram)
+	{
+		spiFlashRequest_t request = { .type = SPI_FLASH_REQUEST_PROGRAM, .address = cachedSector->sectorAddress, .dataBuf = cachedSector->buffer,
+				.size = SPI_FLASH_SECTOR_SIZE };
+
+		if (spi_flash_runRequest(&request) == false)
+		{
+			return false;
+		}
+	}
+
+	cachedSector->dirty = false;
+
+	return true;
+}
+
+// Drops the cached sectors overlapping the given area, as it's going to be modified bypassing the cache.
+static bool spi_flash_cacheInvalidate(uint32_t addr, int size, bool flushDirty)
+{
+	for (int i = 0; i < SPI_FLASH_WRITE_CACHE_NUM_SECTORS; i++)
+	{
+		spiFlashCachedSector_t *cachedSector = &spiFlashWriteCache[i];
+
+		if (cachedSector->valid &&
+				(cachedSector->sectorAddress < (addr + size)) && ((cachedSector->sectorAddress + SPI_FLASH_SECTOR_SIZE) > addr))
+		{
+			if (flushDirty && cachedSector->dirty && (spi_flash_cacheFlush(cachedSector) == false))
+			{
+				return false;
+			}
+
+			cachedSector->valid = false;
+			cachedSector->dirty = false;
+		}
+	}
+
+	return true;
+}
+
+static bool spi_flash_canUseDMA(uint8_t *dataBuf, int size)
+{
+	return ((HANDLE_SPI.hdmarx != NULL) && (HANDLE_SPI.hdmatx != NULL) && (size >= SPI_FLASH_DMA_MIN_TRANSFER_SIZE) &&
+			(((uint32_t)dataBuf < SPI_FLASH_CCMRAM_START) || ((uint32_t)dataBuf >= SPI_FLASH_CCMRAM_END)));
+}
+
+static void spi_flash_muxPinOverride(bool enable)
+{
+#if defined(PLATFORM_MD2017)
+	if (enable)
+	{
+		spiFlashEngine.restoreMuxPin = (HAL_GPIO_ReadPin(SPK_MUX_GPIO_Port, SPK_MUX_Pin) == GPIO_PIN_RESET);
+
+		muxPinOverrideLocked = true;
+		if (spiFlashEngine.restoreMuxPin)
+		{
+			// Not sure why. But if the audio amp is set to the internal speaker it affects the saving to Flash
+			HAL_GPIO_WritePin(SPK_MUX_GPIO_Port, SPK_MUX_Pin, GPIO_PIN_SET);
+		}
+	}
+	else if (muxPinOverrideLocked)
+	{
+		if (spiFlashEngine.restoreMuxPin) // Restore Mux Pin state
+		{
+			HAL_GPIO_WritePin(SPK_MUX_GPIO_Port, SPK_MUX_Pin, GPIO_PIN_RESET);
+		}
+		muxPinOverrideLocked = false;
+	}
+#endif
 }
 
 static inline void spi_flash_enable(void)
@@ -318,6 +1224,7 @@ static void spi_flash_disable(void)
 	HAL_GPIO_WritePin(SPI_Flash_CS_GPIO_Port, SPI_Flash_CS_Pin, GPIO_PIN_SET);
 }
 
+// Only called by the engine, while it owns the bus
 static bool spi_flash_busy(void)
 {
 	uint8_t r1;
@@ -350,12 +1257,10 @@ bool SPI_Flash_readSecurityRegisters(int startBlock, uint8_t *dataBuf, int size)
 	for (uint8_t i = startBlock; i < numberofblocks + 1; i++)
 	{
 		uint32_t addr = addrs[i];
-		uint8_t commandBuf[5] = { R_SEC_REGS, ((addr >> 16) & 0xFF), ((addr >> 8) & 0xFF), (addr & 0xFF), 0x00 };
+		spiFlashRequest_t request = { .type = SPI_FLASH_REQUEST_READ, .command = { R_SEC_REGS, ((addr >> 16) & 0xFF), ((addr >> 8) & 0xFF), (addr & 0xFF), 0x00 },
+				.commandLength = 5, .dataBuf = dataBuf + ((i - startBlock) * securityBlockSize), .size = securityBlockSize };
 
-		spi_flash_enable();
-		HAL_SPI_Transmit(&HANDLE_SPI, commandBuf, 5, HAL_MAX_DELAY);
-		HAL_SPI_Receive(&HANDLE_SPI, dataBuf + ((i - startBlock) * securityBlockSize), securityBlockSize, HAL_MAX_DELAY);
-		spi_flash_disable();
+		spi_flash_runRequest(&request);
 	}
 
 	return true;
@@ -364,12 +1269,10 @@ bool SPI_Flash_readSecurityRegisters(int startBlock, uint8_t *dataBuf, int size)
 uint8_t SPI_Flash_readSingleSecurityRegister(int addr)
 {
 	  uint8_t value;
-	  uint8_t commandBuf[5] = { R_SEC_REGS, ((addr >> 16) & 0xFF), ((addr >> 8) & 0xFF), (addr & 0xFF), 0x00 };
+	  spiFlashRequest_t request = { .type = SPI_FLASH_REQUEST_READ, .command = { R_SEC_REGS, ((addr >> 16) & 0xFF), ((addr >> 8) & 0xFF), (addr & 0xFF), 0x00 },
+			  .commandLength = 5, .dataBuf = &value, .size = 1 };
 
-	  spi_flash_enable();
-	  HAL_SPI_Transmit(&HANDLE_SPI, commandBuf, 5, HAL_MAX_DELAY);
-	  HAL_SPI_Receive(&HANDLE_SPI, &value, 1, HAL_MAX_DELAY);
-	  spi_flash_disable();
+	  spi_flash_runRequest(&request);
 
       return value;
 }
@@ -384,4 +1287,3 @@ bool SPI_Flash_StateIsBusy(void)
 			(state == HAL_SPI_STATE_BUSY_TX_RX));
 }
 #endif
-
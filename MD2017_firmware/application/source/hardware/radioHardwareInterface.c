@@ -271,6 +271,39 @@ RadioDevice_t radioGetTRxDeviceId(void)
 	return currentRadioDeviceId;
 }
 
+// Register writes made between these calls are sent once the batch ends, outside of the callers critical sections.
+void radioBeginRegisterBatch(void)
+{
+	AT1846sBeginBatch();
+}
+
+void radioEndRegisterBatch(void)
+{
+	AT1846sEndBatch();
+}
+
+#if defined(PLATFORM_MD2017)
+// Tunes the secondary receiver on its own, without touching the HR-C6000 which only belongs to the primary one.
+void radioSetSecondaryReceiverChannel(uint32_t rxFreq, int mode, bool bandwidthIs25kHz)
+{
+	radioBeginRegisterBatch();
+
+	RadioDevice_t previousDeviceId = radioSetTRxDevice(RADIO_DEVICE_SECONDARY);
+
+	currentRadioDevice->currentMode = mode;
+	currentRadioDevice->currentBandWidthIs25kHz = bandwidthIs25kHz;
+	currentRadioDevice->currentRxFrequency = rxFreq;
+
+	AT1846sSetMode(mode);
+	radioSetFrequency(rxFreq, false);
+	radioSetIF(currentRadioDevice->trxCurrentBand[TRX_RX_FREQ_BAND], bandwidthIs25kHz);
+
+	radioSetTRxDevice(previousDeviceId);
+
+	radioEndRegisterBatch();
+}
+#endif
+
 void radioSetBandwidth(bool Is25K)
 {
 	AT1846sSetBandWidth(Is25K);
@@ -41,6 +41,7 @@
 #include "hardware/radioHardwareInterface.h"
 #include "interfaces/gps.h"
 #include "interfaces/settingsStorage.h"
+#include "hardware/SPI_Flash.h"
 
 //#define DEBUG_HARDWARE_SCREEN 1
 
@@ -292,6 +293,8 @@ void powerDown(bool doNotSavePowerOffState)
 	gpsOff();
 #endif
 
+	SPI_Flash_sync(); // Write back the cached Flash sectors
+
 	// Give it a bit of time to finish to write the flash (avoiding corruptions).
 	while (true)
 	{
@@ -308,6 +311,7 @@ void powerDown(bool doNotSavePowerOffState)
 	radioPowerOff(true, true);
 
 	//Reset the display, saves about 1mA
+	displayWaitForTransfer();
 	HAL_GPIO_WritePin(LCD_CS_GPIO_Port, LCD_CS_Pin, GPIO_PIN_SET);
 	HAL_GPIO_WritePin(LCD_RST_GPIO_Port, LCD_RST_Pin, GPIO_PIN_RESET);
 	osDelay(20);
@@ -797,6 +801,7 @@ void powerOffFinalStage(bool maintainRTC, bool forceSuspend)
 	restoreVFOFilteringStatusIfSet();
 	restoreChFilteringStatusIfSet();
 	settingsSaveSettings(true);
+	SPI_Flash_sync(); // Write back the cached Flash sectors
 
 	// Give it a bit of time before pulling the plug as DM-1801 EEPROM looks slower
 	// than GD-77 to write, then quickly power cycling triggers settings reset.
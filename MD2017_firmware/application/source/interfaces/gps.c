@@ -29,6 +29,7 @@
 #include "user_interface/uiGlobals.h"
 #include "user_interface/uiUtilities.h"
 #include "interfaces/gps.h"
+#include "io/keyboard.h"
 #include "user_interface/uiLocalisation.h"
 #include "usb/usb_com.h"
 #if defined(PLATFORM_MD9600)
@@ -541,7 +542,9 @@ void gpsPower(bool on)
 	if (on)
 	{
 #if defined(PLATFORM_MD380)
+		keyboardScanSuspend(); // The keypad rows share the port
 		GPIOD->MODER = (GPIOD->MODER & ~GPIO_MODER_MODER8_Msk) | GPIO_MODER_MODER8_0;     //Set the GPIOD Pin 8 to GPIO mode
+		keyboardScanResume();
 		HAL_GPIO_WritePin(GPIOD, GPIO_PIN_8, GPIO_PIN_SET);                               //set it high
 #else // PLATFORM_MD380
 
@@ -552,14 +555,18 @@ void gpsPower(bool on)
 		}                                               //G4EML... always also use the hardware power control as the mic might be locally connected.
 #endif // PLATFORM_MD9600
 
+		keyboardScanSuspend();
 		GPIOA->MODER = (GPIOA->MODER & ~GPIO_MODER_MODER9_Msk) | GPIO_MODER_MODER9_0;     //Set the GPIOA Pin 9 to GPIO mode
+		keyboardScanResume();
 		HAL_GPIO_WritePin(GPIOA, GPIO_PIN_9, GPIO_PIN_SET);                               //set it high
 #endif // PLATFORM_MD380
 	}
 	else
 	{
 #if defined(PLATFORM_MD380)
+		keyboardScanSuspend();
 		GPIOD->MODER = (GPIOD->MODER & ~GPIO_MODER_MODER8_Msk) | GPIO_MODER_MODER8_0;     // Set the GPIOD Pin 8 to GPIO mode
+		keyboardScanResume();
 		HAL_GPIO_WritePin(GPIOD, GPIO_PIN_8, GPIO_PIN_RESET);                             //set it Low
 #else // PLATFORM_MD380
 
@@ -570,7 +577,9 @@ void gpsPower(bool on)
 		}                                           //G4EML... always also use the hardware power control as the mic might be locally connected.
 #endif // PLATFORM_MD9600
 
+		keyboardScanSuspend();
 		GPIOA->MODER = (GPIOA->MODER & ~GPIO_MODER_MODER9_Msk) | GPIO_MODER_MODER9_0;     // Set the GPIOA Pin 9 to GPIO mode
+		keyboardScanResume();
 		HAL_GPIO_WritePin(GPIOA, GPIO_PIN_9, GPIO_PIN_RESET);                             //set it Low
 #endif // PLATFORM_MD380
 	}
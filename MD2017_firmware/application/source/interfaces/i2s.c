@@ -34,8 +34,9 @@ volatile bool isReceiving = false;
 
 volatile bool stopOnNextI2SDMAInterrupt = false;
 
-uint16_t i2s_Tx_Buffer[NUM_I2S_BUFFERS][2][WAV_BUFFER_SIZE];
-uint16_t i2s_Rx_Buffer[NUM_I2S_BUFFERS][2][WAV_BUFFER_SIZE];
+// Word aligned, as the samples are processed in pairs (see sound.c)
+__attribute__((aligned(4))) uint16_t i2s_Tx_Buffer[NUM_I2S_BUFFERS][2][WAV_BUFFER_SIZE];
+__attribute__((aligned(4))) uint16_t i2s_Rx_Buffer[NUM_I2S_BUFFERS][2][WAV_BUFFER_SIZE];
 
 static void clearI2SBuffersAndFlags(void)
 {
@@ -31,6 +31,7 @@
 #include <stdlib.h>
 #include "interfaces/adc.h"
 #include "io/buttons.h"
+#include "io/keyboard.h"
 #include "main.h"
 
 static uint32_t prevButtonState;
@@ -109,42 +110,14 @@ static void checkMButtonState(uint32_t *buttons, MBUTTON_t mbutton, uint32_t but
 
 uint32_t buttonsRead(void)
 {
-	GPIO_InitTypeDef GPIO_InitStruct = {0};
 	uint32_t result = BUTTON_NONE;
-
-	GPIO_InitStruct.Mode = GPIO_MODE_INPUT;
-	GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
-	GPIO_InitStruct.Pull = GPIO_PULLDOWN;
-
-	GPIO_InitStruct.Pin =
-#if defined(PLATFORM_RT84_DM1701) || defined(PLATFORM_MD2017)
-			LCD_D5_Pin |
-#endif
-#if ! defined(PLATFORM_MD2017)
-			LCD_D6_Pin |
-#endif
-			LCD_D7_Pin;
-	HAL_GPIO_Init(GPIOE, &GPIO_InitStruct);
-
-	// Set ROW2 (K3) in OUTPUT mode, as keyboard code sets it to floating (avoiding Multiple key press combination problems).
-	GPIO_InitStruct.Pin = KEYPAD_ROW2_Pin;
-	GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;
-	GPIO_InitStruct.Pull = GPIO_NOPULL;
-	GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
-	HAL_GPIO_Init(KEYPAD_ROW2_GPIO_Port, &GPIO_InitStruct);
-
-	//set the row pin high to select that row of keys
-	HAL_GPIO_WritePin(KEYPAD_ROW2_GPIO_Port, KEYPAD_ROW2_Pin, GPIO_PIN_SET);
-
-	for (volatile int xx = 0; xx < 100; xx++)
-	{
-		// arbitrary settling delay
-	}
+	// The keyboard code drives ROW2 (K3) and releases it, so it can't conflict with the keypad scanning.
+	uint8_t columns = keyboardReadRowColumns(KEYBOARD_ROW_SIDE_BUTTONS);
 
 #if defined(PLATFORM_MDUV380)
-	if (HAL_GPIO_ReadPin(LCD_D7_GPIO_Port, LCD_D7_Pin) == GPIO_PIN_SET)
+	if (columns & KEYBOARD_COLUMN(7))
 #elif defined(PLATFORM_RT84_DM1701) || defined(PLATFORM_MD2017) // Top side button -> ORANGE
-	if (HAL_GPIO_ReadPin(LCD_D5_GPIO_Port, LCD_D5_Pin) == GPIO_PIN_SET)
+	if (columns & KEYBOARD_COLUMN(5))
 #endif
 	{
 #if defined(PLATFORM_MD380)
@@ -164,7 +137,7 @@ uint32_t buttonsRead(void)
 	}
 
 #if !defined(PLATFORM_MD2017)
-	if (HAL_GPIO_ReadPin(LCD_D6_GPIO_Port, LCD_D6_Pin) == GPIO_PIN_SET)
+	if (columns & KEYBOARD_COLUMN(6))
 	{
 #if defined(PLATFORM_MD380)
 		result |= BUTTON_SK1;
@@ -177,13 +150,13 @@ uint32_t buttonsRead(void)
 #endif
 
 #if defined(PLATFORM_RT84_DM1701)
-	if (HAL_GPIO_ReadPin(LCD_D7_GPIO_Port, LCD_D7_Pin) == GPIO_PIN_SET)
+	if (columns & KEYBOARD_COLUMN(7))
 	{
 		result |= BUTTON_SK1;
 		checkMButtonState(&result, MBUTTON_SK1, BUTTON_SK1);
 	}
 #elif defined(PLATFORM_MD2017)
-	if (HAL_GPIO_ReadPin(LCD_D7_GPIO_Port, LCD_D7_Pin) == GPIO_PIN_SET)
+	if (columns & KEYBOARD_COLUMN(7))
 	{
 		result |= BUTTON_SK2;
 		checkMButtonState(&result, MBUTTON_SK2, BUTTON_SK2);
@@ -199,13 +172,6 @@ uint32_t buttonsRead(void)
 
 #endif
 
-	//set the row2 pin back to floating. This prevents conflicts between multiple key presses.
-	GPIO_InitStruct.Pin = KEYPAD_ROW2_Pin;
-	GPIO_InitStruct.Mode = GPIO_MODE_INPUT;
-	GPIO_InitStruct.Pull = GPIO_NOPULL;
-	GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
-	HAL_GPIO_Init(KEYPAD_ROW2_GPIO_Port, &GPIO_InitStruct);
-
 	if ((HAL_GPIO_ReadPin(PTT_GPIO_Port, PTT_Pin) == GPIO_PIN_RESET) ||
 			(HAL_GPIO_ReadPin(PTT_EXTERNAL_GPIO_Port, PTT_EXTERNAL_Pin) == GPIO_PIN_RESET))
 	{
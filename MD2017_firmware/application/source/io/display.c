@@ -30,6 +30,7 @@
 #include <FreeRTOS.h>
 #include "hardware/HX8353E.h"
 #include "io/display.h"
+#include "io/keyboard.h"
 #include "functions/settings.h"
 #include "interfaces/gpio.h"
 #include "main.h"
@@ -71,6 +72,9 @@ void displaySetInvertedState(bool isInverted)
 
 		displayIsInverseVideo = isInverted;
 
+		displayWaitForTransfer();
+		keyboardScanSuspend();
+
 		GPIO_InitStruct.Mode = GPIO_MODE_AF_PP;
 		GPIO_InitStruct.Pull = GPIO_NOPULL;
 		GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
@@ -89,6 +93,7 @@ void displaySetInvertedState(bool isInverted)
 		HAL_GPIO_WritePin(LCD_CS_GPIO_Port, LCD_CS_Pin, GPIO_PIN_SET);
 
 		*((volatile uint8_t*) LCD_FSMC_ADDR_DATA) = 0;// write 0 to the display pins , to pull them all low, so keyboard reads don't need to
+		keyboardScanResume();
 
 		displaySetInverseVideo(displayIsInverseVideo);
 	}
@@ -120,6 +125,8 @@ void displayInit(bool isInverted, bool SPIFlashAvailable)
 			FSMC_BCR1_WRAPMOD | // bit 10
 			FSMC_BCR1_CBURSTRW; // bit 19, as bit 20 isn't documented
 
+	keyboardScanSuspend();
+
 	GPIO_InitStruct.Mode = GPIO_MODE_AF_PP;
 	GPIO_InitStruct.Pull = GPIO_NOPULL;
 	GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
@@ -385,6 +392,7 @@ void displayInit(bool isInverted, bool SPIFlashAvailable)
 	displayWriteCmd(HX8583_CMD_DISPON);
 
 	HAL_GPIO_WritePin(LCD_CS_GPIO_Port, LCD_CS_Pin, GPIO_PIN_SET);
+	keyboardScanResume();
 
 	displayBegin(isInverted, SPIFlashAvailable);
 
@@ -34,6 +34,7 @@
 #include "interfaces/gpio.h"
 #include "interfaces/adc.h"
 #include "io/buttons.h"
+#include "functions/ringBuffer.h"
 
 // Keyboard Keys
 typedef struct
@@ -44,8 +45,7 @@ typedef struct
 } KeyboardKeySetting_t;
 
 static char oldKeyboardCode;
-static uint32_t keyDebounceScancode;
-static int keyDebounceCounter;
+static char currentKeyboardCode; // Debounced key, as far as the scanner events have been consumed
 static uint8_t keyState;
 static char keypadAlphaKey;
 static int keypadAlphaIndex;
@@ -78,7 +78,6 @@ volatile trackballData_t trackballData =
 enum KEY_STATE
 {
 	KEY_IDLE = 0,
-	KEY_DEBOUNCE,
 	KEY_PRESS,
 	KEY_WAITLONG,
 	KEY_REPEAT,
@@ -258,19 +257,264 @@ static const struct
 };
 #endif
 
+#define KEYBOARD_ROWS  (sizeof(KeyboardMatrix) / sizeof(KeyboardMatrix[0]))
+
+// The matrix is scanned from the TIM7 ISR, one row per 1ms tick: the row driven at the end of a tick
+// is read at the start of the next one, so it has had 1ms to settle. Only the debounced key
+// changes are queued, the down key code or KEY_NONE when it is released.
+// The ISR priority is one the RTOS critical sections mask, so the tasks reconfiguring the keypad
+// ports can keep the scanner out, and it's below the HR-C6000 interrupts.
+#define KEYBOARD_EVENT_QUEUE_SIZE         16 // Needs to be a power of two
+#define KEYBOARD_SCAN_TIMER_IRQ_PRIORITY   6
+#define KEYBOARD_SCAN_TICK_US           1000
+
+static char keyboardEvents[KEYBOARD_EVENT_QUEUE_SIZE];
+static ringBuffer_t keyboardEventsRing = RING_BUFFER_INITIALISER(KEYBOARD_EVENT_QUEUE_SIZE);
+
+static struct
+{
+	volatile bool    running;
+	volatile uint8_t suspendCount;    // Pending keyboardScanSuspend() calls, the pins are used by someone else
+	volatile bool    readInProgress;  // keyboardRead() is scanning the matrix itself
+	int8_t           row;             // Row driven since the previous tick, -1 when the scan has to restart
+	uint8_t          candidateKey;
+	uint32_t         candidateTicks;  // For how long the same candidateKey has been found
+	volatile uint8_t stableKey;
+	uint32_t         columnsModeMask[2]; // GPIOD, GPIOE MODER/PUPDR fields of the column pins
+	uint32_t         columnsPullDown[2];
+} keyboardScan;
+
+static TIM_HandleTypeDef keyboardScanTimer;
+
+// Spreads a GPIO pin mask into the matching 2 bits per pin register fields
+static uint32_t keyboardPinsToFields(uint16_t pins, uint32_t fieldValue)
+{
+	uint32_t fields = 0;
+
+	for (uint32_t pos = 0; pos < 16; pos++)
+	{
+		if (pins & (1U << pos))
+		{
+			fields |= (fieldValue << (pos * 2));
+		}
+	}
+
+	return fields;
+}
+
+// Inputs with pull down, the display leaves them in FSMC alternate mode
+static void keyboardColumnsSetInput(void)
+{
+	GPIOD->MODER &= ~keyboardScan.columnsModeMask[0];
+	GPIOD->PUPDR = (GPIOD->PUPDR & ~keyboardScan.columnsModeMask[0]) | keyboardScan.columnsPullDown[0];
+	GPIOE->MODER &= ~keyboardScan.columnsModeMask[1];
+	GPIOE->PUPDR = (GPIOE->PUPDR & ~keyboardScan.columnsModeMask[1]) | keyboardScan.columnsPullDown[1];
+}
+
+// Set the row pin as a high output to select that row of keys
+static inline void keyboardRowDrive(size_t row)
+{
+	GPIO_TypeDef *port = KeyboardMatrix[row].GPIOCtrlPort;
+	uint32_t shift = (__builtin_ctz(KeyboardMatrix[row].GPIOCtrlPin) * 2);
+
+	port->BSRR = KeyboardMatrix[row].GPIOCtrlPin;
+	port->MODER = (port->MODER & ~(GPIO_MODER_MODER0 << shift)) | (GPIO_MODER_MODER0_0 << shift);
+}
+
+// Set the row pin back to floating. This prevents conflicts between multiple key presses.
+static inline void keyboardRowRelease(size_t row)
+{
+	GPIO_TypeDef *port = KeyboardMatrix[row].GPIOCtrlPort;
+
+	port->MODER &= ~(GPIO_MODER_MODER0 << (__builtin_ctz(KeyboardMatrix[row].GPIOCtrlPin) * 2));
+	port->BSRR = ((uint32_t)KeyboardMatrix[row].GPIOCtrlPin << 16U);
+}
+
+static void keyboardRowsRelease(void)
+{
+	for (size_t i = 0; i < KEYBOARD_ROWS; i++)
+	{
+		keyboardRowRelease(i);
+	}
+}
+
+// First down key of the row
+static uint8_t keyboardRowReadKey(size_t row)
+{
+	for (size_t k = 0; k < KEYBOARD_KEYS_PER_ROW; k++)
+	{
+		if ((KeyboardMatrix[row].Rows[k].Key != KEY_NONE) &&
+				(KeyboardMatrix[row].Rows[k].GPIOPort->IDR & KeyboardMatrix[row].Rows[k].GPIOPin))
+		{
+			return KeyboardMatrix[row].Rows[k].Key;
+		}
+	}
+
+	return KEY_NONE;
+}
+
+// Called at the end of each matrix scan
+static void keyboardScanDebounce(uint8_t key)
+{
+	if (key != keyboardScan.candidateKey)
+	{
+		keyboardScan.candidateKey = key;
+		keyboardScan.candidateTicks = 0;
+	}
+	else if ((keyboardScan.candidateTicks >= KEY_DEBOUNCE_MS) && (key != keyboardScan.stableKey))
+	{
+		// When the queue is full, the change is posted again after the next scan
+		if (ringBufferReserve(&keyboardEventsRing, 1))
+		{
+			keyboardEvents[ringBufferWriteSlot(&keyboardEventsRing)] = key;
+			ringBufferCommitWrite(&keyboardEventsRing, 1);
+			keyboardScan.stableKey = key;
+		}
+	}
+}
+
+static void keyboardScanTick(void)
+{
+	uint8_t key;
+
+	if ((keyboardScan.running == false) || (keyboardScan.suspendCount > 0) || keyboardScan.readInProgress)
+	{
+		// The columns have to be set up again, and the first row given time to settle
+		keyboardScan.row = -1;
+		return;
+	}
+
+	keyboardScan.candidateTicks++;
+
+	if (keyboardScan.row < 0)
+	{
+		keyboardColumnsSetInput();
+		keyboardScan.row = 0;
+		keyboardRowDrive(0);
+		return;
+	}
+
+	key = keyboardRowReadKey(keyboardScan.row);
+	keyboardRowRelease(keyboardScan.row);
+
+	// Stop on first down key (we don't support multiple key presses).
+	if ((key != KEY_NONE) || (++keyboardScan.row == KEYBOARD_ROWS))
+	{
+		keyboardScanDebounce(key);
+		keyboardScan.row = 0;
+	}
+
+	keyboardRowDrive(keyboardScan.row);
+}
+
+// Called from TIM7_IRQHandler()
+void keyboardScanTimerISR(void)
+{
+	if (__HAL_TIM_GET_FLAG(&keyboardScanTimer, TIM_FLAG_UPDATE))
+	{
+		__HAL_TIM_CLEAR_FLAG(&keyboardScanTimer, TIM_FLAG_UPDATE);
+		keyboardScanTick();
+	}
+}
+
+static void keyboardScanTimerInit(void)
+{
+	__HAL_RCC_TIM7_CLK_ENABLE();
+
+	// APB1 timers are clocked at twice PCLK1, as the APB1 prescaler isn't 1
+	keyboardScanTimer.Instance = TIM7;
+	keyboardScanTimer.Init.Prescaler = (((2U * HAL_RCC_GetPCLK1Freq()) / 1000000U) - 1U); // 1MHz count
+	keyboardScanTimer.Init.CounterMode = TIM_COUNTERMODE_UP;
+	keyboardScanTimer.Init.Period = (KEYBOARD_SCAN_TICK_US - 1U);
+	keyboardScanTimer.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+	if (HAL_TIM_Base_Init(&keyboardScanTimer) != HAL_OK)
+	{
+		Error_Handler();
+	}
+
+	HAL_NVIC_SetPriority(TIM7_IRQn, KEYBOARD_SCAN_TIMER_IRQ_PRIORITY, 0);
+	HAL_NVIC_EnableIRQ(TIM7_IRQn);
+	HAL_TIM_Base_Start_IT(&keyboardScanTimer);
+}
+
+// The display shares the column pins, and must not be driven while a key shorts a row to one of them.
+// Anything reconfiguring the keypad pins or their ports (GPIOA/D/E) calls this first, the scanner
+// leaves them alone until the matching keyboardScanResume(). Calls can be nested.
+void keyboardScanSuspend(void)
+{
+	taskENTER_CRITICAL();
+	keyboardScan.suspendCount++;
+	// The scanner ISR can't be touching the pins from now on
+	keyboardScan.row = -1;
+	keyboardRowsRelease();
+	taskEXIT_CRITICAL();
+}
+
+// Can be called from an ISR
+void keyboardScanResume(void)
+{
+	UBaseType_t savedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+
+	if (keyboardScan.suspendCount > 0)
+	{
+		keyboardScan.suspendCount--;
+	}
+
+	taskEXIT_CRITICAL_FROM_ISR(savedInterruptStatus);
+}
+
+static char keyboardNextKeyCode(void)
+{
+	if (ringBufferCount(&keyboardEventsRing) > 0)
+	{
+		currentKeyboardCode = keyboardEvents[ringBufferReadSlot(&keyboardEventsRing)];
+		ringBufferCommitRead(&keyboardEventsRing, 1);
+	}
+
+	return currentKeyboardCode;
+}
+
 void keyboardInit(void)
 {
-	//gpioInitKeyboard();
+	GPIO_InitTypeDef GPIO_InitStruct = { 0 };
+
+	keyboardScan.running = false;
+
+	// Speed and output type are only set once, the scanner then only switches the mode of the pins
+	GPIO_InitStruct.Mode = GPIO_MODE_INPUT;
+	GPIO_InitStruct.Pull = GPIO_NOPULL;
+	GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+	for (size_t i = 0; i < KEYBOARD_ROWS; i++)
+	{
+		GPIO_InitStruct.Pin = KeyboardMatrix[i].GPIOCtrlPin;
+		HAL_GPIO_Init(KeyboardMatrix[i].GPIOCtrlPort, &GPIO_InitStruct);
+	}
+
+	keyboardScan.columnsModeMask[0] = keyboardPinsToFields(LCD_D0_Pin | LCD_D1_Pin | LCD_D2_Pin | LCD_D3_Pin, GPIO_MODER_MODER0);
+	keyboardScan.columnsPullDown[0] = keyboardPinsToFields(LCD_D0_Pin | LCD_D1_Pin | LCD_D2_Pin | LCD_D3_Pin, GPIO_PULLDOWN);
+	keyboardScan.columnsModeMask[1] = keyboardPinsToFields(LCD_D4_Pin | LCD_D5_Pin | LCD_D6_Pin | LCD_D7_Pin, GPIO_MODER_MODER0);
+	keyboardScan.columnsPullDown[1] = keyboardPinsToFields(LCD_D4_Pin | LCD_D5_Pin | LCD_D6_Pin | LCD_D7_Pin, GPIO_PULLDOWN);
+	keyboardScan.row = -1;
+	keyboardScan.candidateKey = KEY_NONE;
+	keyboardScan.candidateTicks = 0;
+	keyboardScan.stableKey = KEY_NONE;
+	ringBufferReset(&keyboardEventsRing);
 
 	oldKeyboardCode = 0;
-	keyDebounceScancode = 0;
-	keyDebounceCounter = 0;
+	currentKeyboardCode = 0;
 	keypadAlphaEnable = false;
 	keypadAlphaIndex = 0;
 	keypadAlphaKey = 0;
 	keyState = KEY_IDLE;
 	keypadLocked = false;
 	trackballReset();
+
+	keyboardScan.running = true;
+
+	if (keyboardScanTimer.Instance == NULL)
+	{
+		keyboardScanTimerInit();
+	}
 }
 
 void keyboardReset(void)
@@ -283,51 +527,52 @@ void keyboardReset(void)
 	trackballReset();
 }
 
-uint32_t keyboardRead(void)
+// Direct scans stop the scanner for their duration, and are kept atomic between tasks.
+// Returns false, without starting, when the pins are used by someone else (e.g. driving the display).
+static bool keyboardDirectScanBegin(void)
 {
-	uint32_t result = KEY_NONE;
-	GPIO_InitTypeDef GPIO_InitStruct = { 0 };
+	taskENTER_CRITICAL();
 
-	GPIO_InitStruct.Mode = GPIO_MODE_INPUT;
-	GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
-	GPIO_InitStruct.Pull = GPIO_PULLDOWN;
+	if (keyboardScan.suspendCount > 0)
+	{
+		taskEXIT_CRITICAL();
+		return false;
+	}
 
-	GPIO_InitStruct.Pin = LCD_D0_Pin | LCD_D1_Pin | LCD_D2_Pin | LCD_D3_Pin;
-	HAL_GPIO_Init(GPIOD, &GPIO_InitStruct);
+	keyboardScan.readInProgress = true;
+	// The scanner ISR can't be touching the pins from now on
+	keyboardScan.row = -1;
+	keyboardRowsRelease();
+	keyboardColumnsSetInput();
+
+	return true;
+}
 
-	GPIO_InitStruct.Pin = LCD_D4_Pin | LCD_D5_Pin | LCD_D6_Pin | LCD_D7_Pin;
-	HAL_GPIO_Init(GPIOE, &GPIO_InitStruct);
+static void keyboardDirectScanEnd(void)
+{
+	keyboardScan.readInProgress = false;
+	taskEXIT_CRITICAL();
+}
+
+// Direct scan, for the callers which can't wait for the debounced key
+uint32_t keyboardRead(void)
+{
+	uint32_t result = KEY_NONE;
 
-	for (size_t i = 0; i < (sizeof(KeyboardMatrix) / sizeof(KeyboardMatrix[0])); i++)
+	// The keypad pins are driving the display, use the last debounced key until the transfer completes.
+	if (keyboardDirectScanBegin() == false)
 	{
-		//Set the Row Pin as Output
-		GPIO_InitStruct.Pin = KeyboardMatrix[i].GPIOCtrlPin;
-		GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;
-		GPIO_InitStruct.Pull = GPIO_NOPULL;
-		GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
-		HAL_GPIO_Init(KeyboardMatrix[i].GPIOCtrlPort, &GPIO_InitStruct);
+		return keyboardScan.stableKey;
+	}
 
-		//Set the row pin high to select that row of keys
-		HAL_GPIO_WritePin(KeyboardMatrix[i].GPIOCtrlPort, KeyboardMatrix[i].GPIOCtrlPin, GPIO_PIN_SET);
+	for (size_t i = 0; i < KEYBOARD_ROWS; i++)
+	{
+		keyboardRowDrive(i);
 
 		for(volatile int xx = 0; xx < 100; xx++); // arbitrary settling delay
 
-		for (size_t k = 0; k < KEYBOARD_KEYS_PER_ROW; k++)
-		{
-			if((KeyboardMatrix[i].Rows[k].Key != KEY_NONE) &&
-					(HAL_GPIO_ReadPin(KeyboardMatrix[i].Rows[k].GPIOPort, KeyboardMatrix[i].Rows[k].GPIOPin) == GPIO_PIN_SET))
-			{
-				result = KeyboardMatrix[i].Rows[k].Key;
-				break;
-			}
-		}
-
-		//set the row pin back to floating. This prevents conflicts between multiple key presses.
-		GPIO_InitStruct.Pin = KeyboardMatrix[i].GPIOCtrlPin;
-		GPIO_InitStruct.Mode = GPIO_MODE_INPUT;
-		GPIO_InitStruct.Pull = GPIO_NOPULL;
-		GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
-		HAL_GPIO_Init(KeyboardMatrix[i].GPIOCtrlPort, &GPIO_InitStruct);
+		result = keyboardRowReadKey(i);
+		keyboardRowRelease(i);
 
 		// Stop on first down key (we don't support multiple key presses).
 		if (result != KEY_NONE)
@@ -336,9 +581,44 @@ uint32_t keyboardRead(void)
 		}
 	}
 
+	keyboardDirectScanEnd();
+
 	return result;
 }
 
+// Direct read of all the columns of one row, bit n being set when LCD_Dn is high.
+// Used for the side buttons, which are wired to the keypad ROW2.
+uint8_t keyboardReadRowColumns(uint32_t row)
+{
+	static uint8_t lastColumns[KEYBOARD_ROWS];
+	uint8_t columns = 0;
+
+	// The keypad pins are driving the display, use the last read until the transfer completes.
+	if (keyboardDirectScanBegin() == false)
+	{
+		return lastColumns[row];
+	}
+
+	keyboardRowDrive(row);
+
+	for(volatile int xx = 0; xx < 100; xx++); // arbitrary settling delay
+
+	for (size_t k = 0; k < KEYBOARD_KEYS_PER_ROW; k++)
+	{
+		if (KeyboardMatrix[row].Rows[k].GPIOPort->IDR & KeyboardMatrix[row].Rows[k].GPIOPin)
+		{
+			columns |= KEYBOARD_COLUMN(k);
+		}
+	}
+
+	keyboardRowRelease(row);
+	keyboardDirectScanEnd();
+
+	lastColumns[row] = columns;
+
+	return columns;
+}
+
 bool keyboardKeyIsDTMFKey(char key)
 {
 	switch (key)
@@ -459,13 +739,14 @@ void keyboardCheckKeyEvent(keyboardCode_t *keys, int *event)
 			trackballReset();
 		}
 
-		keycode = (char) keyboardRead();
+		// The pressed key is held until its press event has been sent
+		keycode = ((keyState == KEY_PRESS) ? currentKeyboardCode : keyboardNextKeyCode());
 		scancode = keycode;
 	}
 
 	validKey = true;
 
-	if (keyState > KEY_DEBOUNCE && !validKey)
+	if (keyState > KEY_IDLE && !validKey)
 	{
 		keyState = KEY_WAIT_RELEASED;
 	}
@@ -475,10 +756,9 @@ void keyboardCheckKeyEvent(keyboardCode_t *keys, int *event)
 		case KEY_IDLE:
 			if (keycode != 0)
 			{
-				keyState = KEY_DEBOUNCE;
-				keyDebounceCounter = 0;
-				keyDebounceScancode = scancode;
-				oldKeyboardCode = 0;
+				// Already debounced by the scanner
+				oldKeyboardCode = keycode;
+				keyState = KEY_PRESS;
 			}
 			taskENTER_CRITICAL();
 			tmp_timer_keypad = timer_keypad_timeout;
@@ -495,21 +775,6 @@ if (onlyLatin)
 				keypadAlphaKey = 0;
 			}
 			break;
-		case KEY_DEBOUNCE:
-			keyDebounceCounter++;
-			if (keyDebounceCounter > KEY_DEBOUNCE_COUNTER)
-			{
-				if (keyDebounceScancode == scancode)
-				{
-					oldKeyboardCode = keycode;
-					keyState = KEY_PRESS;
-				}
-				else
-				{
-					keyState = KEY_WAIT_RELEASED;
-				}
-			}
-			break;
 		case KEY_PRESS:
 			keys->key = keycode;
 			keys->event = KEY_MOD_DOWN | KEY_MOD_PRESS;
@@ -37,6 +37,7 @@
 #include "hardware/HR-C6000.h"
 #include "functions/sound.h"
 #include "hardware/SPI_Flash.h"
+#include "hardware/EEPROM.h"
 #include "user_interface/uiLocalisation.h"
 #include "functions/rxPowerSaving.h"
 #include "main.h"
@@ -47,6 +48,7 @@
 // for debug mode
 #include "hardware/radioHardwareInterface.h"
 #include "hardware/AT1846S.h"
+#include "io/keyboard.h"
 
 
 
@@ -139,7 +141,7 @@ void tick_com_request(void)
 				com_request = 0;
 				if (hasToReply)
 				{
-					CDC_Transmit_FS((uint8_t *) usbComSendBuf, replyLength);
+					CDC_TransmitDirect_FS((uint8_t *) usbComSendBuf, replyLength); // The CPS waits for the reply before sending a new request
 					hasToReply = false;
 					replyLength = 0;
 				}
@@ -196,6 +198,11 @@ static void cpsHandleReadCommand(void)
 			else
 			{
 				TASK_UNLOCK_WRITE();
+				// The emulated EEPROM is read as is, flush its journal first
+				if (address < EMULATED_EEPROM_SIZE)
+				{
+					EEPROM_Sync();
+				}
 				result = SPI_Flash_read(address, (uint8_t *)&usbComSendBuf[3], length);
 				uint32_t end = address + length - 1;
 				const uint32_t VFOs_END = CODEPLUG_ADDR_VFO_A_CHANNEL + (sizeof(struct_codeplugChannel_t) * 2);
@@ -429,6 +436,11 @@ static void cpsHandleWriteCommand(void)
 				}
 
 				TASK_UNLOCK_WRITE();
+				// The emulated EEPROM is going to be rewritten as is, flush its journal first
+				if ((sector * 4096) < EMULATED_EEPROM_SIZE)
+				{
+					EEPROM_Sync();
+				}
 				ok = SPI_Flash_read(sector * 4096, SPI_Flash_sectorbuffer, 4096);
 				TASK_LOCK_WRITE();
 			}
@@ -528,6 +540,7 @@ static void cpsHandleWriteCommand(void)
 						uint8_t *p = calibrationGetLocalDataPointer();
 
 						memcpy((p + (address - 0x10000)), (uint8_t *)&com_requestbuffer[8], length);
+						calibrationInvalidateSnapshots();
 						sector = -2; // special case in Flash Write;
 						ok = true;
 						break;
@@ -653,7 +666,8 @@ static void cpsHandleWriteCommand(void)
 				uint32_t address = (com_requestbuffer[2] << 24) + (com_requestbuffer[3] << 16) + (com_requestbuffer[4] << 8) + (com_requestbuffer[5] << 0);
 				uint32_t length = (com_requestbuffer[6] << 8) + (com_requestbuffer[7] << 0);
 
-				wavbuffer_count = (address + length) / WAV_BUFFER_SIZE;
+				ringBufferReset(&wavbufferRing);
+				ringBufferCommitWrite(&wavbufferRing, SAFE_MIN(((address + length) / WAV_BUFFER_SIZE), WAV_BUFFER_COUNT));
 				memcpy((uint8_t *)&audioAndHotspotDataBuffer.rawBuffer[address], (uint8_t *)&com_requestbuffer[8], length);
 				ok = true;
 			}
@@ -909,6 +923,10 @@ static void cpsHandleCommand(void)
 							TASK_LOCK_WRITE();
 						}
 
+						TASK_UNLOCK_WRITE();
+						SPI_Flash_sync();
+						TASK_LOCK_WRITE();
+
 						// Give it a bit of time before pulling the plug as DM-1801 EEPROM looks slower
 						// than GD-77 to write, then quickly power cycling triggers settings reset.
 						while (true)
@@ -932,6 +950,9 @@ static void cpsHandleCommand(void)
 							nonVolatileSettings.gps = previousGPSState;
 						}
 #endif
+						TASK_UNLOCK_WRITE();
+						SPI_Flash_sync();
+						TASK_LOCK_WRITE();
 						addTimerCallback(NVIC_SystemReset, 500, MENU_ANY, false);
 						break;
 					case 2:
@@ -1167,7 +1188,9 @@ static void handleDebugRequest(void)
 
 							}
 
+							keyboardScanSuspend();
 							HAL_GPIO_Init(port, &GPIO_InitStruct);
+							keyboardScanResume();
 
 							sprintf((char *)usbComSendBuf, "Input %c%d = %s\n", portLetter, num, HAL_GPIO_ReadPin(port, 1<<num)?"High\n":"Low\n");
 						}
@@ -1181,7 +1204,9 @@ static void handleDebugRequest(void)
 							GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;//GPIO_MODE_INPUT;//GPIO_MODE_OUTPUT_PP;//;
 							GPIO_InitStruct.Pull = GPIO_NOPULL;//GPIO_PULLDOWN;//GPIO_PULLUP;//GPIO_PULLDOWN; GPIO_NOPULL;
 							GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+							keyboardScanSuspend();
 							HAL_GPIO_Init(port, &GPIO_InitStruct);
+							keyboardScanResume();
 
 							HAL_GPIO_WritePin(port,1<<num, GPIO_PIN_RESET);
 							sprintf((char *)usbComSendBuf, "Output %c%d = Low\n",portLetter ,num);
@@ -1268,11 +1293,15 @@ static void handleDebugRequest(void)
 				GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
 				GPIO_InitStruct.Pull = GPIO_PULLDOWN;
 
+				keyboardScanSuspend();
+
 				GPIO_InitStruct.Pin = LCD_D0_Pin | LCD_D1_Pin | LCD_D2_Pin | LCD_D3_Pin;
 				HAL_GPIO_Init(GPIOD, &GPIO_InitStruct);
 
 				GPIO_InitStruct.Pin = LCD_D4_Pin | LCD_D5_Pin | LCD_D6_Pin | LCD_D7_Pin;
 				HAL_GPIO_Init(GPIOE, &GPIO_InitStruct);
+
+				keyboardScanResume();
 			}
 			sprintf((char *)usbComSendBuf, settingsUsbModeDebugHaltRenderingKeypad?"Halt\n":"Resume\n");
 			CDC_Transmit_FS((uint8_t *) usbComSendBuf, strlen((char *)usbComSendBuf));
@@ -116,6 +116,22 @@ static int directChannelNumber = 0;
 static struct_codeplugChannel_t scanNextChannelData = { .rxFreq = 0 };
 static bool scanNextChannelReady = false;
 static int scanNextChannelIndex = 0;
+// Scan plan: scannable channels of the current zone, resolved once when the scan starts.
+// Entries are zone positions (or channel indices in the All Channels zone), like scanNextChannelIndex, in ascending order.
+static struct
+{
+	uint16_t entries[CODEPLUG_CHANNELS_MAX];
+	int      count;
+} scanPlan = { .count = 0 };
+#if defined(PLATFORM_MD2017)
+// While the primary receiver dwells on the current channel, the secondary one listens to the next channel.
+static struct
+{
+	bool tuned;
+	bool activity;
+	int  samples;
+} scanLookAhead = { .tuned = false };
+#endif
 static bool scobAlreadyTriggered = false;
 static bool quickmenuChannelFromVFOHandled = false; // Quickmenu new channel confirmation window
 
@@ -180,6 +196,9 @@ menuStatus_t uiChannelMode(uiEvent_t *ev, bool isFirstRun)
 		settingsSet(nonVolatileSettings.initialMenuNumber, (uint8_t) UI_CHANNEL_MODE);// This menu.
 		uiDataGlobal.displayChannelSettings = false;
 		scanNextChannelReady = false;
+#if defined(PLATFORM_MD2017)
+		scanLookAhead.tuned = false;
+#endif
 		uiDataGlobal.Scan.refreshOnEveryStep = false;
 
 		uiDataGlobal.displayQSOState = QSO_DISPLAY_DEFAULT_SCREEN;
@@ -374,122 +393,162 @@ static void hidesChannelDetails(void)
 	}
 }
 
-static bool canCurrentZoneBeScanned(int *availableChannels)
+static int scanPlanGetChannelIndex(int entry)
 {
-	int enabledChannels = 0;
-	int chanIdx = codeplugGetLastUsedChannelNumberInCurrentZone();
-
-	if (currentZone.NOT_IN_CODEPLUGDATA_numChannelsInZone > 1)
-	{
-		int chansInZone = currentZone.NOT_IN_CODEPLUGDATA_numChannelsInZone;
-
-		if (CODEPLUG_ZONE_IS_ALLCHANNELS(currentZone))
-		{
-			do
-			{
-				do
-				{
-					chanIdx = ((chanIdx % currentZone.NOT_IN_CODEPLUGDATA_highestIndex) + 1);
-				} while (!codeplugAllChannelsIndexIsInUse(chanIdx));
+	return (CODEPLUG_ZONE_IS_ALLCHANNELS(currentZone) ? entry : currentZone.channels[entry]);
+}
 
-				chansInZone--;
-				// Get flag4 only
-				codeplugChannelGetDataWithOffsetAndLengthForIndex(chanIdx, &scanNextChannelData, CODEPLUG_CHANNEL_FLAG4_OFFSET, 1);
+// Skipped and out of band channels are filtered out, using the RAM summary of the channels.
+static void scanPlanBuild(void)
+{
+	bool allChannels = CODEPLUG_ZONE_IS_ALLCHANNELS(currentZone);
+	ChannelFlag_t skipFlag = (allChannels ? CHANNEL_FLAG_ALL_SKIP : CHANNEL_FLAG_ZONE_SKIP);
+	int firstEntry = (allChannels ? CODEPLUG_CHANNELS_MIN : 0);
+	int lastEntry = (allChannels ? currentZone.NOT_IN_CODEPLUGDATA_highestIndex : (currentZone.NOT_IN_CODEPLUGDATA_numChannelsInZone - 1));
 
-				if (codeplugChannelGetFlag(&scanNextChannelData, CHANNEL_FLAG_ALL_SKIP) == 0)
-				{
-					enabledChannels++;
-				}
+	scanPlan.count = 0;
 
-			} while (chansInZone > 0);
-		}
-		else
+	for (int entry = firstEntry; entry <= lastEntry; entry++)
+	{
+		if (allChannels && (codeplugAllChannelsIndexIsInUse(entry) == false))
 		{
-			do
-			{
-				chanIdx = ((chanIdx + 1) % currentZone.NOT_IN_CODEPLUGDATA_numChannelsInZone);
+			continue;
+		}
 
-				chansInZone--;
-				// Get flag4 only
-				codeplugChannelGetDataWithOffsetAndLengthForIndex(currentZone.channels[chanIdx], &scanNextChannelData, CODEPLUG_CHANNEL_FLAG4_OFFSET, 1);
+		const codeplugChannelSummary_t *summary = codeplugChannelGetSummaryForIndex(scanPlanGetChannelIndex(entry));
 
-				if (codeplugChannelGetFlag(&scanNextChannelData, CHANNEL_FLAG_ZONE_SKIP) == 0)
-				{
-					enabledChannels++;
-				}
+		// Get flag4 only, from the RAM summary
+		scanNextChannelData.flag4 = summary->flag4;
 
-			} while (chansInZone > 0);
+		if ((codeplugChannelGetFlag(&scanNextChannelData, skipFlag) == 0) && (trxGetBandFromFrequency(summary->rxFreq) != FREQUENCY_OUT_OF_BAND))
+		{
+			scanPlan.entries[scanPlan.count++] = entry;
 		}
 	}
+}
 
-	*availableChannels = enabledChannels;
+// Nuisance deleted channels won't be visited again until the scan is restarted.
+static void scanPlanRemoveChannel(int channelIndex)
+{
+	for (int i = 0; i < scanPlan.count; i++)
+	{
+		if (scanPlanGetChannelIndex(scanPlan.entries[i]) == channelIndex)
+		{
+			scanPlan.count--;
+			memmove(&scanPlan.entries[i], &scanPlan.entries[i + 1], ((scanPlan.count - i) * sizeof(scanPlan.entries[0])));
+			break;
+		}
+	}
 
-	return (enabledChannels > 1);
+	// Less than 2 channels remain in the Zone, just stop scanning
+	if (scanPlan.count < 2)
+	{
+		uiDataGlobal.Scan.lastIteration = true;
+	}
 }
 
-static void scanSearchForNextChannel(void)
+// Returns the plan entry after (or before, depending of the scan direction) the given one, with rollover.
+// The given entry doesn't need to be in the plan (e.g. it has been nuisance deleted, or it's a skipped channel selected by the user).
+static int scanPlanGetNextEntry(int entry)
 {
-	int channel = 0;
+	int low = 0;
+	int high = scanPlan.count;
 
-	// All Channels virtual zone
-	if (CODEPLUG_ZONE_IS_ALLCHANNELS(currentZone))
+	// Find the first entry greater than the given one.
+	while (low < high)
 	{
-		do
+		int mid = (low + high) >> 1;
+
+		if (scanPlan.entries[mid] <= entry)
 		{
-			do
-			{
-				// rollover (up/down) CODEPLUG_CHANNELS_MIN .. currentZone.NOT_IN_CODEPLUGDATA_highestIndex
-				scanNextChannelIndex = ((uiDataGlobal.Scan.direction == 1) ?
-						((scanNextChannelIndex % currentZone.NOT_IN_CODEPLUGDATA_highestIndex) + 1) :
-						((((scanNextChannelIndex - 1) + currentZone.NOT_IN_CODEPLUGDATA_highestIndex - 1) % currentZone.NOT_IN_CODEPLUGDATA_highestIndex) + 1));
-			} while (!codeplugAllChannelsIndexIsInUse(scanNextChannelIndex));
+			low = mid + 1;
+		}
+		else
+		{
+			high = mid;
+		}
+	}
 
-			// Check if the channel is skipped.
-			// Get flag4 only
-			codeplugChannelGetDataWithOffsetAndLengthForIndex(scanNextChannelIndex, &scanNextChannelData, CODEPLUG_CHANNEL_FLAG4_OFFSET, 1);
+	if (uiDataGlobal.Scan.direction == 1)
+	{
+		return scanPlan.entries[((low < scanPlan.count) ? low : 0)];
+	}
 
-		} while ((codeplugChannelGetFlag(&scanNextChannelData, CHANNEL_FLAG_ALL_SKIP) != 0));
+	int position = (((low > 0) && (scanPlan.entries[low - 1] == entry)) ? (low - 2) : (low - 1));
 
-		channel = scanNextChannelIndex;
-		codeplugChannelGetDataForIndex(scanNextChannelIndex, &scanNextChannelData);
-	}
-	else
+	return scanPlan.entries[((position >= 0) ? position : (scanPlan.count - 1))];
+}
+
+static void scanSearchForNextChannel(void)
+{
+	if (scanPlan.count == 0)
 	{
-		do
-		{
-			// rollover (up/down) 0 .. (currentZone.NOT_IN_CODEPLUGDATA_highestIndex - 1)
-			scanNextChannelIndex = ((uiDataGlobal.Scan.direction == 1) ?
-					((scanNextChannelIndex + 1) % currentZone.NOT_IN_CODEPLUGDATA_numChannelsInZone) :
-					((scanNextChannelIndex + currentZone.NOT_IN_CODEPLUGDATA_numChannelsInZone - 1) % currentZone.NOT_IN_CODEPLUGDATA_numChannelsInZone));
+		return;
+	}
 
-			// Check if the channel is skipped.
-			// Get flag4 only
-			codeplugChannelGetDataWithOffsetAndLengthForIndex(currentZone.channels[scanNextChannelIndex], &scanNextChannelData, CODEPLUG_CHANNEL_FLAG4_OFFSET, 1);
+	scanNextChannelIndex = scanPlanGetNextEntry(scanNextChannelIndex);
+	codeplugChannelGetDataForIndex(scanPlanGetChannelIndex(scanNextChannelIndex), &scanNextChannelData);
 
-		} while ((codeplugChannelGetFlag(&scanNextChannelData, CHANNEL_FLAG_ZONE_SKIP) != 0));
+	// The hop only has to apply the calibration then, for the Tx frequency it will set (see the trxSetFrequency() call
+	// in uiChannelModeLoadChannelData()). Only one channel ahead, so a scan plan larger than the cache can't thrash it.
+	uint32_t rxFreq = (uiDataGlobal.reverseRepeaterChannel ? scanNextChannelData.txFreq : scanNextChannelData.rxFreq);
+	calibrationPrefillSnapshotForFrequency(uiDataGlobal.talkaround ? rxFreq : (uiDataGlobal.reverseRepeaterChannel ? scanNextChannelData.rxFreq : scanNextChannelData.txFreq));
 
-		channel = currentZone.channels[scanNextChannelIndex];
-		codeplugChannelGetDataForIndex(currentZone.channels[scanNextChannelIndex], &scanNextChannelData);
-	}
+	scanNextChannelReady = true;
+}
 
-	//check all nuisance delete entries and skip channel if there is a match
-	for (int i = 0; i < MAX_ZONE_SCAN_NUISANCE_CHANNELS; i++)
+// In DIGITAL Slow mode, we need at least 120ms to see the HR-C6000 to start the TS ISR.
+static int scanGetDwellTime(int mode, int dmrModeRx)
+{
+	if (mode == RADIO_MODE_DIGITAL)
 	{
-		if (uiDataGlobal.Scan.nuisanceDelete[i] == -1)
+		int dwellTime;
+		if(uiDataGlobal.Scan.stepTimeMilliseconds > 150)				// if >150ms use DMR Slow mode
 		{
-			break;
+			dwellTime = ((dmrModeRx == DMR_MODE_DMO) ? SCAN_DMR_SIMPLEX_SLOW_MIN_DWELL_TIME : SCAN_DMR_DUPLEX_SLOW_MIN_DWELL_TIME);
 		}
 		else
 		{
-			if(uiDataGlobal.Scan.nuisanceDelete[i] == channel)
-			{
-				return;
-			}
+			dwellTime = ((dmrModeRx == DMR_MODE_DMO) ? SCAN_DMR_SIMPLEX_FAST_MIN_DWELL_TIME : (SCAN_DMR_DUPLEX_FAST_MIN_DWELL_TIME + SCAN_DMR_DUPLEX_FAST_EXTRA_DWELL_TIME));
 		}
+
+		return ((uiDataGlobal.Scan.stepTimeMilliseconds < dwellTime) ? dwellTime : uiDataGlobal.Scan.stepTimeMilliseconds);
 	}
 
-	scanNextChannelReady = true;
+	return uiDataGlobal.Scan.stepTimeMilliseconds;
+}
+
+#if defined(PLATFORM_MD2017)
+static void scanLookAheadTune(void)
+{
+	scanLookAhead.activity = false;
+	scanLookAhead.samples = 0;
+
+	// DMR Slow mode relies on the HR-C6000 sync, which is only wired to the primary receiver,
+	// so only the carrier based detections (FM, and DMR Fast mode) can be done ahead.
+	scanLookAhead.tuned = ((scanNextChannelData.chMode == RADIO_MODE_ANALOG) || (uiDataGlobal.Scan.stepTimeMilliseconds <= 150));
+
+	if (scanLookAhead.tuned)
+	{
+		radioSetSecondaryReceiverChannel(scanNextChannelData.rxFreq, scanNextChannelData.chMode,
+				((scanNextChannelData.chMode == RADIO_MODE_ANALOG) && (codeplugChannelGetFlag(&scanNextChannelData, CHANNEL_FLAG_BW_25K) != 0)));
+	}
+}
+
+// The next channel can be skipped if it has been listened to, without any carrier, for as long as the primary receiver would have done.
+static bool scanLookAheadCanSkipNextChannel(void)
+{
+	if ((scanLookAhead.tuned == false) || scanLookAhead.activity)
+	{
+		return false;
+	}
+
+	int dmrModeRx = (((scanNextChannelData.rxFreq == scanNextChannelData.txFreq) || codeplugChannelGetFlag(&scanNextChannelData, CHANNEL_FLAG_FORCE_DMO)) ? DMR_MODE_DMO : DMR_MODE_RMO);
+	int listeningTime = scanGetDwellTime(scanNextChannelData.chMode, dmrModeRx) - (SCAN_FREQ_CHANGE_SETTLING_INTERVAL + SCAN_SKIP_CHANNEL_INTERVAL + 1);
+
+	return (scanLookAhead.samples >= listeningTime);
 }
+#endif
 
 static void scanApplyNextChannel(void)
 {
@@ -503,25 +562,7 @@ static void scanApplyNextChannel(void)
 	uiDataGlobal.displayQSOState = QSO_DISPLAY_DEFAULT_SCREEN;
 	uiChannelModeUpdateScreen(0);
 
-	// In DIGITAL Slow mode, we need at least 120ms to see the HR-C6000 to start the TS ISR.
-	if (trxGetMode() == RADIO_MODE_DIGITAL)
-	{
-		int dwellTime;
-		if(uiDataGlobal.Scan.stepTimeMilliseconds > 150)				// if >150ms use DMR Slow mode
-		{
-			dwellTime = ((currentRadioDevice->trxDMRModeRx == DMR_MODE_DMO) ? SCAN_DMR_SIMPLEX_SLOW_MIN_DWELL_TIME : SCAN_DMR_DUPLEX_SLOW_MIN_DWELL_TIME);
-		}
-		else
-		{
-			dwellTime = ((currentRadioDevice->trxDMRModeRx == DMR_MODE_DMO) ? SCAN_DMR_SIMPLEX_FAST_MIN_DWELL_TIME : (SCAN_DMR_DUPLEX_FAST_MIN_DWELL_TIME + SCAN_DMR_DUPLEX_FAST_EXTRA_DWELL_TIME));
-		}
-
-		uiDataGlobal.Scan.dwellTime = ((uiDataGlobal.Scan.stepTimeMilliseconds < dwellTime) ? dwellTime : uiDataGlobal.Scan.stepTimeMilliseconds);
-	}
-	else
-	{
-		uiDataGlobal.Scan.dwellTime = uiDataGlobal.Scan.stepTimeMilliseconds;
-	}
+	uiDataGlobal.Scan.dwellTime = scanGetDwellTime(trxGetMode(), currentRadioDevice->trxDMRModeRx);
     if (codeplugChannelGetFlag(currentChannelData, CHANNEL_FLAG_PRIORITY) != 0)
     {
     	priorityMultiplier = nonVolatileSettings.scanPriority;
@@ -533,6 +574,9 @@ static void scanApplyNextChannel(void)
 	uiDataGlobal.Scan.timer.timeout = uiDataGlobal.Scan.dwellTime;
 	uiDataGlobal.Scan.state = SCAN_STATE_SCANNING;
 	scanNextChannelReady = false;
+#if defined(PLATFORM_MD2017)
+	scanLookAhead.tuned = false;
+#endif
 }
 
 void uiChannelModeLoadChannelData(bool useChannelDataInMemory, bool loadVoicePromptAnnouncement)
@@ -1091,14 +1135,7 @@ static void handleEvent(uiEvent_t *ev)
 #endif
 			)
 			{
-				// There is two channels available in the Zone, just stop scanning
-				if (uiDataGlobal.Scan.nuisanceDeleteIndex == (uiDataGlobal.Scan.availableChannelsCount - 2))
-				{
-					uiDataGlobal.Scan.lastIteration = true;
-				}
-
-				uiDataGlobal.Scan.nuisanceDelete[uiDataGlobal.Scan.nuisanceDeleteIndex] = uiDataGlobal.currentSelectedChannelNumber;
-				uiDataGlobal.Scan.nuisanceDeleteIndex = (uiDataGlobal.Scan.nuisanceDeleteIndex + 1) % MAX_ZONE_SCAN_NUISANCE_CHANNELS;
+				scanPlanRemoveChannel(uiDataGlobal.currentSelectedChannelNumber);
 				uiDataGlobal.Scan.timer.timeout = SCAN_SKIP_CHANNEL_INTERVAL;	//force scan to continue;
 				uiDataGlobal.Scan.state = SCAN_STATE_SCANNING;
 				keyboardReset();
@@ -1890,6 +1927,9 @@ static void handleUpKey(uiEvent_t *ev)
 		{
 			scanNextChannelIndex = nextChan;
 			scanNextChannelReady = true;
+#if defined(PLATFORM_MD2017)
+			scanLookAhead.tuned = false;
+#endif
 		}
 
 		uiDataGlobal.Scan.timer.timeout = (uiDataGlobal.Scan.active ? 0 : 500); // when scanning is running, don't let it pick another channel
@@ -1977,6 +2017,9 @@ static void handleDownKey(uiEvent_t *ev)
 		{
 			scanNextChannelIndex = prevChan;
 			scanNextChannelReady = true;
+#if defined(PLATFORM_MD2017)
+			scanLookAhead.tuned = false;
+#endif
 		}
 
 		uiDataGlobal.Scan.timer.timeout = (uiDataGlobal.Scan.active ? 0 : 500); // when scanning is running, don't let it pick another channel
@@ -2576,8 +2619,11 @@ static void handleQuickMenuEvent(uiEvent_t *ev)
 //Scan Mode
 static void scanStart(bool longPressBeep)
 {
+	scanPlanBuild();
+	uiDataGlobal.Scan.availableChannelsCount = scanPlan.count;
+
 	// At least two channels are needed to run a scan process.
-	if (canCurrentZoneBeScanned(&uiDataGlobal.Scan.availableChannelsCount) == false)
+	if (scanPlan.count < 2)
 	{
 		menuChannelExitStatus |= MENU_STATUS_ERROR;
 		return;
@@ -2592,38 +2638,13 @@ static void scanStart(bool longPressBeep)
 	uiDataGlobal.Scan.direction = 1;
 	uiDataGlobal.talkaround = false;
 
-	// Clear all nuisance delete channels at start of scanning
-	for (int i = 0; i < MAX_ZONE_SCAN_NUISANCE_CHANNELS; i++)
-	{
-		uiDataGlobal.Scan.nuisanceDelete[i] = -1;
-	}
-	uiDataGlobal.Scan.nuisanceDeleteIndex = 0;
-
 	uiDataGlobal.Scan.active = true;
 	uiDataGlobal.Scan.state = SCAN_STATE_SCANNING;
 	uiDataGlobal.Scan.lastIteration = false;
 
 	uiDataGlobal.Scan.stepTimeMilliseconds = settingsGetScanStepTimeMilliseconds();
 
-	// In DIGITAL (slow) mode, we need at least 120ms to see the HR-C6000 to start the TS ISR.
-	if (trxGetMode() == RADIO_MODE_DIGITAL)
-	{
-		int dwellTime;
-		if(uiDataGlobal.Scan.stepTimeMilliseconds > 150)				// if >150ms use DMR Slow mode
-		{
-			dwellTime = ((currentRadioDevice->trxDMRModeRx == DMR_MODE_DMO) ? SCAN_DMR_SIMPLEX_SLOW_MIN_DWELL_TIME : SCAN_DMR_DUPLEX_SLOW_MIN_DWELL_TIME);
-		}
-		else
-		{
-			dwellTime = ((currentRadioDevice->trxDMRModeRx == DMR_MODE_DMO) ? SCAN_DMR_SIMPLEX_FAST_MIN_DWELL_TIME : (SCAN_DMR_DUPLEX_FAST_MIN_DWELL_TIME + SCAN_DMR_DUPLEX_FAST_EXTRA_DWELL_TIME));
-		}
-
-		uiDataGlobal.Scan.dwellTime = ((uiDataGlobal.Scan.stepTimeMilliseconds < dwellTime) ? dwellTime : uiDataGlobal.Scan.stepTimeMilliseconds);
-	}
-	else
-	{
-		uiDataGlobal.Scan.dwellTime = uiDataGlobal.Scan.stepTimeMilliseconds;
-	}
+	uiDataGlobal.Scan.dwellTime = scanGetDwellTime(trxGetMode(), currentRadioDevice->trxDMRModeRx);
 
 	uiDataGlobal.Scan.timer.timeout = uiDataGlobal.Scan.dwellTime;
 	uiDataGlobal.Scan.scanType = SCAN_TYPE_NORMAL_STEP;
@@ -2635,9 +2656,12 @@ static void scanStart(bool longPressBeep)
 		soundSetMelody(MELODY_KEY_LONG_BEEP);
 	}
 
-	// Set current channel index
-	scanNextChannelIndex = codeplugGetLastUsedChannelNumberInCurrentZone();
+	// Set current channel index (zone position, or channel index in the All Channels zone)
+	scanNextChannelIndex = codeplugGetLastUsedChannelInCurrentZone();
 	scanNextChannelReady = false;
+#if defined(PLATFORM_MD2017)
+	scanLookAhead.tuned = false;
+#endif
 }
 
 static void updateTrxID(void)
@@ -2678,6 +2702,20 @@ static void scanning(void)
 	// After initial settling time
 	if((uiDataGlobal.Scan.state == SCAN_STATE_SCANNING) && (uiDataGlobal.Scan.timer.timeout > SCAN_SKIP_CHANNEL_INTERVAL) && (uiDataGlobal.Scan.timer.timeout < (uiDataGlobal.Scan.dwellTime - SCAN_FREQ_CHANGE_SETTLING_INTERVAL)))
 	{
+#if defined(PLATFORM_MD2017)
+		if (scanLookAhead.tuned)
+		{
+			trxReadRSSIAndNoise(false);
+
+			if (trxCarrierDetectedOnChannel(RADIO_DEVICE_SECONDARY, &scanNextChannelData))
+			{
+				scanLookAhead.activity = true;
+			}
+
+			scanLookAhead.samples++;
+		}
+#endif
+
 		//Signal detect for DMR channels
 		if (trxGetMode() == RADIO_MODE_DIGITAL)
 		{
@@ -2800,6 +2838,12 @@ static void scanning(void)
 		if (scanNextChannelReady == false)
 		{
 			scanSearchForNextChannel();
+#if defined(PLATFORM_MD2017)
+			if (scanNextChannelReady)
+			{
+				scanLookAheadTune();
+			}
+#endif
 		}
 
 		uiDataGlobal.Scan.timer.timeout--;
@@ -2811,6 +2855,32 @@ static void scanning(void)
 			uiDataGlobal.Scan.timer.timeout = uiDataGlobal.Scan.stepTimeMilliseconds;
 			priorityMultiplier --;
 		}
+#if defined(PLATFORM_MD2017)
+		else if (scanNextChannelReady && scanLookAheadCanSkipNextChannel())
+		{
+			// Nothing has been heard on the next channel, move straight to the one after it.
+			scanNextChannelReady = false;
+			scanSearchForNextChannel();
+
+			if (scanNextChannelReady)
+			{
+				hidesChannelDetails();
+				priorityMultiplier = 1;
+				scanApplyNextChannel();
+
+				// When less than 2 channel remain in the Zone
+				if (uiDataGlobal.Scan.lastIteration)
+				{
+					scanStop(false);
+					return;
+				}
+			}
+			else
+			{
+				uiDataGlobal.Scan.timer.timeout = 1;
+			}
+		}
+#endif
 		else if (scanNextChannelReady)
 		{
 			hidesChannelDetails();
@@ -3756,14 +3826,7 @@ static void handleEventForGD77S(uiEvent_t *ev)
 						// if we are scanning and down key is pressed then enter current channel into nuisance delete array.
 						if(uiDataGlobal.Scan.state == SCAN_STATE_PAUSED)
 						{
-							// There is two channels available in the Zone, just stop scanning
-							if (uiDataGlobal.Scan.nuisanceDeleteIndex == (uiDataGlobal.Scan.availableChannelsCount - 2))
-							{
-								uiDataGlobal.Scan.lastIteration = true;
-							}
-
-							uiDataGlobal.Scan.nuisanceDelete[uiDataGlobal.Scan.nuisanceDeleteIndex] = uiDataGlobal.currentSelectedChannelNumber;
-							uiDataGlobal.Scan.nuisanceDeleteIndex = (uiDataGlobal.Scan.nuisanceDeleteIndex + 1) % MAX_ZONE_SCAN_NUISANCE_CHANNELS;
+							scanPlanRemoveChannel(uiDataGlobal.currentSelectedChannelNumber);
 							uiDataGlobal.Scan.timer.timeout = SCAN_SKIP_CHANNEL_INTERVAL;	//force scan to continue;
 							uiDataGlobal.Scan.state = SCAN_STATE_SCANNING;
 							return;
@@ -63,7 +63,36 @@ const uint32_t DMRID_MEMORY_LOCATION_1 = 0x30000 + FLASH_ADDRESS_OFFSET;
 const uint32_t DMRID_MEMORY_LOCATION_2 = 0xB8000 + FLASH_ADDRESS_OFFSET;
 uint32_t dmrIDDatabaseMemoryLocation2 = DMRID_MEMORY_LOCATION_2;
 
-static dmrIDsCache_t dmrIDsCache;
+#if defined(PLATFORM_MDUV380) || defined(PLATFORM_MD380) || defined(PLATFORM_RT84_DM1701) || defined(PLATFORM_MD2017)
+static  __attribute__((section(".ccmram")))
+#else // MD9600 and MK22
+static  __attribute__((section(".data.$RAM2")))
+#endif
+dmrIDsCache_t dmrIDsCache;
+
+// Most recently looked up IDs, found or not, already decoded
+typedef struct
+{
+	uint32_t			targetId;
+	dmrIdDataStruct_t	record;
+	uint32_t			lastUse;
+	bool				found;
+	bool				valid;
+} dmrIDLookupCacheEntry_t;
+
+static struct
+{
+	dmrIDLookupCacheEntry_t	entries[DMRID_LOOKUP_CACHE_SIZE];
+	uint32_t				useCounter;
+	uint32_t				hits;
+	uint32_t				misses;
+} dmrIDLookupCache;
+
+// Records read by a dmrIDLookupInFlash() probe. Kept out of the stack as it's large, which makes the lookup
+// non reentrant: like dmrIDLookupCache, it assumes dmrIDLookup() is only ever called from the UI task.
+// In main RAM, as the Flash reads can use DMA.
+static uint8_t dmrIDLookupWindowBuf[DMRID_INDEX_WINDOW_SIZE];
+
 static uint32_t lastTG = 0;
 
 volatile uint32_t lastID = 0;// This needs to be volatile as lastHeardClearLastID() is called from an ISR
@@ -1024,6 +1053,32 @@ static bool dmrIDReadContactInFlash(uint32_t contactOffset, uint8_t *data, uint3
 	return SPI_Flash_read(address, data, len);
 }
 
+// Read a run of consecutive records, splitting the read if it spans both storage locations
+static bool dmrIDReadContactsInFlash(uint32_t firstRecord, uint32_t count, uint8_t *data)
+{
+	uint32_t offset = (dmrIDsCache.contactLength * firstRecord);
+	uint32_t len = (dmrIDsCache.contactLength * count);
+
+	if ((offset < dmrIdDataArea_1_Size) && ((offset + len) > dmrIdDataArea_1_Size))
+	{
+		uint32_t firstLen = (dmrIdDataArea_1_Size - offset);
+
+		return (dmrIDReadContactInFlash(offset, data, firstLen) &&
+				dmrIDReadContactInFlash(dmrIdDataArea_1_Size, (data + firstLen), (len - firstLen)));
+	}
+
+	return dmrIDReadContactInFlash(offset, data, len);
+}
+
+static uint32_t dmrIDReadIDInFlash(uint32_t record)
+{
+	uint32_t id = 0;
+
+	dmrIDReadContactInFlash((dmrIDsCache.contactLength * record), (uint8_t *)&id, DMRID_IdLength);
+
+	return id;
+}
+
 void dmrIDCacheInit(void)
 {
 	uint8_t headerBuf[32];
@@ -1051,49 +1106,43 @@ void dmrIDCacheInit(void)
 
 	dmrIDsCache.contactLength = (uint8_t)headerBuf[3] - 0x4a;
 	// Check that data in DMR ID DB does not have a larger record size than the code has
-	if (dmrIDsCache.contactLength > sizeof(dmrIdDataStruct_t))
+	if ((dmrIDsCache.contactLength > sizeof(dmrIdDataStruct_t)) || (dmrIDsCache.contactLength <= DMRID_IdLength))
 	{
+		dmrIDsCache.contactLength = 0;
 		return;
 	}
 
-	dmrIDsCache.entries = ((uint32_t)headerBuf[8] | (uint32_t)headerBuf[9] << 8 | (uint32_t)headerBuf[10] << 16 | (uint32_t)headerBuf[11] << 24);
+	uint32_t entries = ((uint32_t)headerBuf[8] | (uint32_t)headerBuf[9] << 8 | (uint32_t)headerBuf[10] << 16 | (uint32_t)headerBuf[11] << 24);
 
 	// Size of number of complete DMR ID records for the first storage location
 	dmrIdDataArea_1_Size = (dmrIDsCache.contactLength * ((0x40000 - DMRID_HEADER_LENGTH) / dmrIDsCache.contactLength));
 
-	if (dmrIDsCache.entries > 0)
+	if (entries > 0)
 	{
-		dmrIdDataStruct_t dmrIDContact;
-
 		// Set Min and Max IDs boundaries
-		// First available ID
+		dmrIDsCache.minID = dmrIDReadIDInFlash(0);
+		dmrIDsCache.maxID = dmrIDReadIDInFlash(entries - 1);
 
-		dmrIDContact.id = 0;
-		dmrIDReadContactInFlash(0, (uint8_t *)&dmrIDContact, DMRID_IdLength);
-		dmrIDsCache.slices[0] = dmrIDContact.id;
+		// Build the index: the first ID of every block of IDsPerBlock records.
+		// Small DBs get one record per block, hence the whole DB is indexed.
+		dmrIDsCache.IDsPerBlock = ((entries + (DMRID_INDEX_SIZE - 1)) / DMRID_INDEX_SIZE);
+		dmrIDsCache.blocks = ((entries + (dmrIDsCache.IDsPerBlock - 1)) / dmrIDsCache.IDsPerBlock);
 
-		// Last available ID
-		dmrIDContact.id = 0;
-		dmrIDReadContactInFlash((dmrIDsCache.contactLength * (dmrIDsCache.entries - 1)), (uint8_t *)&dmrIDContact, DMRID_IdLength);
-		dmrIDsCache.slices[ID_SLICES - 1] = dmrIDContact.id;
-
-		if (dmrIDsCache.entries > MIN_ENTRIES_BEFORE_USING_SLICES)
+		dmrIDsCache.index[0] = dmrIDsCache.minID;
+		for (uint32_t i = 1; i < dmrIDsCache.blocks; i++)
 		{
-			dmrIDsCache.IDsPerSlice = dmrIDsCache.entries / (ID_SLICES - 1);
-
-			for (uint8_t i = 0; i < (ID_SLICES - 2); i++)
-			{
-				dmrIDContact.id = 0;
-				dmrIDReadContactInFlash((dmrIDsCache.contactLength * ((dmrIDsCache.IDsPerSlice * i) + dmrIDsCache.IDsPerSlice)), (uint8_t *)&dmrIDContact, DMRID_IdLength);
-				dmrIDsCache.slices[i + 1] = dmrIDContact.id;
-			}
+			dmrIDsCache.index[i] = dmrIDReadIDInFlash(dmrIDsCache.IDsPerBlock * i);
 		}
 	}
+
+	// Only publish the entries count once the index is complete, as dmrIDLookup() relies on it.
+	dmrIDsCache.entries = entries;
 }
 
 void dmrIDCacheClear(void)
 {
 	memset(&dmrIDsCache, 0, sizeof(dmrIDsCache_t));
+	memset(&dmrIDLookupCache.entries, 0, sizeof(dmrIDLookupCache.entries));
 }
 
 uint32_t dmrIDCacheGetCount(void)
@@ -1139,10 +1188,31 @@ static void dmrDbTextDecode(uint8_t *decompressedBufOut, uint8_t *compressedBufI
 	}
 }
 
-bool dmrIDLookup(uint32_t targetId, dmrIdDataStruct_t *foundRecord)
+static void dmrIDDecodeText(dmrIdDataStruct_t *foundRecord, uint8_t *textBuf)
+{
+	if (DMRID_IdLength == 3U)
+	{
+		dmrDbTextDecode((uint8_t *)foundRecord->text, textBuf, (dmrIDsCache.contactLength - DMRID_IdLength));
+	}
+	else
+	{
+		memcpy((uint8_t *)foundRecord->text, textBuf, (dmrIDsCache.contactLength - DMRID_IdLength));
+	}
+}
+
+// Value of a stored ID, used to interpolate its position within a range of records
+static uint32_t dmrIDKeyValue(uint32_t id)
+{
+	return ((DMRID_IdLength == 4U) ? bcd2int(id) : id);
+}
+
+// readFailed is set when the lookup couldn't complete, the returned not found being then meaningless
+static bool dmrIDLookupInFlash(uint32_t targetId, dmrIdDataStruct_t *foundRecord, bool *readFailed)
 {
 	uint32_t targetIdBCD;
 
+	*readFailed = false;
+
 	if (DMRID_IdLength == 4U)
 	{
 		targetIdBCD = int2bcd(targetId);
@@ -1152,115 +1222,169 @@ bool dmrIDLookup(uint32_t targetId, dmrIdDataStruct_t *foundRecord)
 		targetIdBCD = targetId;
 	}
 
-	if ((dmrIDsCache.entries > 0) && (targetIdBCD >= dmrIDsCache.slices[0]) && (targetIdBCD <= dmrIDsCache.slices[ID_SLICES - 1]))
+	if ((dmrIDsCache.entries > 0) && (targetIdBCD >= dmrIDsCache.minID) && (targetIdBCD <= dmrIDsCache.maxID))
 	{
-		uint32_t startPos = 0;
-		uint32_t endPos = dmrIDsCache.entries - 1;
+		uint32_t startPos;
+		uint32_t endPos;
 		uint32_t curPos;
+		uint32_t lowKey;
+		uint32_t highKey;
+		uint32_t block = 0;
+		uint32_t first = 0;
+		uint32_t last = dmrIDsCache.blocks - 1;
 
 		// Contact's text length == (dmrIDsCache.contactLength - DMRID_IdLength) aren't NULL terminated,
 		// so clearing the whole destination array is mandatory
 		memset(foundRecord->text, 0, sizeof(foundRecord->text));
 
-		uint8_t compressedBuf[MAX_DMR_ID_CONTACT_TEXT_LENGTH];// worst case length with no compression
-
-		if (dmrIDsCache.entries > MIN_ENTRIES_BEFORE_USING_SLICES) // Use slices
+		// Find the last block whose first ID is <= targetID, in RAM
+		while (first <= last)
 		{
-			for (uint8_t i = 0; i < ID_SLICES - 1; i++)
+			curPos = (first + last) >> 1;
+
+			if (dmrIDsCache.index[curPos] <= targetIdBCD)
 			{
-				// Check if ID is in slices boundaries, with a special case for the last slice as [ID_SLICES - 1] is the last ID
-				if ((targetIdBCD >= dmrIDsCache.slices[i]) &&
-						((i == ID_SLICES - 2) ? (targetIdBCD <= dmrIDsCache.slices[i + 1]) : (targetIdBCD < dmrIDsCache.slices[i + 1])))
+				block = curPos;
+				first = curPos + 1;
+			}
+			else
+			{
+				if (curPos == 0)
 				{
-					// targetID is the min slice limit, don't go further
-					if (targetIdBCD == dmrIDsCache.slices[i])
-					{
-						foundRecord->id = dmrIDsCache.slices[i];
+					break;
+				}
+				last = curPos - 1;
+			}
+		}
 
-						if (dmrIDReadContactInFlash((dmrIDsCache.contactLength * (dmrIDsCache.IDsPerSlice * i)) + DMRID_IdLength, (uint8_t *)&compressedBuf, (dmrIDsCache.contactLength - DMRID_IdLength)))
-						{
-							if (DMRID_IdLength == 3U)
-							{
-								dmrDbTextDecode((uint8_t *)foundRecord->text, (uint8_t *)&compressedBuf, (dmrIDsCache.contactLength - DMRID_IdLength));
-							}
-							else
-							{
-								memcpy((uint8_t *)foundRecord->text, (uint8_t *)&compressedBuf, (dmrIDsCache.contactLength - DMRID_IdLength));
-							}
-							return true;
-						}
-						else
-						{
-							goto spiReadFailure;
-						}
-					}
+		startPos = dmrIDsCache.IDsPerBlock * block;
+		endPos = (((block + 1) < dmrIDsCache.blocks) ? (startPos + dmrIDsCache.IDsPerBlock) : dmrIDsCache.entries) - 1;
+		lowKey = dmrIDsCache.index[block];
+		highKey = (((block + 1) < dmrIDsCache.blocks) ? dmrIDsCache.index[block + 1] : dmrIDsCache.maxID);
 
-					startPos = dmrIDsCache.IDsPerSlice * i;
-					endPos = (i == ID_SLICES - 2) ? (dmrIDsCache.entries - 1) : dmrIDsCache.IDsPerSlice * (i + 1);
+		// targetID is the first ID of the block, only its text needs to be read
+		if (targetIdBCD == lowKey)
+		{
+			uint8_t compressedBuf[MAX_DMR_ID_CONTACT_TEXT_LENGTH];// worst case length with no compression
 
-					break;
-				}
+			foundRecord->id = lowKey;
+
+			if (dmrIDReadContactInFlash((dmrIDsCache.contactLength * startPos) + DMRID_IdLength, compressedBuf, (dmrIDsCache.contactLength - DMRID_IdLength)))
+			{
+				dmrIDDecodeText(foundRecord, compressedBuf);
+				return true;
 			}
+
+			goto spiReadFailure;
 		}
-		else // Not enough contact to use slices
+
+		// Read a window of records around the interpolated position of the targetID.
+		// Most of the time the whole block, or the record itself, lies in the first window.
+		uint32_t windowRecords = (DMRID_INDEX_WINDOW_SIZE / dmrIDsCache.contactLength);
+
+		for (uint8_t probe = 0; (probe < DMRID_INDEX_WINDOW_PROBES) && (startPos <= endPos); probe++)
 		{
-			bool isMin;
+			uint32_t windowStart;
+			uint32_t windowCount;
+			uint32_t firstID = 0;
+			uint32_t lastID = 0;
 
-			// Check if targetID is equal to the first or the last in the IDs list
-			if ((isMin = (targetIdBCD == dmrIDsCache.slices[0])) || (targetIdBCD == dmrIDsCache.slices[ID_SLICES - 1]))
+			if ((endPos - startPos + 1) <= windowRecords)
 			{
-				foundRecord->id = dmrIDsCache.slices[(isMin ? 0 : (ID_SLICES - 1))];
+				windowStart = startPos;
+				windowCount = (endPos - startPos + 1);
+			}
+			else
+			{
+				uint32_t lowValue = dmrIDKeyValue(lowKey);
+				uint32_t highValue = dmrIDKeyValue(highKey);
+				uint32_t targetValue = dmrIDKeyValue(targetIdBCD);
 
-				if (dmrIDReadContactInFlash((dmrIDsCache.contactLength * (dmrIDsCache.IDsPerSlice * (isMin ? 0 : (ID_SLICES - 1)))) + DMRID_IdLength, (uint8_t *) &compressedBuf, (dmrIDsCache.contactLength - DMRID_IdLength)))
+				curPos = startPos;
+				if ((highValue > lowValue) && (targetValue > lowValue))
 				{
-					if (DMRID_IdLength == 3U)
-					{
-						dmrDbTextDecode((uint8_t *)foundRecord->text, (uint8_t *)&compressedBuf, (dmrIDsCache.contactLength - DMRID_IdLength));
-					}
-					else
-					{
-						memcpy((uint8_t *)foundRecord->text, (uint8_t *)&compressedBuf, (dmrIDsCache.contactLength - DMRID_IdLength));
-					}
+					curPos += (uint32_t)(((uint64_t)(targetValue - lowValue) * (endPos - startPos)) / (highValue - lowValue));
+				}
+
+				windowStart = ((curPos > (startPos + (windowRecords >> 1))) ? (curPos - (windowRecords >> 1)) : startPos);
+				if ((windowStart + windowRecords - 1) > endPos)
+				{
+					windowStart = (endPos - windowRecords + 1);
+				}
+				windowCount = windowRecords;
+			}
+
+			if (dmrIDReadContactsInFlash(windowStart, windowCount, dmrIDLookupWindowBuf) == false)
+			{
+				goto spiReadFailure;
+			}
 
+			for (uint32_t i = 0; i < windowCount; i++)
+			{
+				uint8_t *record = &dmrIDLookupWindowBuf[dmrIDsCache.contactLength * i];
+
+				foundRecord->id = 0;
+				memcpy(&foundRecord->id, record, DMRID_IdLength);
+
+				if (foundRecord->id == targetIdBCD)
+				{
+					dmrIDDecodeText(foundRecord, (record + DMRID_IdLength));
 					return true;
 				}
-				else
+
+				if (i == 0)
+				{
+					firstID = foundRecord->id;
+				}
+				lastID = foundRecord->id;
+			}
+
+			if (targetIdBCD < firstID)
+			{
+				if (windowStart == 0)
 				{
-					goto spiReadFailure;
+					goto notFound;
 				}
+				endPos = windowStart - 1;
+				highKey = firstID;
+			}
+			else if (targetIdBCD > lastID)
+			{
+				startPos = windowStart + windowCount;
+				lowKey = lastID;
+			}
+			else
+			{
+				// targetID would be in the window, but isn't
+				goto notFound;
 			}
 		}
 
-		// Look for the ID now
+		// Look for the ID now, in what is left of the block
 		while (startPos <= endPos)
 		{
 			curPos = (startPos + endPos) >> 1;
 
-			foundRecord->id = 0;
-
-			if (dmrIDReadContactInFlash((dmrIDsCache.contactLength * curPos), (uint8_t *)foundRecord, DMRID_IdLength))
+			if (dmrIDReadContactsInFlash(curPos, 1, dmrIDLookupWindowBuf))
 			{
+				foundRecord->id = 0;
+				memcpy(&foundRecord->id, dmrIDLookupWindowBuf, DMRID_IdLength);
+
 				if (foundRecord->id < targetIdBCD)
 				{
 					startPos = curPos + 1;
 				}
 				else if (foundRecord->id > targetIdBCD)
 				{
+					if (curPos == 0)
+					{
+						break;
+					}
 					endPos = curPos - 1;
 				}
 				else
 				{
-					dmrIDReadContactInFlash((dmrIDsCache.contactLength * curPos) + DMRID_IdLength, (uint8_t *)&compressedBuf, (dmrIDsCache.contactLength - DMRID_IdLength));
-
-					if (DMRID_IdLength == 3U)
-					{
-						dmrDbTextDecode((uint8_t *)foundRecord->text, (uint8_t *)&compressedBuf, (dmrIDsCache.contactLength - DMRID_IdLength));
-					}
-					else
-					{
-						memcpy((uint8_t *)foundRecord->text, (uint8_t *)&compressedBuf, (dmrIDsCache.contactLength - DMRID_IdLength));
-					}
-
+					dmrIDDecodeText(foundRecord, (dmrIDLookupWindowBuf + DMRID_IdLength));
 					return true;
 				}
 			}
@@ -1271,11 +1395,65 @@ bool dmrIDLookup(uint32_t targetId, dmrIdDataStruct_t *foundRecord)
 		}
 	}
 
+	notFound:
+	snprintf(foundRecord->text, MAX_DMR_ID_CONTACT_TEXT_LENGTH, "ID:%d", targetId);
+	return false;
+
 	spiReadFailure:
+	*readFailed = true;
 	snprintf(foundRecord->text, MAX_DMR_ID_CONTACT_TEXT_LENGTH, "ID:%d", targetId);
 	return false;
 }
 
+bool dmrIDLookup(uint32_t targetId, dmrIdDataStruct_t *foundRecord)
+{
+	dmrIDLookupCacheEntry_t *entry = &dmrIDLookupCache.entries[0];
+
+	dmrIDLookupCache.useCounter++;
+
+	for (uint32_t i = 0; i < DMRID_LOOKUP_CACHE_SIZE; i++)
+	{
+		dmrIDLookupCacheEntry_t *e = &dmrIDLookupCache.entries[i];
+
+		if (e->valid && (e->targetId == targetId))
+		{
+			e->lastUse = dmrIDLookupCache.useCounter;
+			dmrIDLookupCache.hits++;
+			memcpy(foundRecord, &e->record, sizeof(dmrIdDataStruct_t));
+			return e->found;
+		}
+
+		// Keep track of the least recently used entry, an empty one being the best choice
+		if (entry->valid && ((e->valid == false) || (e->lastUse < entry->lastUse)))
+		{
+			entry = e;
+		}
+	}
+
+	dmrIDLookupCache.misses++;
+
+	bool readFailed;
+	bool found = dmrIDLookupInFlash(targetId, foundRecord, &readFailed);
+
+	// Don't cache lookups made while the DB isn't available (e.g. not yet initialized), nor failed reads
+	if ((dmrIDsCache.entries > 0) && (readFailed == false))
+	{
+		entry->targetId = targetId;
+		memcpy(&entry->record, foundRecord, sizeof(dmrIdDataStruct_t));
+		entry->lastUse = dmrIDLookupCache.useCounter;
+		entry->found = found;
+		entry->valid = true;
+	}
+
+	return found;
+}
+
+void dmrIDLookupCacheGetStats(uint32_t *hits, uint32_t *misses)
+{
+	*hits = dmrIDLookupCache.hits;
+	*misses = dmrIDLookupCache.misses;
+}
+
 bool contactIDLookup(uint32_t id, uint32_t calltype, char *buffer)
 {
 	struct_codeplugContact_t contact;
@@ -0,0 +1,492 @@
+/*
+ * Copyright (C) 2019-2024 Roger Clark, VK3KYY / G4KYF
+ *                         Daniel Caujolle-Bert, F1RMB
+ *
+ * Low level DMR stream implementation informed by code written by
+ *                         DSD Author (anonymous)
+ *                         MBELib Author (anonymous)
+ *                         Ian Wraith G7GHH
+ *                         Jonathan Naylor G4KLX
+ *
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// The bool array BPTC(196,96), Hamming and embedded LC codecs, as they were in hotspot.c
+// before they got bit packed into functions/dmrFEC.c. Only kept as a reference for dmrFECTest.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "dmrFECReference.h"
+
+#define LC_DATA_LENGTH 12
+
+static uint8_t hammingGetBits(bool *inputOutputBooleanBitsArray, bool is16114);
+static void hammingEncode(bool *inputOutputBooleanBitsArray,bool is16114);
+static bool hammingDecodeType1(bool *inputOutputBooleanBitsArray);
+static bool hammingDecodeType2(bool *inputOutputBooleanBitsArray);
+static uint32_t CRC_encodeFiveBit(const bool *in);
+static void byteToBooleanBitsArray(uint8_t byteIn, bool *bitsOut);
+static uint8_t BooleanBitsArrayToByte(const bool *bitsIn);
+
+static const int BPTC19696CopyRanges[][2] = {{4,11},{16,26},{31,41},{46,56},{61,71},{76,86},{91,101},{106,116},{121,131}};
+static const int embedddataCopyRanges[][2] = {{0,10},{16,26},{32,41},{48,57},{64,73},{80,89},{96,105}};
+
+static bool embeddedDataRaw[128];
+static bool embeddedDataProcessed[72];
+static int embeddedDataFLCO;
+static bool embeddedDataIsValid;
+
+static bool BPTCRaw[196 + 8]; // BPTCdecode() writes one byte worth of bits past the 196 ones
+static bool BPTCDeInterleaved[196];
+
+static void BPTCdecode(const uint8_t *inputData, uint8_t *outputData)
+{
+	// 0xFF means don't use this value
+	const uint8_t BITS_LOOKUP[16] = {0xFF, 9, 10, 6, 11, 3, 7, 1, 12, 0xFF, 4, 0xFF, 8, 5, 2, 0};
+	bool bitData[96];
+	bool tmpArray[13];
+	uint32_t bitDataIndex = 0;
+	bool stillProcessing;
+	uint8_t n;
+
+	for (int i = 0; i < 13; i++)
+	{
+		byteToBooleanBitsArray(inputData[i], BPTCRaw + (i << 3));
+	}
+
+	byteToBooleanBitsArray(inputData[20], tmpArray);
+	BPTCRaw[98] = tmpArray[6];
+	BPTCRaw[99] = tmpArray[7];
+
+	for (int i = 0; i < 13; i++)
+	{
+		byteToBooleanBitsArray(inputData[i + 21], BPTCRaw + (100 + (i << 3)));
+	}
+
+	for (int i = 0; i < 196; i++)
+	{
+		BPTCDeInterleaved[i] = BPTCRaw[(i * 181) % 196];// interleave
+	}
+
+	stillProcessing = true;// Need to initially set this to true to start the for loop
+
+	for (int i = 0; ((i < 5) && stillProcessing); i++)
+	{
+		stillProcessing = false;
+
+		for (int j = 0; j < 15; j++)
+		{
+			int pos = j + 1;
+			for (int k = 0; k < 13; k++)
+			{
+				tmpArray[k] = BPTCDeInterleaved[pos];
+				pos += 15;
+			}
+
+			bool hammingOK = false;
+
+			n  = ((tmpArray[0] ^ tmpArray[1] ^ tmpArray[3] ^ tmpArray[5] ^ tmpArray[6]) != tmpArray[9])  ? 0x01 : 0x00;
+			n |= ((tmpArray[0] ^ tmpArray[1] ^ tmpArray[2] ^ tmpArray[4] ^ tmpArray[6] ^ tmpArray[7]) != tmpArray[10]) ? 0x02 : 0x00;
+			n |= ((tmpArray[0] ^ tmpArray[1] ^ tmpArray[2] ^ tmpArray[3] ^ tmpArray[5] ^ tmpArray[7] ^ tmpArray[8]) != tmpArray[11]) ? 0x04 : 0x00;
+			n |= ((tmpArray[0] ^ tmpArray[2] ^ tmpArray[4] ^ tmpArray[5] ^ tmpArray[8]) != tmpArray[12]) ? 0x08 : 0x00;
+
+			if (n < 16)
+			{
+				uint8_t bitLocation = BITS_LOOKUP[n];
+				if (bitLocation != 0xFF)
+				{
+					tmpArray[bitLocation] = !tmpArray[bitLocation];
+					hammingOK = true;
+				}
+			}
+
+			if (hammingOK)
+			{
+				pos = j + 1;
+				for (int k = 0; k < 13; k++)
+				{
+					BPTCDeInterleaved[pos] = tmpArray[k];
+					pos += 15;
+				}
+				stillProcessing = true;
+			}
+		}
+
+		for (int j = 0; j < 9; j++)
+		{
+			uint32_t pos = (j * 15) + 1;
+			if (hammingDecodeType2(BPTCDeInterleaved + pos))
+			{
+				stillProcessing = true;
+			}
+		}
+	}
+
+	for (int range = 0; range < 9; range++)
+	{
+		for (uint32_t a = BPTC19696CopyRanges[range][0]; a <= BPTC19696CopyRanges[range][1]; a++, bitDataIndex++)
+		{
+			bitData[bitDataIndex] = BPTCDeInterleaved[a];
+		}
+	}
+
+	for (int i = 0; i < LC_DATA_LENGTH; i++)
+	{
+		outputData[i] = BooleanBitsArrayToByte(bitData + (i << 3));
+	}
+}
+
+static void BPTCencode(const uint8_t *inputData, uint8_t *outputData)
+{
+	uint8_t byteData;
+	uint32_t bitDataPosition = 0;
+	bool bitData[96];
+	bool hammingBits[13];
+
+	for (int i = 0; i < LC_DATA_LENGTH; i++)
+	{
+		byteToBooleanBitsArray(inputData[i], bitData + (i << 3));
+	}
+
+	memset(BPTCDeInterleaved, 0, 196 * sizeof(bool));
+
+	for (int range = 0; range < 9; range++)
+	{
+		for (uint32_t a = BPTC19696CopyRanges[range][0]; a <= BPTC19696CopyRanges[range][1]; a++, bitDataPosition++)
+		{
+			BPTCDeInterleaved[a] = bitData[bitDataPosition];
+		}
+	}
+
+	for (int i = 0; i < 9; i++)
+	{
+		hammingEncode(BPTCDeInterleaved + ((i * 15) + 1), false);
+	}
+
+	for (int i = 0; i < 15; i++)
+	{
+		int pos = i + 1;
+		for (int j = 0; j < 13; j++)
+		{
+			hammingBits[j] = BPTCDeInterleaved[pos];
+			pos += 15;
+		}
+
+		hammingBits[9]  = hammingBits[0] ^ hammingBits[1] ^ hammingBits[3] ^ hammingBits[5] ^ hammingBits[6];
+		hammingBits[10] = hammingBits[0] ^ hammingBits[1] ^ hammingBits[2] ^ hammingBits[4] ^ hammingBits[6] ^ hammingBits[7];
+		hammingBits[11] = hammingBits[0] ^ hammingBits[1] ^ hammingBits[2] ^ hammingBits[3] ^ hammingBits[5] ^ hammingBits[7] ^ hammingBits[8];
+		hammingBits[12] = hammingBits[0] ^ hammingBits[2] ^ hammingBits[4] ^ hammingBits[5] ^ hammingBits[8];
+
+		pos = i + 1;
+		for (int j = 0; j < 13; j++)
+		{
+			BPTCDeInterleaved[pos] = hammingBits[j];
+			pos += 15;
+		}
+	}
+
+	for (int i = 0; i < 196; i++)
+	{
+		BPTCRaw[(i * 181) % 196] = BPTCDeInterleaved[i];// interleave
+	}
+
+	for (int i = 0; i < LC_DATA_LENGTH; i++)
+	{
+		outputData[i] = BooleanBitsArrayToByte(BPTCRaw + (i << 3));
+	}
+
+	byteData = BooleanBitsArrayToByte(BPTCRaw + 96);
+	outputData[12] = (outputData[12] & 0x3F) | ((byteData >> 0) & 0xC0);
+	outputData[20] = (outputData[20] & 0xFC) | ((byteData >> 4) & 0x03);
+
+	for (int i = 0; i < 12; i++)
+	{
+		outputData[i + 21] = BooleanBitsArrayToByte(BPTCRaw + 100 + (i << 3));
+	}
+}
+
+static bool hammingDecodeType2(bool *inputOutputBooleanBitsArray)
+{
+	const uint8_t BITS_LOOKUP[16] = {0xFF, 11, 12, 8, 13, 5, 9, 3, 14, 0, 6, 1, 10, 7, 4, 2};
+	uint8_t numBits = hammingGetBits(inputOutputBooleanBitsArray, false);
+
+	if (numBits < 16)
+	{
+		uint8_t bitLocation = BITS_LOOKUP[numBits];
+		if (bitLocation != 0xFF)
+		{
+			inputOutputBooleanBitsArray[bitLocation] = !inputOutputBooleanBitsArray[bitLocation];
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static bool hammingDecodeType1(bool *inputOutputBooleanBitsArray)
+{
+	// 0xFF means don't use this value. Also Index 0 is never used, its only here to reduce the number of if's
+	const uint8_t BITS_LOOKUP[32] = { 0xFF, 11, 12, 0xFF, 13, 0xFF, 0xFF, 3, 14, 0xFF, 0xFF, 1, 0xFF, 7, 4, 0xFF, 15, 0xFF, 0xFF, 8, 0xFF, 5, 9, 0xFF, 0xFF, 0, 6, 0xFF, 10, 0xFF ,0xFF, 2};
+
+	uint8_t c = hammingGetBits(inputOutputBooleanBitsArray, true);
+	if (c == 0)
+	{
+		return true;
+	}
+
+	if (c < 32)
+	{
+		uint8_t bitLocation = BITS_LOOKUP[c];
+		if (bitLocation != 0xFF)
+		{
+			inputOutputBooleanBitsArray[bitLocation] = !inputOutputBooleanBitsArray[bitLocation];
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void hammingEncode(bool *inputOutputBooleanBitsArray,bool is16114)
+{
+	inputOutputBooleanBitsArray[11] = inputOutputBooleanBitsArray[0] ^ inputOutputBooleanBitsArray[1] ^ inputOutputBooleanBitsArray[2] ^ inputOutputBooleanBitsArray[3] ^ inputOutputBooleanBitsArray[5] ^ inputOutputBooleanBitsArray[7] ^ inputOutputBooleanBitsArray[8];
+	inputOutputBooleanBitsArray[12] = inputOutputBooleanBitsArray[1] ^ inputOutputBooleanBitsArray[2] ^ inputOutputBooleanBitsArray[3] ^ inputOutputBooleanBitsArray[4] ^ inputOutputBooleanBitsArray[6] ^ inputOutputBooleanBitsArray[8] ^ inputOutputBooleanBitsArray[9];
+	inputOutputBooleanBitsArray[13] = inputOutputBooleanBitsArray[2] ^ inputOutputBooleanBitsArray[3] ^ inputOutputBooleanBitsArray[4] ^ inputOutputBooleanBitsArray[5] ^ inputOutputBooleanBitsArray[7] ^ inputOutputBooleanBitsArray[9] ^ inputOutputBooleanBitsArray[10];
+	inputOutputBooleanBitsArray[14] = inputOutputBooleanBitsArray[0] ^ inputOutputBooleanBitsArray[1] ^ inputOutputBooleanBitsArray[2] ^ inputOutputBooleanBitsArray[4] ^ inputOutputBooleanBitsArray[6] ^ inputOutputBooleanBitsArray[7] ^ inputOutputBooleanBitsArray[10];
+
+	if (is16114)
+	{
+		inputOutputBooleanBitsArray[15] = inputOutputBooleanBitsArray[0] ^ inputOutputBooleanBitsArray[2] ^ inputOutputBooleanBitsArray[5] ^ inputOutputBooleanBitsArray[6] ^ inputOutputBooleanBitsArray[8] ^ inputOutputBooleanBitsArray[9] ^ inputOutputBooleanBitsArray[10];
+	}
+}
+
+static uint8_t hammingGetBits(bool *inputOutputBooleanBitsArray, bool is16114)
+{
+	uint8_t n;
+
+	n  = ((inputOutputBooleanBitsArray[0] ^ inputOutputBooleanBitsArray[1] ^ inputOutputBooleanBitsArray[2] ^ inputOutputBooleanBitsArray[3] ^ inputOutputBooleanBitsArray[5] ^ inputOutputBooleanBitsArray[7] ^ inputOutputBooleanBitsArray[8]) != inputOutputBooleanBitsArray[11]) ? 0x01 : 0x00;
+	n |= ((inputOutputBooleanBitsArray[1] ^ inputOutputBooleanBitsArray[2] ^ inputOutputBooleanBitsArray[3] ^ inputOutputBooleanBitsArray[4] ^ inputOutputBooleanBitsArray[6] ^ inputOutputBooleanBitsArray[8] ^ inputOutputBooleanBitsArray[9]) != inputOutputBooleanBitsArray[12]) ? 0x02 : 0x00;
+	n |= ((inputOutputBooleanBitsArray[2] ^ inputOutputBooleanBitsArray[3] ^ inputOutputBooleanBitsArray[4] ^ inputOutputBooleanBitsArray[5] ^ inputOutputBooleanBitsArray[7] ^ inputOutputBooleanBitsArray[9] ^ inputOutputBooleanBitsArray[10]) != inputOutputBooleanBitsArray[13]) ? 0x04 : 0x00;
+	n |= ((inputOutputBooleanBitsArray[0] ^ inputOutputBooleanBitsArray[1] ^ inputOutputBooleanBitsArray[2] ^ inputOutputBooleanBitsArray[4] ^ inputOutputBooleanBitsArray[6] ^ inputOutputBooleanBitsArray[7] ^ inputOutputBooleanBitsArray[10]) != inputOutputBooleanBitsArray[14]) ? 0x08 : 0x00;
+
+	if (is16114)
+	{
+		n |= ((inputOutputBooleanBitsArray[0] ^ inputOutputBooleanBitsArray[2] ^ inputOutputBooleanBitsArray[5] ^ inputOutputBooleanBitsArray[6] ^ inputOutputBooleanBitsArray[8] ^ inputOutputBooleanBitsArray[9] ^ inputOutputBooleanBitsArray[10]) != inputOutputBooleanBitsArray[15]) ? 0x10 : 0x00;
+	}
+
+	return n;
+}
+
+static void embeddedDataEncodeEmbeddedData(void)
+{
+	bool data[128];
+	uint32_t arrayIndex = 0;
+
+	uint32_t crc = CRC_encodeFiveBit(embeddedDataProcessed);
+
+	memset(data, 0, 128 * sizeof(bool));
+
+	data[106] = (crc & 0x01) == 0x01;
+	data[90]  = (crc & 0x02) == 0x02;
+	data[74]  = (crc & 0x04) == 0x04;
+	data[58]  = (crc & 0x08) == 0x08;
+	data[42]  = (crc & 0x10) == 0x10;
+
+	for (int range = 0; range < 7; range++)
+	{
+		for (uint32_t i = embedddataCopyRanges[range][0]; i <= embedddataCopyRanges[range][1]; i++, arrayIndex++)
+		{
+			data[i] = embeddedDataProcessed[arrayIndex];
+		}
+	}
+
+	for (int i = 0; i < 112; i += 16)
+	{
+		hammingEncode(data + i, true);
+	}
+
+	for (int i = 0; i < 16; i++)
+	{
+		data[i + 112] = data[i + 0] ^ data[i + 16] ^ data[i + 32] ^ data[i + 48] ^ data[i + 64] ^ data[i + 80] ^ data[i + 96];
+	}
+
+	arrayIndex = 0;
+	for (int i = 0; i < 128; i++)
+	{
+		embeddedDataRaw[i] = data[arrayIndex];
+		arrayIndex += 16;
+		if (arrayIndex > 127)
+		{
+			arrayIndex -= 127;
+		}
+	}
+}
+
+static void embeddedDataDecodeEmbeddedData(void)
+{
+	uint32_t crc = 0;
+	bool tmpBooleanBitsArray[128];
+	int bitArrayIndex = 0;
+
+	memset(tmpBooleanBitsArray, 0, 128 * sizeof(bool));
+
+	for (int i = 0; i < 128; i++)
+	{
+		tmpBooleanBitsArray[bitArrayIndex] = embeddedDataRaw[i];
+		bitArrayIndex += 16;
+		if (bitArrayIndex > 127)
+		{
+			bitArrayIndex -= 127;
+		}
+	}
+
+	for (int i = 0; i < 112; i += 16)
+	{
+		if (!hammingDecodeType1(tmpBooleanBitsArray + i))
+		{
+			return;
+		}
+	}
+
+	// Check parity
+	for (int i = 0; i < 16; i++)
+	{
+		bool parity = tmpBooleanBitsArray[i + 0] ^ tmpBooleanBitsArray[i + 16] ^ tmpBooleanBitsArray[i + 32] ^ tmpBooleanBitsArray[i + 48] ^ tmpBooleanBitsArray[i + 64] ^ tmpBooleanBitsArray[i + 80] ^ tmpBooleanBitsArray[i + 96] ^ tmpBooleanBitsArray[i + 112];
+		if (parity)
+		{
+			return;
+		}
+	}
+
+	bitArrayIndex = 0;
+
+	for (int range = 0; range < 7; range++)
+	{
+		for (uint32_t i = embedddataCopyRanges[range][0]; i <= embedddataCopyRanges[range][1]; i++, bitArrayIndex++)
+		{
+			embeddedDataProcessed[bitArrayIndex] = tmpBooleanBitsArray[i];
+		}
+	}
+
+	if (tmpBooleanBitsArray[42])
+	{
+		crc += 16;
+	}
+
+	if (tmpBooleanBitsArray[58])
+	{
+		crc += 8;
+	}
+
+	if (tmpBooleanBitsArray[74])
+	{
+		crc += 4;
+	}
+
+	if (tmpBooleanBitsArray[90])
+	{
+		crc += 2;
+	}
+
+	if (tmpBooleanBitsArray[106])
+	{
+		crc += 1;
+	}
+
+	if (crc != CRC_encodeFiveBit(embeddedDataProcessed))
+	{
+		return;
+	}
+
+	embeddedDataIsValid = true;
+
+	uint8_t flco = BooleanBitsArrayToByte(embeddedDataProcessed + 0);
+	embeddedDataFLCO = (int)(flco & 0x3F);
+}
+
+static uint32_t CRC_encodeFiveBit(const bool *in)
+{
+	uint32_t total = 0;
+
+	for (int i = 0; i < 72; i += 8)
+	{
+		total += BooleanBitsArrayToByte(in + i);
+	}
+
+	total %= 31;
+
+	return total;
+}
+
+static void byteToBooleanBitsArray(uint8_t byteIn, bool *bitsOut)
+{
+	for (int i = 0, shift = 7; i < 8; i++, shift--)
+	{
+		bitsOut[i] = (byteIn >> shift) & 0x01;
+	}
+}
+
+static uint8_t BooleanBitsArrayToByte(const bool *bitsIn)
+{
+	uint8_t out = 0;
+	for (int i = 0, shift = 7; i < 8; i++, shift--)
+	{
+		out  |= bitsIn[i] << shift;
+	}
+	return out;
+}
+
+void referenceBPTCDecode(const uint8_t *inputData, uint8_t *outputData)
+{
+	BPTCdecode(inputData, outputData);
+}
+
+void referenceBPTCEncode(const uint8_t *inputData, uint8_t *outputData)
+{
+	BPTCencode(inputData, outputData);
+}
+
+void referenceEmbeddedDataEncode(const bool *lcBits, bool *rawBits)
+{
+	memcpy(embeddedDataProcessed, lcBits, sizeof(embeddedDataProcessed));
+	embeddedDataEncodeEmbeddedData();
+	memcpy(rawBits, embeddedDataRaw, sizeof(embeddedDataRaw));
+}
+
+bool referenceEmbeddedDataDecode(const bool *rawBits, bool *lcBits, int *flco)
+{
+	memcpy(embeddedDataRaw, rawBits, sizeof(embeddedDataRaw));
+	memcpy(embeddedDataProcessed, lcBits, sizeof(embeddedDataProcessed));
+	embeddedDataFLCO = 0;
+	embeddedDataIsValid = false;
+
+	embeddedDataDecodeEmbeddedData();
+
+	memcpy(lcBits, embeddedDataProcessed, sizeof(embeddedDataProcessed));
+	*flco = embeddedDataFLCO;
+
+	return embeddedDataIsValid;
+}
@@ -0,0 +1,234 @@
+/*
+ * Copyright (C) 2019-2024 Roger Clark, VK3KYY / G4KYF
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// Checks the bit packed codecs in functions/dmrFEC.c against known answers, then against
+// the bool array codecs they replaced (dmrFECReference.c), on random and corrupted data.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "functions/dmrFEC.h"
+#include "dmrFECReference.h"
+#include "dmrFECVectors.h"
+
+#define RANDOM_ROUNDS    300000
+
+static uint32_t randomState = 0x2468ACE1;
+static int failures = 0;
+
+static uint32_t randomNext(void)
+{
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 17;
+	randomState ^= randomState << 5;
+	return randomState;
+}
+
+static void check(bool passed, const char *what, int index)
+{
+	if (!passed)
+	{
+		if (failures++ < 20)
+		{
+			printf("%s: failed on %d\n", what, index);
+		}
+	}
+}
+
+static void bytesToBits(const uint8_t *bytes, bool *bits, int bitCount)
+{
+	for (int i = 0; i < bitCount; i++)
+	{
+		bits[i] = (bytes[i >> 3] >> (7 - (i & 7))) & 0x01;
+	}
+}
+
+static void checkVectors(void)
+{
+	for (size_t v = 0; v < (sizeof(DMRFEC_BPTC_VECTORS) / sizeof(DMRFEC_BPTC_VECTORS[0])); v++)
+	{
+		uint8_t burst[33];
+		uint8_t lc[12];
+
+		memset(burst, 0x5A, sizeof(burst));
+		dmrFECBPTCEncode(DMRFEC_BPTC_VECTORS[v].lc, burst);
+		check((memcmp(burst, DMRFEC_BPTC_VECTORS[v].burst, sizeof(burst)) == 0), "BPTC encode vector", v);
+
+		memset(burst, 0x5A, sizeof(burst));
+		referenceBPTCEncode(DMRFEC_BPTC_VECTORS[v].lc, burst);
+		check((memcmp(burst, DMRFEC_BPTC_VECTORS[v].burst, sizeof(burst)) == 0), "BPTC reference encode vector", v);
+
+		dmrFECBPTCDecode(DMRFEC_BPTC_VECTORS[v].burst, lc);
+		check((memcmp(lc, DMRFEC_BPTC_VECTORS[v].lc, sizeof(lc)) == 0), "BPTC decode vector", v);
+	}
+
+	for (size_t v = 0; v < (sizeof(DMRFEC_EMBEDDED_VECTORS) / sizeof(DMRFEC_EMBEDDED_VECTORS[0])); v++)
+	{
+		bool lcBits[72];
+		bool rawBits[128];
+		bool expectedRawBits[128];
+		bool decodedBits[72] = { false };
+
+		bytesToBits(DMRFEC_EMBEDDED_VECTORS[v].lc, lcBits, 72);
+		bytesToBits(DMRFEC_EMBEDDED_VECTORS[v].raw, expectedRawBits, 128);
+
+		dmrFECEmbeddedDataEncode(lcBits, rawBits);
+		check((memcmp(rawBits, expectedRawBits, sizeof(rawBits)) == 0), "Embedded encode vector", v);
+
+		referenceEmbeddedDataEncode(lcBits, rawBits);
+		check((memcmp(rawBits, expectedRawBits, sizeof(rawBits)) == 0), "Embedded reference encode vector", v);
+
+		check((dmrFECEmbeddedDataDecode(expectedRawBits, decodedBits) && (memcmp(decodedBits, lcBits, sizeof(lcBits)) == 0)), "Embedded decode vector", v);
+	}
+}
+
+static void checkBPTC(int round)
+{
+	uint8_t lc[12];
+	uint8_t burst[33];
+	uint8_t referenceBurst[34]; // the reference decoder reads one byte past the burst
+	uint8_t decoded[12];
+	uint8_t referenceDecoded[12];
+	int errorCount = (randomNext() % 4);
+
+	for (int i = 0; i < 12; i++)
+	{
+		lc[i] = randomNext();
+	}
+	for (int i = 0; i < 33; i++)
+	{
+		burst[i] = referenceBurst[i] = randomNext();
+	}
+	referenceBurst[33] = 0;
+
+	dmrFECBPTCEncode(lc, burst);
+	referenceBPTCEncode(lc, referenceBurst);
+	check((memcmp(burst, referenceBurst, sizeof(burst)) == 0), "BPTC encode", round);
+
+	// Flip some bits of the BPTC data (not the slot type and sync), or replace it all with noise
+	for (int e = 0; e < errorCount; e++)
+	{
+		int bit;
+
+		do
+		{
+			bit = (randomNext() % 264);
+		} while ((bit >= 98) && (bit < 166));
+
+		burst[bit >> 3] ^= (0x80 >> (bit & 7));
+	}
+
+	if ((round % 3) == 0)
+	{
+		for (int i = 0; i < 33; i++)
+		{
+			burst[i] = randomNext();
+		}
+	}
+
+	memcpy(referenceBurst, burst, sizeof(burst));
+	referenceBurst[33] = 0;
+	dmrFECBPTCDecode(burst, decoded);
+	referenceBPTCDecode(referenceBurst, referenceDecoded);
+	check((memcmp(decoded, referenceDecoded, sizeof(decoded)) == 0), "BPTC decode", round);
+
+	if ((errorCount <= 1) && ((round % 3) != 0))
+	{
+		check((memcmp(decoded, lc, sizeof(lc)) == 0), "BPTC single error correction", round);
+	}
+}
+
+static void checkEmbedded(int round)
+{
+	bool lcBits[72];
+	bool rawBits[128];
+	bool referenceRawBits[128];
+	bool decodedBits[72] = { false };
+	bool referenceDecodedBits[72] = { false };
+	int referenceFLCO;
+	int errorCount = (randomNext() % 3);
+
+	for (int i = 0; i < 72; i++)
+	{
+		lcBits[i] = (randomNext() & 0x01);
+	}
+
+	dmrFECEmbeddedDataEncode(lcBits, rawBits);
+	referenceEmbeddedDataEncode(lcBits, referenceRawBits);
+	check((memcmp(rawBits, referenceRawBits, sizeof(rawBits)) == 0), "Embedded encode", round);
+
+	for (int e = 0; e < errorCount; e++)
+	{
+		rawBits[randomNext() % 128] ^= true;
+	}
+
+	if ((round % 4) == 0)
+	{
+		for (int i = 0; i < 128; i++)
+		{
+			rawBits[i] = (randomNext() & 0x01);
+		}
+	}
+
+	bool valid = dmrFECEmbeddedDataDecode(rawBits, decodedBits);
+	bool referenceValid = referenceEmbeddedDataDecode(rawBits, referenceDecodedBits, &referenceFLCO);
+
+	check(((valid == referenceValid) && (memcmp(decodedBits, referenceDecodedBits, sizeof(decodedBits)) == 0)), "Embedded decode", round);
+
+	if (valid)
+	{
+		// The FLCO is taken from the decoded bits by the hotspot, as the reference decoder did
+		uint8_t flco = 0;
+
+		for (int i = 0; i < 8; i++)
+		{
+			flco = (flco << 1) | decodedBits[i];
+		}
+
+		check(((flco & 0x3F) == referenceFLCO), "Embedded FLCO", round);
+	}
+
+	if ((errorCount == 0) && ((round % 4) != 0))
+	{
+		check((valid && (memcmp(decodedBits, lcBits, sizeof(lcBits)) == 0)), "Embedded round trip", round);
+	}
+}
+
+int main(void)
+{
+	checkVectors();
+
+	for (int round = 0; round < RANDOM_ROUNDS; round++)
+	{
+		checkBPTC(round);
+		checkEmbedded(round);
+	}
+
+	printf("dmrFECTest: %d failures\n", failures);
+
+	return ((failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2019-2024 Roger Clark, VK3KYY / G4KYF
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef _OPENGD77_TESTS_DMRFECVECTORS_H_
+#define _OPENGD77_TESTS_DMRFECVECTORS_H_
+
+#include <stdint.h>
+
+// Known answers, from the bool array codecs in dmrFECReference.c.
+// The LCs are a group call to TG 91, a private call, all zeros, all ones, then four random ones.
+
+// BPTC(196,96) encoding of 12 bytes of LC, into a burst filled with 0x5A beforehand
+// (bytes 13 to 19 and the halves of bytes 12 and 20 are the untouched slot type and sync)
+static const struct
+{
+	uint8_t lc[12];
+	uint8_t burst[33];
+} DMRFEC_BPTC_VECTORS[] = {
+	{
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x5B, 0x23, 0xDC, 0x12, 0x00, 0x00, 0x00 },
+		{ 0x02, 0x0C, 0x0B, 0x1C, 0x12, 0x6C, 0x18, 0x48, 0x51, 0x60, 0x03, 0x40, 0x5A, 0x5A, 0x5A, 0x5A, 0x5A,
+		  0x5A, 0x5A, 0x5A, 0x5A, 0x34, 0x08, 0x38, 0x30, 0x30, 0x10, 0xC0, 0x40, 0x41, 0x87, 0x03, 0x0E }
+	},
+	{
+		{ 0x03, 0x00, 0x20, 0x23, 0xDC, 0x12, 0x00, 0x00, 0x09, 0x00, 0x00, 0x00 },
+		{ 0x68, 0x95, 0x31, 0x2B, 0x10, 0x12, 0x50, 0x68, 0x81, 0x31, 0xD2, 0xE2, 0x1A, 0x5A, 0x5A, 0x5A, 0x5A,
+		  0x5A, 0x5A, 0x5A, 0x58, 0x70, 0x40, 0xB8, 0x88, 0x02, 0x00, 0xA6, 0x01, 0x90, 0x07, 0x06, 0x09 }
+	},
+	{
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1A, 0x5A, 0x5A, 0x5A, 0x5A,
+		  0x5A, 0x5A, 0x5A, 0x58, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }
+	},
+	{
+		{ 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF },
+		{ 0x7F, 0xF4, 0x7F, 0xE1, 0xFF, 0xC7, 0xFF, 0xC7, 0xFF, 0xFF, 0xFD, 0xBF, 0xDA, 0x5A, 0x5A, 0x5A, 0x5A,
+		  0x5A, 0x5A, 0x5A, 0x5B, 0x8F, 0xFF, 0x3F, 0xFF, 0xBF, 0xFE, 0x6F, 0xFE, 0xCF, 0xFD, 0x9F, 0xFA }
+	},
+	{
+		{ 0x70, 0x9A, 0x0E, 0x4A, 0xAB, 0x40, 0xD5, 0x13, 0x9B, 0xDE, 0x95, 0xB3 },
+		{ 0x09, 0xE5, 0x86, 0x22, 0x67, 0x38, 0x15, 0x22, 0xDA, 0xB2, 0x7B, 0x5F, 0x9A, 0x5A, 0x5A, 0x5A, 0x5A,
+		  0x5A, 0x5A, 0x5A, 0x5A, 0xB7, 0xF3, 0xE4, 0xDC, 0x33, 0x5E, 0xCB, 0x90, 0x4A, 0x00, 0x89, 0xD0 }
+	},
+	{
+		{ 0x92, 0xBB, 0xFA, 0xDF, 0xFC, 0x43, 0xDA, 0x6E, 0x2F, 0xB4, 0x35, 0x7E },
+		{ 0x7A, 0x3E, 0xD0, 0x70, 0xE9, 0xF7, 0xC3, 0x4A, 0xEA, 0x53, 0x36, 0x9B, 0x5A, 0x5A, 0x5A, 0x5A, 0x5A,
+		  0x5A, 0x5A, 0x5A, 0x5A, 0x69, 0xBD, 0xE3, 0x0D, 0x79, 0x66, 0xCA, 0xF5, 0x55, 0x2A, 0x1E, 0x0E }
+	},
+	{
+		{ 0xA5, 0x06, 0x00, 0x6F, 0x10, 0xE3, 0x70, 0x50, 0x32, 0x25, 0x27, 0xEA },
+		{ 0x00, 0xA4, 0xB2, 0x3B, 0x40, 0xAC, 0x22, 0xB6, 0x62, 0xB5, 0x84, 0xA2, 0x1A, 0x5A, 0x5A, 0x5A, 0x5A,
+		  0x5A, 0x5A, 0x5A, 0x5B, 0xDA, 0x71, 0xE8, 0xF7, 0x4A, 0xD5, 0x46, 0x6D, 0x5D, 0x20, 0x3A, 0x0F }
+	},
+	{
+		{ 0x6D, 0xA0, 0xB1, 0x09, 0xF3, 0xEC, 0x18, 0x38, 0x47, 0x8F, 0xD2, 0xEA },
+		{ 0x24, 0xB5, 0x9A, 0x0F, 0xAF, 0x84, 0x60, 0x65, 0xFF, 0xE9, 0x5F, 0x40, 0x9A, 0x5A, 0x5A, 0x5A, 0x5A,
+		  0x5A, 0x5A, 0x5A, 0x5B, 0xCA, 0x1E, 0x2F, 0x57, 0x52, 0xAB, 0x8B, 0x03, 0x12, 0x42, 0x18, 0x6A }
+	}
+};
+
+// Embedded LC encoding of 9 bytes of LC, as the 128 bits of the 4 fragments (16 bytes, MSB first)
+static const struct
+{
+	uint8_t lc[9];
+	uint8_t raw[16];
+} DMRFEC_EMBEDDED_VECTORS[] = {
+	{
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x5B, 0x23, 0xDC, 0x12 },
+		{ 0x00, 0x09, 0x0C, 0x05, 0x0C, 0x0F, 0x00, 0x05, 0x0F, 0x14, 0x2E, 0x05, 0x17, 0x35, 0x22, 0x36 }
+	},
+	{
+		{ 0x03, 0x00, 0x20, 0x23, 0xDC, 0x12, 0x00, 0x00, 0x09 },
+		{ 0x11, 0x18, 0x00, 0x11, 0x39, 0x11, 0x82, 0xC0, 0x21, 0x22, 0x0F, 0xE8, 0xB1, 0xD4, 0x7D, 0x8E }
+	},
+	{
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }
+	},
+	{
+		{ 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF },
+		{ 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xC3, 0xFF, 0xFF, 0xC3, 0xC3, 0xC3 }
+	},
+	{
+		{ 0xCA, 0xEE, 0x98, 0xFC, 0x06, 0x93, 0x8E, 0xC6, 0x4C },
+		{ 0x87, 0xCC, 0x65, 0x63, 0xAC, 0x7D, 0xBB, 0x22, 0xD1, 0xC5, 0xA5, 0xC3, 0xC9, 0x95, 0xBE, 0x95 }
+	},
+	{
+		{ 0xB1, 0x0F, 0xE9, 0x24, 0x43, 0x76, 0x18, 0x48, 0x6B },
+		{ 0x8D, 0x78, 0xC0, 0xCA, 0x6A, 0x44, 0x53, 0xF0, 0x06, 0x5A, 0x18, 0x4D, 0x17, 0x96, 0xE4, 0x1E }
+	},
+	{
+		{ 0xE9, 0xA6, 0xB8, 0x0A, 0x54, 0x6E, 0xB7, 0xE3, 0x33 },
+		{ 0x8B, 0x96, 0xCC, 0x5C, 0x8E, 0x56, 0x2D, 0xC0, 0xEB, 0x5A, 0x90, 0xF0, 0x14, 0x42, 0x22, 0x1D }
+	},
+	{
+		{ 0x2F, 0xA4, 0x94, 0x01, 0xD4, 0x0D, 0xDE, 0x30, 0xD4 },
+		{ 0x14, 0x14, 0xCF, 0x1B, 0x81, 0xDB, 0x8D, 0x8E, 0xC0, 0x28, 0xDB, 0x41, 0x24, 0xF3, 0x96, 0xBE }
+	}
+};
+
+#endif /* _OPENGD77_TESTS_DMRFECVECTORS_H_ */
@@ -0,0 +1,320 @@
+/*
+ * Copyright (C) 2019-2024 Roger Clark, VK3KYY / G4KYF
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// Runs the emulated EEPROM write journal (hardware/EEPROM.c, unchanged) on top of a simulated W25Q128:
+// - every read has to return what has been written, across reboots too,
+// - the Flash sector erases are counted, against the ones the in place writes would have cost,
+// - power is cut while the journal records are programmed, the EEPROM has to come back either
+//   with or without the interrupted write,
+// - power is cut while the journal is folded into the base image, nothing may be lost.
+// Erases are not interrupted by the power cuts, only programming is.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hardware/EEPROM.h"
+#include "w25q128Sim.h"
+
+// As in EEPROM.c
+#define JOURNAL_FIRST_SECTOR        (0x18000 / W25Q128_SIM_SECTOR_SIZE)
+#define JOURNAL_NUM_SECTORS         4
+#define JOURNAL_RECORD_MAX_DATA     252
+#define FOLD_LOG_SECTOR             (JOURNAL_FIRST_SECTOR + JOURNAL_NUM_SECTORS)
+#define FOLD_COPY_FIRST_SECTOR      (FOLD_LOG_SECTOR + 1)
+#define FOLD_COPY_NUM_SECTORS       3
+
+#define EEPROM_NUM_SECTORS          (EMULATED_EEPROM_SIZE / W25Q128_SIM_SECTOR_SIZE)
+#define WEAR_WRITES                 200000
+#define REBOOT_INTERVAL             5000
+#define POWER_CUT_TRIALS            5000
+#define FOLD_POWER_CUT_TRIALS       2000
+
+static uint8_t shadow[EMULATED_EEPROM_SIZE];
+static uint32_t inPlaceErases[EEPROM_NUM_SECTORS]; // what the writes would have cost without the journal
+static uint32_t randomState = 0x13579BDF;
+static int failures = 0;
+
+static uint32_t randomNext(void)
+{
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 17;
+	randomState ^= randomState << 5;
+	return randomState;
+}
+
+static void fail(const char *what, int index)
+{
+	if (failures++ < 20)
+	{
+		printf("%s: failed on %d\n", what, index);
+	}
+}
+
+static bool eepromMatches(const uint8_t *expected)
+{
+	static uint8_t image[EMULATED_EEPROM_SIZE];
+
+	return (EEPROM_Read(0, image, EMULATED_EEPROM_SIZE) && (memcmp(image, expected, EMULATED_EEPROM_SIZE) == 0));
+}
+
+// Mostly small writes on a few places (settings, VFOs, last used channels), some anywhere, a few big ones
+static void randomWrite(int *address, int *size, int maxSize)
+{
+	static const int HOT_ADDRESSES[] = { 0x0080, 0x6000, 0x6100, 0x7500 };
+	uint32_t kind = (randomNext() % 100);
+
+	if (kind < 75)
+	{
+		*address = HOT_ADDRESSES[randomNext() % 4] + (randomNext() % 64);
+		*size = 1 + (randomNext() % 32);
+	}
+	else if (kind < 97)
+	{
+		*size = 1 + (randomNext() % 255);
+		*address = (randomNext() % (EMULATED_EEPROM_SIZE - *size));
+	}
+	else
+	{
+		*size = 256 + (randomNext() % 1024);
+		*address = (randomNext() % (EMULATED_EEPROM_SIZE - *size));
+	}
+
+	if (*size > maxSize)
+	{
+		*size = maxSize;
+	}
+}
+
+static void randomData(uint8_t *data, int address, int size)
+{
+	uint32_t kind = (randomNext() % 10);
+
+	for (int i = 0; i < size; i++)
+	{
+		// Some writes don't change anything, some only a few bytes
+		data[i] = ((kind == 0) ? shadow[address + i] : ((kind < 4) ? (shadow[address + i] ^ ((randomNext() % 8) == 0)) : randomNext()));
+	}
+}
+
+static void checkWear(void)
+{
+	uint8_t data[2048];
+	uint32_t inPlaceMax = 0;
+	uint32_t eepromMax = 0;
+	uint32_t journalMin = UINT32_MAX;
+	uint32_t journalMax = 0;
+	uint32_t foldCopyMax = 0;
+
+	for (int w = 0; w < WEAR_WRITES; w++)
+	{
+		int address;
+		int size;
+
+		randomWrite(&address, &size, sizeof(data));
+		randomData(data, address, size);
+
+		for (int s = (address / W25Q128_SIM_SECTOR_SIZE); s <= ((address + size - 1) / W25Q128_SIM_SECTOR_SIZE); s++)
+		{
+			inPlaceErases[s]++;
+		}
+
+		memcpy(&shadow[address], data, size);
+
+		if (EEPROM_Write(address, data, size) == false)
+		{
+			fail("Write", w);
+		}
+
+		if ((EEPROM_Read(address, data, size) == false) || (memcmp(data, &shadow[address], size) != 0))
+		{
+			fail("Read back", w);
+		}
+
+		if ((w % REBOOT_INTERVAL) == (REBOOT_INTERVAL - 1))
+		{
+			if ((EEPROM_Init() == false) || (eepromMatches(shadow) == false))
+			{
+				fail("Reboot", w);
+			}
+		}
+	}
+
+	// Once folded, the base image has to be complete on its own (as the CPS reads it)
+	if ((EEPROM_Sync() == false) || (memcmp(w25q128SimData(), shadow, EMULATED_EEPROM_SIZE) != 0))
+	{
+		fail("Sync", 0);
+	}
+
+	for (int s = 0; s < EEPROM_NUM_SECTORS; s++)
+	{
+		inPlaceMax = ((inPlaceErases[s] > inPlaceMax) ? inPlaceErases[s] : inPlaceMax);
+		eepromMax = ((w25q128SimEraseCount(s) > eepromMax) ? w25q128SimEraseCount(s) : eepromMax);
+	}
+
+	for (int s = JOURNAL_FIRST_SECTOR; s < (JOURNAL_FIRST_SECTOR + JOURNAL_NUM_SECTORS); s++)
+	{
+		journalMin = ((w25q128SimEraseCount(s) < journalMin) ? w25q128SimEraseCount(s) : journalMin);
+		journalMax = ((w25q128SimEraseCount(s) > journalMax) ? w25q128SimEraseCount(s) : journalMax);
+	}
+
+	for (int s = FOLD_COPY_FIRST_SECTOR; s < (FOLD_COPY_FIRST_SECTOR + FOLD_COPY_NUM_SECTORS); s++)
+	{
+		foldCopyMax = ((w25q128SimEraseCount(s) > foldCopyMax) ? w25q128SimEraseCount(s) : foldCopyMax);
+	}
+
+	printf("%d writes, most erased sector: in place %u, EEPROM image %u, journal %u (least erased journal sector %u), fold log %u, fold copy %u\n",
+			WEAR_WRITES, (unsigned)inPlaceMax, (unsigned)eepromMax, (unsigned)journalMax, (unsigned)journalMin,
+			(unsigned)w25q128SimEraseCount(FOLD_LOG_SECTOR), (unsigned)foldCopyMax);
+
+	// The journal has to divide the wear of the hottest sector by 10 at least, fold copy included, and spread its own evenly
+	if (((eepromMax * 10) > inPlaceMax) || ((journalMax * 10) > inPlaceMax) ||
+			((foldCopyMax * 10) > inPlaceMax) || ((w25q128SimEraseCount(FOLD_LOG_SECTOR) * 10) > inPlaceMax))
+	{
+		fail("Wear", 0);
+	}
+
+	if (((journalMax - journalMin) * 20) > journalMax)
+	{
+		fail("Journal wear levelling", 0);
+	}
+
+	for (int s = EEPROM_NUM_SECTORS; s < W25Q128_SIM_NUM_SECTORS; s++)
+	{
+		if ((w25q128SimEraseCount(s) != 0) && ((s < JOURNAL_FIRST_SECTOR) || (s >= (FOLD_COPY_FIRST_SECTOR + FOLD_COPY_NUM_SECTORS))))
+		{
+			fail("Erase outside of the EEPROM and journal", s);
+		}
+	}
+}
+
+static void checkPowerCuts(void)
+{
+	static uint8_t expected[EMULATED_EEPROM_SIZE];
+	uint8_t data[JOURNAL_RECORD_MAX_DATA];
+
+	for (int t = 0; t < POWER_CUT_TRIALS; t++)
+	{
+		int address;
+		int size;
+
+		// Single record writes only, bigger ones are made of several records which are recovered individually
+		randomWrite(&address, &size, JOURNAL_RECORD_MAX_DATA);
+		randomData(data, address, size);
+
+		memcpy(expected, shadow, sizeof(expected));
+		memcpy(&expected[address], data, size);
+
+		w25q128SimCutPowerAfter(randomNext() % (size + 4 + 1));
+		bool written = EEPROM_Write(address, data, size);
+		w25q128SimPowerOn();
+
+		if (EEPROM_Init() == false)
+		{
+			fail("Power cut reboot", t);
+			continue;
+		}
+
+		if (eepromMatches(expected))
+		{
+			memcpy(shadow, expected, sizeof(shadow));
+		}
+		else if ((written == true) || (eepromMatches(shadow) == false))
+		{
+			fail("Power cut", t);
+			return;
+		}
+	}
+
+	if (w25q128SimProgramViolations() != 0)
+	{
+		fail("Programming over non blank bytes", (int)w25q128SimProgramViolations());
+	}
+}
+
+static void checkFoldPowerCuts(void)
+{
+	uint8_t data[64];
+
+	for (int t = 0; t < FOLD_POWER_CUT_TRIALS; t++)
+	{
+		// Some records to fold, over one or more sectors
+		for (int w = (1 + (randomNext() % 20)); w > 0; w--)
+		{
+			int address;
+			int size;
+
+			randomWrite(&address, &size, sizeof(data));
+			randomData(data, address, size);
+			memcpy(&shadow[address], data, size);
+
+			if (EEPROM_Write(address, data, size) == false)
+			{
+				fail("Fold write", t);
+			}
+		}
+
+		// Anywhere in the fold: copy sector, log entry, base sector, or the next journal sector header
+		w25q128SimCutPowerAfter(randomNext() % (3 * (W25Q128_SIM_SECTOR_SIZE + 16)));
+		EEPROM_Sync();
+		w25q128SimPowerOn();
+
+		if ((EEPROM_Init() == false) || (eepromMatches(shadow) == false))
+		{
+			fail("Fold power cut", t);
+			return;
+		}
+	}
+
+	if (w25q128SimProgramViolations() != 0)
+	{
+		fail("Programming over non blank bytes", (int)w25q128SimProgramViolations());
+	}
+}
+
+int main(void)
+{
+	w25q128SimInit();
+
+	for (int i = 0; i < EMULATED_EEPROM_SIZE; i++)
+	{
+		shadow[i] = randomNext();
+	}
+	memcpy(w25q128SimData(), shadow, EMULATED_EEPROM_SIZE);
+
+	if ((EEPROM_Init() == false) || (eepromMatches(shadow) == false))
+	{
+		fail("Init", 0);
+	}
+
+	checkWear();
+	checkPowerCuts();
+	checkFoldPowerCuts();
+
+	printf("eepromJournalTest: %d failures\n", failures);
+
+	return ((failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE);
+}
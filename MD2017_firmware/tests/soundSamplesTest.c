@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2019-2024 Roger Clark, VK3KYY / G4KYF
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// Compares soundApplyDmrRxAgcGain() and soundCopyMicSamples() against the float loops they replaced.
+// Built twice by the Makefile, for the C fallback and for the emulated Cortex-M4 SIMD path.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "functions/soundSamples.h"
+
+#define SAMPLE_COUNT     80 // WAV_BUFFER_SIZE / 2
+#define BUFFER_ROUNDS    20000
+
+static const float DMR_RX_AGC_DEFAULT_PEAK_SAMPLES = 2000.0f;
+static const int AGC_SETTINGS_LUT[] = { 1, 2, 4, 8, 16, 32, 64, 128 };
+
+static uint32_t randomState = 0x12345678;
+static int failures = 0;
+
+static uint32_t randomNext(void)
+{
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 17;
+	randomState ^= randomState << 5;
+	return randomState;
+}
+
+static void fillSamples(int16_t *samples, int pattern)
+{
+	for (int i = 0; i < SAMPLE_COUNT; i++)
+	{
+		switch (pattern)
+		{
+			case 0:
+				samples[i] = INT16_MIN;
+				break;
+			case 1:
+				samples[i] = INT16_MAX;
+				break;
+			case 2:
+				samples[i] = ((i & 1) ? INT16_MAX : INT16_MIN);
+				break;
+			case 3:
+				samples[i] = 0;
+				break;
+			case 4: // quiet, as the AGC sees it most of the time
+				samples[i] = (int16_t)((int32_t)(randomNext() % 2001) - 1000);
+				break;
+			default:
+				samples[i] = (int16_t)randomNext();
+				break;
+		}
+	}
+}
+
+// The gain, as computed by soundRefillData(), in float as it used to be
+static float agcFloatGain(float peakAverage, int setting)
+{
+	float gain = (DMR_RX_AGC_DEFAULT_PEAK_SAMPLES / peakAverage) * AGC_SETTINGS_LUT[setting];
+
+	if (gain > DMR_RX_AGC_GAIN_MAX)
+	{
+		gain = DMR_RX_AGC_GAIN_MAX;
+	}
+
+	return gain;
+}
+
+static void checkAgc(const int16_t *samples, float floatGain)
+{
+	uint32_t i2sBuffer[SAMPLE_COUNT];
+	int32_t gain = (int32_t)(floatGain * (1 << DMR_RX_AGC_GAIN_FRACTIONAL_BITS));
+	uint32_t peak = soundApplyDmrRxAgcGain(samples, i2sBuffer, SAMPLE_COUNT, gain);
+	uint32_t expectedPeak = 0;
+
+	for (int i = 0; i < SAMPLE_COUNT; i++)
+	{
+		// The old loop cast the float product straight to int16_t, which wrapped once it was out of range.
+		// The fixed point code saturates instead, which is what the reference expects here.
+		int32_t expected = (int32_t)(samples[i] * floatGain);
+		int32_t tolerance = 1 + (abs(samples[i]) >> DMR_RX_AGC_GAIN_FRACTIONAL_BITS); // Q6.9 rounding of the gain, plus floor vs truncation
+		int32_t actual = (int16_t)i2sBuffer[i];
+
+		expected = CLAMP(expected, INT16_MIN, INT16_MAX);
+
+		if (((expected == INT16_MAX) || (expected == INT16_MIN)) && (floatGain == DMR_RX_AGC_GAIN_MAX))
+		{
+			tolerance = 0; // 32 is exact in Q6.9, so saturation has to be too
+		}
+
+		if ((abs(actual - expected) > tolerance) || ((i2sBuffer[i] >> 16) != 0))
+		{
+			if (failures++ < 10)
+			{
+				printf("AGC: gain %f sample %d: got 0x%08x, expected %d\n", (double)floatGain, samples[i], (unsigned)i2sBuffer[i], (int)expected);
+			}
+		}
+
+		if ((uint32_t)abs(samples[i]) > expectedPeak)
+		{
+			expectedPeak = abs(samples[i]);
+		}
+	}
+
+	if (peak != expectedPeak)
+	{
+		if (failures++ < 10)
+		{
+			printf("AGC: gain %f: peak %u, expected %u\n", (double)floatGain, (unsigned)peak, (unsigned)expectedPeak);
+		}
+	}
+}
+
+static void checkMic(const uint32_t *i2sBuffer)
+{
+	int16_t samples[SAMPLE_COUNT] __attribute__((aligned(4)));
+	uint32_t peak = soundCopyMicSamples(i2sBuffer, samples, SAMPLE_COUNT);
+	uint32_t expectedPeak = 0;
+
+	for (int i = 0; i < SAMPLE_COUNT; i++)
+	{
+		int16_t expected = (int16_t)i2sBuffer[i]; // only use the Left Channel of the Mic Audio
+
+		if (samples[i] != expected)
+		{
+			if (failures++ < 10)
+			{
+				printf("Mic: sample %d: got %d, expected %d\n", i, samples[i], expected);
+			}
+		}
+
+		if ((uint32_t)abs(expected) > expectedPeak)
+		{
+			expectedPeak = abs(expected);
+		}
+	}
+
+	if (peak != expectedPeak)
+	{
+		if (failures++ < 10)
+		{
+			printf("Mic: peak %u, expected %u\n", (unsigned)peak, (unsigned)expectedPeak);
+		}
+	}
+}
+
+int main(void)
+{
+	int16_t samples[SAMPLE_COUNT] __attribute__((aligned(4)));
+	uint32_t i2sBuffer[SAMPLE_COUNT]; // Left Channel in the low halfword of each frame
+	const float fixedGains[] = { 0.0f, (1.0f / 512.0f), 0.5f, 1.0f, 1.5f, 2.0f, 16.0f, 31.99f, 32.0f };
+
+	for (int round = 0; round < BUFFER_ROUNDS; round++)
+	{
+		fillSamples(samples, round % 8);
+
+		// The gains soundRefillData() can produce, up to the saturation at 32
+		checkAgc(samples, agcFloatGain((float)(200 + (randomNext() % 20000)), (randomNext() % 8)));
+		checkAgc(samples, fixedGains[round % (sizeof(fixedGains) / sizeof(fixedGains[0]))]);
+		checkAgc(samples, agcFloatGain(1.0f, 7));
+
+		for (int i = 0; i < SAMPLE_COUNT; i++)
+		{
+			i2sBuffer[i] = randomNext();
+		}
+		if ((round % 8) < 4)
+		{
+			fillSamples(samples, round % 8);
+			for (int i = 0; i < SAMPLE_COUNT; i++)
+			{
+				i2sBuffer[i] = (i2sBuffer[i] & 0xFFFF0000) | (uint16_t)samples[i];
+			}
+		}
+		checkMic(i2sBuffer);
+	}
+
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+	printf("soundSamplesTest (DSP): %d failures\n", failures);
+#else
+	printf("soundSamplesTest: %d failures\n", failures);
+#endif
+
+	return ((failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2019-2024 Roger Clark, VK3KYY / G4KYF
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef _OPENGD77_TESTS_MAIN_H_
+#define _OPENGD77_TESTS_MAIN_H_
+
+// Host stand in for the firmware main.h, only providing what the host tested headers need.
+// The Cortex-M4 SIMD intrinsics are emulated, GE flags included, so the __ARM_FEATURE_DSP
+// code paths can be run on the host too.
+
+#include <stdint.h>
+
+static uint32_t hostGEFlags;
+
+static inline uint32_t __SSUB16(uint32_t op1, uint32_t op2)
+{
+	int32_t low = (int32_t)(int16_t)op1 - (int32_t)(int16_t)op2;
+	int32_t high = (int32_t)(int16_t)(op1 >> 16) - (int32_t)(int16_t)(op2 >> 16);
+
+	hostGEFlags = ((low >= 0) ? 0x3 : 0x0) | ((high >= 0) ? 0xC : 0x0);
+
+	return (((uint32_t)low & 0xFFFF) | ((uint32_t)high << 16));
+}
+
+static inline uint32_t __SEL(uint32_t op1, uint32_t op2)
+{
+	uint32_t result = 0;
+
+	for (int i = 0; i < 4; i++)
+	{
+		uint32_t mask = (0xFFu << (i * 8));
+
+		result |= (((hostGEFlags & (1u << i)) ? op1 : op2) & mask);
+	}
+
+	return result;
+}
+
+static inline uint32_t __SMUAD(uint32_t op1, uint32_t op2)
+{
+	return (uint32_t)(((int32_t)(int16_t)op1 * (int16_t)op2) + ((int32_t)(int16_t)(op1 >> 16) * (int16_t)(op2 >> 16)));
+}
+
+static inline int32_t __SSAT(int32_t val, uint32_t sat)
+{
+	int32_t max = ((1 << (sat - 1)) - 1);
+	int32_t min = -(1 << (sat - 1));
+
+	return ((val > max) ? max : ((val < min) ? min : val));
+}
+
+#define __PKHBT(ARG1, ARG2, ARG3) ((((uint32_t)(ARG1)) & 0x0000FFFFUL) | ((((uint32_t)(ARG2)) << (ARG3)) & 0xFFFF0000UL))
+
+#endif /* _OPENGD77_TESTS_MAIN_H_ */
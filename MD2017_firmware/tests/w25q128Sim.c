@@ -0,0 +1,178 @@
+/*
+ * Copyright (C) 2019-2024 Roger Clark, VK3KYY / G4KYF
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <string.h>
+#include "hardware/SPI_Flash.h"
+#include "w25q128Sim.h"
+
+uint8_t SPI_Flash_sectorbuffer[4096];
+
+static uint8_t flashData[W25Q128_SIM_SIZE];
+static uint32_t eraseCounts[W25Q128_SIM_NUM_SECTORS];
+static uint32_t programViolations;
+static int powerCutCountdown = -1;
+static bool powerIsOff = false;
+
+void w25q128SimInit(void)
+{
+	memset(flashData, 0xFF, sizeof(flashData));
+	memset(eraseCounts, 0, sizeof(eraseCounts));
+	programViolations = 0;
+	powerCutCountdown = -1;
+	powerIsOff = false;
+}
+
+uint8_t *w25q128SimData(void)
+{
+	return flashData;
+}
+
+uint32_t w25q128SimEraseCount(uint32_t sector)
+{
+	return eraseCounts[sector];
+}
+
+uint32_t w25q128SimProgramViolations(void)
+{
+	return programViolations;
+}
+
+void w25q128SimCutPowerAfter(int bytes)
+{
+	powerCutCountdown = bytes;
+}
+
+void w25q128SimPowerOn(void)
+{
+	powerCutCountdown = -1;
+	powerIsOff = false;
+}
+
+static bool w25q128SimIsInRange(uint32_t address, int size)
+{
+	return ((powerIsOff == false) && (size >= 0) && ((address + (uint32_t)size) <= W25Q128_SIM_SIZE));
+}
+
+static bool w25q128SimProgram(uint32_t address, const uint8_t *dataBuf, int size)
+{
+	if (w25q128SimIsInRange(address, size) == false)
+	{
+		return false;
+	}
+
+	for (int i = 0; i < size; i++)
+	{
+		if (powerCutCountdown == 0)
+		{
+			powerIsOff = true;
+			return false;
+		}
+
+		if (powerCutCountdown > 0)
+		{
+			powerCutCountdown--;
+		}
+
+		if ((flashData[address + i] & dataBuf[i]) != dataBuf[i])
+		{
+			programViolations++;
+		}
+
+		flashData[address + i] &= dataBuf[i];
+	}
+
+	return true;
+}
+
+bool SPI_Flash_read(uint32_t addrress, uint8_t *buf, int size)
+{
+	if (w25q128SimIsInRange(addrress, size) == false)
+	{
+		return false;
+	}
+
+	memcpy(buf, &flashData[addrress], size);
+
+	return true;
+}
+
+bool SPI_Flash_eraseSector(uint32_t address)
+{
+	if (w25q128SimIsInRange(address, W25Q128_SIM_SECTOR_SIZE) == false)
+	{
+		return false;
+	}
+
+	address &= ~(W25Q128_SIM_SECTOR_SIZE - 1);
+	memset(&flashData[address], 0xFF, W25Q128_SIM_SECTOR_SIZE);
+	eraseCounts[address / W25Q128_SIM_SECTOR_SIZE]++;
+
+	return true;
+}
+
+bool SPI_Flash_programBytes(uint32_t address, uint8_t *dataBuf, int size)
+{
+	return w25q128SimProgram(address, dataBuf, size);
+}
+
+bool SPI_Flash_writePage(uint32_t address, uint8_t *dataBuf)
+{
+	return w25q128SimProgram(address, dataBuf, 256);
+}
+
+// No write back cache here: every sector touched is read, erased and programmed back straight away,
+// as the emulated EEPROM writes used to be.
+bool SPI_Flash_write(uint32_t addr, uint8_t *dataBuf, int size)
+{
+	static uint8_t sectorData[W25Q128_SIM_SECTOR_SIZE];
+
+	while (size > 0)
+	{
+		uint32_t sectorAddress = (addr & ~(W25Q128_SIM_SECTOR_SIZE - 1));
+		uint32_t offset = (addr - sectorAddress);
+		int len = (((W25Q128_SIM_SECTOR_SIZE - (int)offset) < size) ? (W25Q128_SIM_SECTOR_SIZE - (int)offset) : size);
+
+		if ((SPI_Flash_read(sectorAddress, sectorData, W25Q128_SIM_SECTOR_SIZE) == false) ||
+				(SPI_Flash_eraseSector(sectorAddress) == false))
+		{
+			return false;
+		}
+
+		memcpy(&sectorData[offset], dataBuf, len);
+
+		if (w25q128SimProgram(sectorAddress, sectorData, W25Q128_SIM_SECTOR_SIZE) == false)
+		{
+			return false;
+		}
+
+		addr += len;
+		dataBuf += len;
+		size -= len;
+	}
+
+	return true;
+}
@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2019-2024 Roger Clark, VK3KYY / G4KYF
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef _OPENGD77_TESTS_W25Q128SIM_H_
+#define _OPENGD77_TESTS_W25Q128SIM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// RAM model of the W25Q128 16M SPI Flash, behind the blocking SPI_Flash_*() calls used by EEPROM.c.
+// Programming can only clear bits, erasing a 4k sector sets them back and is counted.
+
+#define W25Q128_SIM_SIZE           0x1000000
+#define W25Q128_SIM_SECTOR_SIZE    4096
+#define W25Q128_SIM_NUM_SECTORS    (W25Q128_SIM_SIZE / W25Q128_SIM_SECTOR_SIZE)
+
+void w25q128SimInit(void); // blank chip, counters cleared
+uint8_t *w25q128SimData(void); // direct access, not counted
+uint32_t w25q128SimEraseCount(uint32_t sector);
+uint32_t w25q128SimProgramViolations(void); // bytes programmed where a 0 bit would have had to become 1
+
+// Power is cut after that many more bytes have been programmed (the programming in progress is torn),
+// every access fails from then on, until w25q128SimPowerOn(). -1 to never cut.
+void w25q128SimCutPowerAfter(int bytes);
+void w25q128SimPowerOn(void);
+
+#endif /* _OPENGD77_TESTS_W25Q128SIM_H_ */